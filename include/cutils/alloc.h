@@ -0,0 +1,144 @@
+/* SPDX-FileCopyrightText: 2026 Comcast Cable Communications Management, LLC */
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#ifndef __ALLOC_H__
+#define __ALLOC_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* The functions cutils uses to get and release memory.  ctx is passed to
+ * each of them.  calloc_fn may be NULL, then malloc_fn is used and the
+ * memory is zeroed. */
+typedef struct {
+    void *(*malloc_fn)(void *ctx, size_t size);
+    void *(*calloc_fn)(void *ctx, size_t nmemb, size_t size);
+    void *(*realloc_fn)(void *ctx, void *ptr, size_t size);
+    void (*free_fn)(void *ctx, void *ptr);
+    void *ctx;
+} cu_allocator_t;
+
+
+/**
+ * Sets the allocator used for all cutils allocations, including the buffers
+ * returned to the caller.  Those must then be released with cu_free() (or
+ * the allocator's free_fn) instead of free().
+ *
+ * @note: Set it before anything is allocated, and before other threads use
+ *        cutils.  Memory must be freed by the allocator that allocated it.
+ *
+ * @param a the allocator, which is copied, or NULL for malloc() and friends
+ *
+ * @retval 0 on success
+ * @retval -1 if a required function is missing
+ */
+int cu_set_allocator(const cu_allocator_t *a);
+
+
+/**
+ * Gets the allocator set with cu_set_allocator(), or the default one.
+ */
+const cu_allocator_t *cu_get_allocator(void);
+
+
+/**
+ * Allocate and free with the allocator set with cu_set_allocator().  These
+ * work like malloc(), calloc(), realloc() and free().
+ */
+void *cu_malloc(size_t size);
+void *cu_calloc(size_t nmemb, size_t size);
+void *cu_realloc(void *ptr, size_t size);
+void cu_free(void *ptr);
+
+
+/**
+ * The same as above, but with the given allocator, or the one set with
+ * cu_set_allocator() if a is NULL.
+ */
+void *cu_malloc_ex(const cu_allocator_t *a, size_t size);
+void *cu_calloc_ex(const cu_allocator_t *a, size_t nmemb, size_t size);
+void *cu_realloc_ex(const cu_allocator_t *a, void *ptr, size_t size);
+void cu_free_ex(const cu_allocator_t *a, void *ptr);
+
+
+/*----------------------------------------------------------------------------*/
+/*                              Allocation Stats                              */
+/*----------------------------------------------------------------------------*/
+
+#ifdef CU_ALLOC_STATS
+
+/* The cutils APIs allocations are counted for. */
+enum cu_alloc_api {
+    CU_ALLOC_API_MAPRINTF,  /* maprintf() and friends */
+    CU_ALLOC_API_MEMAPPEND, /* memappend() */
+    CU_ALLOC_API_STRNDUP,   /* cu_strdup() and cu_strndup() */
+    CU_ALLOC_API_B64,       /* b64_*() */
+    CU_ALLOC_API_FREADALL,  /* freadall() */
+    CU_ALLOC_API_HASHMAP,   /* hashmap_*() */
+    CU_ALLOC_API_COUNT
+};
+
+/* hist[i] counts the allocations of more than 2^(i-1) and at most 2^i bytes,
+ * and the last one also counts everything larger. */
+#define CU_ALLOC_HIST_BUCKETS (32)
+
+typedef struct {
+    uint64_t allocs;   /* The number of malloc() and calloc() calls. */
+    uint64_t reallocs; /* The number of realloc() calls. */
+    uint64_t frees;    /* The number of frees done by the API itself. */
+    uint64_t bytes;    /* The bytes asked for by allocs and reallocs. */
+    uint64_t hist[CU_ALLOC_HIST_BUCKETS];
+} cu_alloc_api_stats_t;
+
+typedef struct {
+    cu_alloc_api_stats_t api[CU_ALLOC_API_COUNT];
+} cu_alloc_stats_t;
+
+
+/**
+ * Gets a snapshot of the allocation counts for each API, indexed by
+ * enum cu_alloc_api.  Only successful allocations are counted.  Memory
+ * handed to the caller is freed by the caller, so those frees are not
+ * counted against the API.
+ *
+ * @note: Only available when cutils is built with the alloc_stats option,
+ *        which defines CU_ALLOC_STATS.
+ *
+ * @param stats where to put the counts
+ */
+void cu_alloc_stats(cu_alloc_stats_t *stats);
+
+
+/**
+ * Sets all of the allocation counts back to 0.
+ */
+void cu_alloc_stats_reset(void);
+
+
+/**
+ * Gets the name of an API, such as "maprintf", or NULL if it is not valid.
+ */
+const char *cu_alloc_api_name(int api);
+
+
+/* Used inside cutils to count allocations against an API. */
+void *cu_malloc_api_(int api, size_t size);
+void *cu_calloc_api_(int api, size_t nmemb, size_t size);
+void *cu_realloc_api_(int api, void *ptr, size_t size);
+void cu_free_api_(int api, void *ptr);
+
+#define CU_MALLOC_(api, size)        cu_malloc_api_(api, size)
+#define CU_CALLOC_(api, nmemb, size) cu_calloc_api_(api, nmemb, size)
+#define CU_REALLOC_(api, ptr, size)  cu_realloc_api_(api, ptr, size)
+#define CU_FREE_(api, ptr)           cu_free_api_(api, ptr)
+
+#else
+
+#define CU_MALLOC_(api, size)        cu_malloc(size)
+#define CU_CALLOC_(api, nmemb, size) cu_calloc(nmemb, size)
+#define CU_REALLOC_(api, ptr, size)  cu_realloc(ptr, size)
+#define CU_FREE_(api, ptr)           cu_free(ptr)
+
+#endif
+
+#endif
@@ -0,0 +1,118 @@
+/* SPDX-FileCopyrightText: 2026 Comcast Cable Communications Management, LLC */
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#ifndef __ARENA_H__
+#define __ARENA_H__
+
+#include <stdarg.h>
+#include <stddef.h>
+
+#include "alloc.h"
+
+/* The default chunk size and alignment. */
+#define CU_ARENA_CHUNK_SIZE (4096)
+#define CU_ARENA_ALIGN      (2 * sizeof(void *))
+
+struct cu_arena_chunk;
+
+/* An arena hands out memory from large chunks by moving a pointer, and frees
+ * it all at once.  The fields are private.  A zeroed arena is ready to use
+ * with the defaults. */
+typedef struct {
+    struct cu_arena_chunk *head;
+    struct cu_arena_chunk *cur;
+    size_t chunk_size;
+    const cu_allocator_t *alloc;
+} cu_arena_t;
+
+/* A point in the arena to rewind to.  The fields are private. */
+typedef struct {
+    struct cu_arena_chunk *chunk;
+    size_t used;
+} cu_arena_mark_t;
+
+
+/**
+ * Sets up an arena.  Nothing is allocated until the first allocation.
+ *
+ * @param a          the arena to set up
+ * @param chunk_size the size of each chunk, or 0 for CU_ARENA_CHUNK_SIZE.
+ *                   Larger allocations get a chunk of their own.
+ *
+ * @retval 0 on success
+ * @retval -1 if the arguments are not valid
+ */
+int cu_arena_init(cu_arena_t *a, size_t chunk_size);
+
+
+/**
+ * The same as cu_arena_init(), but the chunks come from the given allocator,
+ * which must outlive the arena.  NULL means the one set with
+ * cu_set_allocator().
+ */
+int cu_arena_init_ex(cu_arena_t *a, size_t chunk_size,
+                     const cu_allocator_t *alloc);
+
+
+/**
+ * Frees all of the memory in the arena.  The arena can be used again.
+ */
+void cu_arena_destroy(cu_arena_t *a);
+
+
+/**
+ * Releases everything allocated from the arena, but keeps the chunks to
+ * reuse for later allocations.
+ */
+void cu_arena_reset(cu_arena_t *a);
+
+
+/**
+ * Allocates memory from the arena aligned to CU_ARENA_ALIGN, or to align for
+ * the _aligned version.  The memory is freed by cu_arena_destroy(),
+ * cu_arena_reset() or cu_arena_rewind(), never by free().
+ *
+ * @param a     the arena
+ * @param size  the number of bytes
+ * @param align the alignment, a power of 2
+ *
+ * @return the memory, or NULL if size is 0 or there is a failure
+ */
+void *cu_arena_alloc(cu_arena_t *a, size_t size);
+void *cu_arena_alloc_aligned(cu_arena_t *a, size_t size, size_t align);
+void *cu_arena_calloc(cu_arena_t *a, size_t nmemb, size_t size);
+
+
+/**
+ * Versions of memdup(), cu_strdup(), cu_strndup() and maprintf() that
+ * allocate from the arena.
+ */
+void *cu_arena_memdup(cu_arena_t *a, const void *src, size_t len);
+char *cu_arena_strdup(cu_arena_t *a, const char *s);
+char *cu_arena_strndup(cu_arena_t *a, const char *s, size_t maxlen);
+char *cu_arena_aprintf(cu_arena_t *a, const char *format, ...);
+char *cu_arena_vaprintf(cu_arena_t *a, const char *format, va_list args);
+
+
+/**
+ * Gets the current point in the arena, so everything allocated after it can
+ * be released with cu_arena_rewind().  The chunks are kept to reuse.
+ */
+cu_arena_mark_t cu_arena_mark(const cu_arena_t *a);
+void cu_arena_rewind(cu_arena_t *a, cu_arena_mark_t mark);
+
+
+/**
+ * 'must' versions of the above functions that will not return NULL as an
+ * error.  NULL is still returned for 0 bytes or a NULL input.
+ */
+void *cu_must_arena_alloc(cu_arena_t *a, size_t size);
+void *cu_must_arena_alloc_aligned(cu_arena_t *a, size_t size, size_t align);
+void *cu_must_arena_calloc(cu_arena_t *a, size_t nmemb, size_t size);
+void *cu_must_arena_memdup(cu_arena_t *a, const void *src, size_t len);
+char *cu_must_arena_strdup(cu_arena_t *a, const char *s);
+char *cu_must_arena_strndup(cu_arena_t *a, const char *s, size_t maxlen);
+char *cu_must_arena_aprintf(cu_arena_t *a, const char *format, ...);
+char *cu_must_arena_vaprintf(cu_arena_t *a, const char *format, va_list args);
+
+#endif
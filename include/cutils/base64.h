@@ -5,12 +5,51 @@
 
 #include <stddef.h>
 #include <stdint.h>
+#include <sys/uio.h>
 
 /* The options to specify. */
 #define B64_STD      (0x00)
 #define B64_URL      (0x01)
 #define B64_PROVIDED (0x80)
 
+/* Decoding: skip spaces, tabs, CR and LF anywhere in the input. */
+#define B64_SKIP_WS (0x40)
+
+/* Encoding: insert a line break after every n characters, but not after the
+ * last line.  The line break is LF, or CRLF if B64_CRLF is also given.  For
+ * PEM use B64_WRAP(64), for MIME use B64_WRAP(76) | B64_CRLF. */
+#define B64_WRAP(n) ((int) (((unsigned) (n) & 0x7fffff) << 8))
+#define B64_CRLF    (0x20)
+
+
+/* The exact length of n bytes once encoded with the given options, not
+ * counting a '\0'.  The arguments are evaluated more than once. */
+#define B64_ENCODED_LEN(opts, n) \
+    (B64_ENC_LEN_(opts, n) + B64_WRAP_LEN_(opts, B64_ENC_LEN_(opts, n)))
+
+/* The most bytes n characters can decode to.  For B64_STD with padding the
+ * result is up to 2 bytes shorter.  The arguments are evaluated more than
+ * once. */
+#define B64_DECODED_MAX_LEN(opts, n)                   \
+    ((B64_URL == (0x0f & (opts)))                      \
+         ? (((n) / 4) * 3 + ((((n) % 4) * 3) / 4))     \
+         : (((n) / 4) * 3))
+
+/* Helpers for the macros above. */
+#define B64_ENC_LEN_(opts, n)                                         \
+    ((B64_URL == (0x0f & (opts)))                                     \
+         ? (((n) / 3) * 4 + (((n) % 3) ? (((n) % 3) + 1) : 0))        \
+         : ((((n) / 3) + (((n) % 3) ? 1 : 0)) * 4))
+#define B64_WRAP_LEN_(opts, len)                                      \
+    ((((unsigned) (opts) >> 8) && (len))                              \
+         ? ((((len) - 1) / B64_WRAP_DIV_(opts))                       \
+            * ((B64_CRLF & (opts)) ? 2 : 1))                          \
+         : 0)
+
+/* Never 0, so compilers don't warn about the branch that isn't taken. */
+#define B64_WRAP_DIV_(opts) \
+    (((unsigned) (opts) >> 8) + !((unsigned) (opts) >> 8))
+
 /*----------------------------------------------------------------------------*/
 /*                             Standard Base64                                */
 /*----------------------------------------------------------------------------*/
@@ -23,13 +62,15 @@
  *
  *  @note: If provided, the output buffer must be large enough to handle the
  *         encoded payload.
- *  @note: If allocated, the returned buffer must have free() called to prevent
- *         a memory leak.
- *  @note: The returned buffer is '\0' terminated.
+ *  @note: If allocated, the returned buffer must have cu_free() called to
+ *         prevent a memory leak.
+ *  @note: If allocated, the returned buffer is '\0' terminated.  A provided
+ *         buffer needs B64_ENCODED_LEN() bytes and is not terminated.
  *  @note: The out_len value is equivalent to strlen() of the returned buffer.
  *
  *
- *  @param opts    the B64_STD or B64_URL form of the call to make
+ *  @param opts    the B64_STD or B64_URL form of the call to make, optionally
+ *                 with B64_WRAP() and B64_CRLF
  *  @param in      pointer to the raw data
  *  @param in_len  size of the raw data in bytes
  *  @param out     pointer to where the encoded data should be placed or NULL
@@ -51,7 +92,11 @@ int b64_encode(int opts, const void *in, size_t in_len,
  * into the output array.  Consumers of this function are responsible for making
  * sure the output buffer is large enough to hold all of the decoded data.
  *
- * @note: The output buffer must be large enough to handle the decoded payload.
+ * @note: The output buffer must be large enough to handle the decoded payload,
+ *        B64_DECODED_MAX_LEN() bytes is always enough.
+ * @note: If allocated, the returned buffer has a '\0' after the data, so
+ *        decoded text can be used as a string.
+ * @note: Pass B64_SKIP_WS in opts to accept line wrapped input such as PEM.
  *
  * @param enc  pointer to the encoded data
  * @param len  size of the raw data
@@ -69,4 +114,507 @@ int b64_encode(int opts, const void *in, size_t in_len,
 int b64_decode(int opts, const void *in, size_t in_len,
                void **out, size_t *out_len);
 
+
+/**
+ * Checks if the buffer is valid base64, with the same rules and results as
+ * b64_decode(), but without decoding it.
+ *
+ * @note: b64_decode() with a NULL out returns the decoded length with the
+ *        same checks.
+ *
+ * @param opts   the B64_STD or B64_URL form, optionally with B64_SKIP_WS
+ * @param in     pointer to the encoded data
+ * @param in_len size of the encoded data
+ *
+ *  @retval 0 if the data is valid, including if it is empty
+ *  @retval -1 if there is an invalid character or bad padding
+ *  @retval -2 if the length is not valid
+ *  @retval -5 if the arguments are not valid
+ */
+int b64_validate(int opts, const void *in, size_t in_len);
+
+
+/**
+ * The same as b64_encode() and b64_decode(), but large inputs are split
+ * between up to the given number of threads.  The results are the same as
+ * b64_encode() and b64_decode().
+ *
+ * @note: Each thread is given at least 64KB, so smaller inputs use fewer
+ *        threads.  B64_SKIP_WS decodes always use one thread.
+ *
+ * @param threads the most threads to use, including the caller's
+ */
+int b64_encode_parallel(int opts, const void *in, size_t in_len,
+                        char **out, size_t *out_len, int threads);
+int b64_decode_parallel(int opts, const void *in, size_t in_len,
+                        void **out, size_t *out_len, int threads);
+
+/**
+ * Decodes the base64 encoded buffer into the same buffer.  The decoded data
+ * is never longer than the encoded data and is written behind where it is
+ * read, so no other buffer is needed.
+ *
+ * @note: On failure the contents of the buffer are undefined.
+ *
+ * @param opts    the B64_STD or B64_URL form, optionally with B64_SKIP_WS
+ * @param buf     the encoded data, replaced by the decoded data
+ * @param len     size of the encoded data
+ * @param out_len pointer to the resulting length value
+ *
+ *  @retval 0 on success
+ *  @retval -1 if there is an input error
+ *  @retval -2 if the input buffer is not valid base64
+ *  @retval -5 if the arguments are not valid
+ */
+int b64_decode_inplace(int opts, void *buf, size_t len, size_t *out_len);
+
+
+/*----------------------------------------------------------------------------*/
+/*                             Streaming Base64                               */
+/*----------------------------------------------------------------------------*/
+
+/* The state of a streaming encoder.  The fields are private. */
+typedef struct {
+    int type;
+    size_t carry_len;
+    uint8_t carry[3];
+} b64_encoder_t;
+
+/* The state of a streaming decoder.  The fields are private. */
+typedef struct {
+    int type;
+    int done;
+    size_t carry_len;
+    uint8_t carry[4];
+} b64_decoder_t;
+
+
+/**
+ *  Starts encoding a stream of data into base64.  The output is the same as
+ *  b64_encode() of all of the data passed to b64_encoder_update() joined
+ *  together, without the '\0'.
+ *
+ *  @note: B64_WRAP() is not supported.
+ *
+ *  @param e    the encoder to set up
+ *  @param opts the B64_STD or B64_URL form to produce
+ *
+ *  @retval 0 on success
+ *  @retval -5 if the arguments are not valid
+ */
+int b64_encoder_init(b64_encoder_t *e, int opts);
+
+
+/**
+ *  Encodes the next chunk of the stream.  Up to 2 bytes that don't make a
+ *  full group are kept in the encoder until the next call.
+ *
+ *  @note: The output needs at most ((in_len + 2) / 3) * 4 bytes.
+ *
+ *  @param e       the encoder
+ *  @param in      the next chunk of raw data
+ *  @param in_len  size of the chunk in bytes
+ *  @param out     where the encoded data is written
+ *  @param out_len on input the size of out, on output the number of
+ *                 characters written
+ *
+ *  @retval 0 on success
+ *  @retval -3 if out is too small, nothing is consumed
+ *  @retval -5 if the arguments are not valid
+ */
+int b64_encoder_update(b64_encoder_t *e, const void *in, size_t in_len,
+                       char *out, size_t *out_len);
+
+
+/**
+ *  Encodes the bytes kept in the encoder along with any padding.  The
+ *  encoder can be used for a new stream afterwards.
+ *
+ *  @note: The output needs at most 4 bytes.
+ *
+ *  @param e       the encoder
+ *  @param out     where the encoded data is written
+ *  @param out_len on input the size of out, on output the number of
+ *                 characters written
+ *
+ *  @retval 0 on success
+ *  @retval -3 if out is too small
+ *  @retval -5 if the arguments are not valid
+ */
+int b64_encoder_final(b64_encoder_t *e, char *out, size_t *out_len);
+
+
+/**
+ *  Starts decoding a stream of base64 data.  The output and errors are the
+ *  same as b64_decode() of all of the data passed to b64_decoder_update()
+ *  joined together.
+ *
+ *  @note: B64_SKIP_WS is not supported.
+ *
+ *  @param d    the decoder to set up
+ *  @param opts the B64_STD or B64_URL form to decode
+ *
+ *  @retval 0 on success
+ *  @retval -5 if the arguments are not valid
+ */
+int b64_decoder_init(b64_decoder_t *d, int opts);
+
+
+/**
+ *  Decodes the next chunk of the stream.  Up to 3 characters that don't make
+ *  a full group are kept in the decoder until the next call.
+ *
+ *  @note: The output needs at most ((in_len + 3) / 4) * 3 bytes.
+ *  @note: After an error other than -3 the stream can't be continued, call
+ *         b64_decoder_init() to start over.
+ *
+ *  @param d       the decoder
+ *  @param in      the next chunk of encoded data
+ *  @param in_len  size of the chunk in bytes
+ *  @param out     where the decoded data is written
+ *  @param out_len on input the size of out, on output the number of bytes
+ *                 written
+ *
+ *  @retval 0 on success
+ *  @retval -1 if the data is not valid base64, including data after padding
+ *  @retval -3 if out is too small, nothing is consumed
+ *  @retval -5 if the arguments are not valid
+ */
+int b64_decoder_update(b64_decoder_t *d, const void *in, size_t in_len,
+                       void *out, size_t *out_len);
+
+
+/**
+ *  Decodes the characters kept in the decoder.  The decoder can be used for
+ *  a new stream afterwards.
+ *
+ *  @note: The output needs at most 2 bytes.
+ *
+ *  @param d       the decoder
+ *  @param out     where the decoded data is written
+ *  @param out_len on input the size of out, on output the number of bytes
+ *                 written
+ *
+ *  @retval 0 on success
+ *  @retval -1 if the data is not valid base64
+ *  @retval -2 if the stream was not a valid length
+ *  @retval -3 if out is too small
+ *  @retval -5 if the arguments are not valid
+ */
+int b64_decoder_final(b64_decoder_t *d, void *out, size_t *out_len);
+
+
+/*----------------------------------------------------------------------------*/
+/*                              Base64 to a Sink                              */
+/*----------------------------------------------------------------------------*/
+
+/* The most bytes passed to a sink at once. */
+#define B64_SINK_BLOCK (16 * 1024)
+
+/* Receives the next block of output.  Returns 0 to continue, anything else
+ * to stop. */
+typedef int (*b64_sink_fn)(void *ctx, const void *buf, size_t len);
+
+
+/**
+ *  Encodes the input into base64, passing the output to the sink in blocks
+ *  of up to B64_SINK_BLOCK bytes instead of building it in one buffer.  The
+ *  output is the same as b64_encode() without the '\0'.
+ *
+ *  @note: Only B64_STD and B64_URL are supported in opts.
+ *
+ *  @param opts   the B64_STD or B64_URL form of the call to make
+ *  @param in     pointer to the raw data
+ *  @param in_len size of the raw data in bytes
+ *  @param sink   called with each block of output
+ *  @param ctx    passed to the sink
+ *
+ *  @retval 0 on success
+ *  @retval -5 if the arguments are not valid
+ *  @retval -6 if the sink stopped the encoding
+ */
+int b64_encode_to_sink(int opts, const void *in, size_t in_len,
+                       b64_sink_fn sink, void *ctx);
+
+
+/**
+ *  Decodes the base64 input, passing the output to the sink in blocks of up
+ *  to B64_SINK_BLOCK bytes.  The output and errors are the same as
+ *  b64_decode().
+ *
+ *  @note: Only B64_STD and B64_URL are supported in opts.
+ *  @note: Errors are found as the input is decoded, so on failure the sink
+ *         may already have been given the data before the error.
+ *
+ *  @param opts   the B64_STD or B64_URL form of the call to make
+ *  @param in     pointer to the encoded data
+ *  @param in_len size of the encoded data
+ *  @param sink   called with each block of output
+ *  @param ctx    passed to the sink
+ *
+ *  @retval 0 on success
+ *  @retval -1 if there is an input error
+ *  @retval -2 if the input buffer is not valid base64
+ *  @retval -5 if the arguments are not valid
+ *  @retval -6 if the sink stopped the decoding
+ */
+int b64_decode_to_sink(int opts, const void *in, size_t in_len,
+                       b64_sink_fn sink, void *ctx);
+
+
+/**
+ *  The same as b64_encode_to_sink() and b64_decode_to_sink(), but the output
+ *  is written to a file descriptor.  Short writes are retried.
+ *
+ *  @retval -6 if a write() failed, errno is set
+ */
+int b64_encode_to_fd(int opts, const void *in, size_t in_len, int fd);
+int b64_decode_to_fd(int opts, const void *in, size_t in_len, int fd);
+
+
+/*----------------------------------------------------------------------------*/
+/*                           Scatter/Gather Base64                            */
+/*----------------------------------------------------------------------------*/
+
+/**
+ *  Encodes the data in a list of buffers into base64, as if the buffers were
+ *  joined together, without joining them.
+ *
+ *  @note: If allocated, the returned buffer must have cu_free() called to
+ *         prevent a memory leak, and is '\0' terminated.
+ *  @note: Only B64_STD, B64_URL and B64_PROVIDED are supported in opts.
+ *
+ *  @param opts    the B64_STD or B64_URL form of the call to make
+ *  @param iov     the buffers to encode
+ *  @param iovcnt  the number of buffers
+ *  @param out     pointer to where the encoded data should be placed
+ *  @param out_len pointer to the resulting length value, and the size of the
+ *                 provided buffer for B64_PROVIDED
+ *
+ *  @retval 0 on success
+ *  @retval -3 if the user specified buffer is too small
+ *  @retval -4 if there is a memory allocation issue
+ *  @retval -5 if the arguments are not valid
+ */
+int b64_encodev(int opts, const struct iovec *iov, int iovcnt,
+                char **out, size_t *out_len);
+
+
+/**
+ *  Decodes the base64 data in a list of buffers, as if the buffers were
+ *  joined together, without joining them.  Groups of characters may be split
+ *  across buffers.
+ *
+ *  @note: If allocated, the returned buffer must have cu_free() called to
+ *         prevent a memory leak, and has a '\0' after the data.
+ *  @note: Only B64_STD, B64_URL and B64_PROVIDED are supported in opts.
+ *
+ *  @param opts    the B64_STD or B64_URL form of the call to make
+ *  @param iov     the buffers to decode
+ *  @param iovcnt  the number of buffers
+ *  @param out     pointer to where the decoded data should be placed
+ *  @param out_len pointer to the resulting length value, and the size of the
+ *                 provided buffer for B64_PROVIDED
+ *
+ *  @retval 0 on success
+ *  @retval -1 if there is an input error
+ *  @retval -2 if the input buffer is not valid base64
+ *  @retval -3 if the user specified buffer is too small
+ *  @retval -4 if there is a memory allocation issue
+ *  @retval -5 if the arguments are not valid
+ */
+int b64_decodev(int opts, const struct iovec *iov, int iovcnt,
+                void **out, size_t *out_len);
+
+
+/*----------------------------------------------------------------------------*/
+/*                           Fixed Size Base64                                */
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Inline encoders and decoders for common small fixed sizes, such as MAC
+ * addresses (6), UUIDs (16) and SHA-256 digests (32).  They skip the option
+ * parsing and size checks of b64_encode() and b64_decode(), don't allocate,
+ * and map characters with arithmetic instead of tables or branches.
+ *
+ * The encoded form is B64_ENCODED_LEN(opts, n) characters, with no '\0'.
+ * The decoders return 0 on success or -1 if a character or the padding is
+ * not valid, with the same rules as b64_decode().
+ *
+ * Only B64_STD and B64_URL are looked at in opts.
+ */
+
+/* The character for a 6 bit value. */
+static inline char b64_fixed_char_(int opts, unsigned v)
+{
+    int url = (B64_URL == (0x0f & opts));
+    int c62 = url ? '-' : '+';
+    int c63 = url ? '_' : '/';
+    int c   = (int) v + 'A';
+
+    c += (25 < v) * ('a' - 26 - 'A');
+    c += (51 < v) * (('0' - 52) - ('a' - 26));
+    c += (61 < v) * ((c62 - 62) - ('0' - 52));
+    c += (62 < v) * ((c63 - 63) - (c62 - 62));
+
+    return (char) c;
+}
+
+
+/* The 6 bit value of a character, or -1 if it is not valid. */
+static inline int b64_fixed_val_(int opts, char ch)
+{
+    int url = (B64_URL == (0x0f & opts));
+    int c62 = url ? '-' : '+';
+    int c63 = url ? '_' : '/';
+    int c   = (unsigned char) ch;
+    int v   = -1;
+
+    v += (('A' <= c) & (c <= 'Z')) * (c - 'A' + 1);
+    v += (('a' <= c) & (c <= 'z')) * (c - 'a' + 26 + 1);
+    v += (('0' <= c) & (c <= '9')) * (c - '0' + 52 + 1);
+    v += (c62 == c) * (62 + 1);
+    v += (c63 == c) * (63 + 1);
+
+    return v;
+}
+
+
+static inline size_t b64_fixed_encode_(int opts, const uint8_t *in, size_t n,
+                                       char *out)
+{
+    size_t i = 0;
+    size_t j = 0;
+
+    for (; 3 <= (n - i); i += 3) {
+        uint32_t v = ((uint32_t) in[i] << 16) | ((uint32_t) in[i + 1] << 8) | in[i + 2];
+
+        out[j++] = b64_fixed_char_(opts, 0x3f & (v >> 18));
+        out[j++] = b64_fixed_char_(opts, 0x3f & (v >> 12));
+        out[j++] = b64_fixed_char_(opts, 0x3f & (v >> 6));
+        out[j++] = b64_fixed_char_(opts, 0x3f & v);
+    }
+
+    if (i < n) {
+        uint32_t v = (uint32_t) in[i] << 16;
+
+        if (2 == (n - i)) {
+            v |= (uint32_t) in[i + 1] << 8;
+        }
+
+        out[j++] = b64_fixed_char_(opts, 0x3f & (v >> 18));
+        out[j++] = b64_fixed_char_(opts, 0x3f & (v >> 12));
+        if (2 == (n - i)) {
+            out[j++] = b64_fixed_char_(opts, 0x3f & (v >> 6));
+        }
+        while ((B64_URL != (0x0f & opts)) && (0x03 & j)) {
+            out[j++] = '=';
+        }
+    }
+
+    return j;
+}
+
+
+/* The 6 bit value of a character shifted into place for a 24 bit group.  An
+ * invalid character is masked to a harmless value here, and flagged by the
+ * err bit the caller ORs together from b64_fixed_val_(). */
+#define B64_FIXED_BITS_(v, shift) ((uint32_t) (0x3f & (unsigned) (v)) << (shift))
+
+
+static inline int b64_fixed_decode_(int opts, const char *in, size_t n,
+                                    uint8_t *out)
+{
+    size_t i = 0;
+    size_t j = 0;
+    int err  = 0;
+
+    for (; 3 <= (n - j); j += 3) {
+        int a = b64_fixed_val_(opts, in[i]);
+        int b = b64_fixed_val_(opts, in[i + 1]);
+        int c = b64_fixed_val_(opts, in[i + 2]);
+        int d = b64_fixed_val_(opts, in[i + 3]);
+        uint32_t v;
+
+        err |= a | b | c | d;
+        v = B64_FIXED_BITS_(a, 18) | B64_FIXED_BITS_(b, 12)
+            | B64_FIXED_BITS_(c, 6) | B64_FIXED_BITS_(d, 0);
+
+        out[j]     = (uint8_t) (v >> 16);
+        out[j + 1] = (uint8_t) (v >> 8);
+        out[j + 2] = (uint8_t) v;
+        i += 4;
+    }
+
+    if (j < n) {
+        int a = b64_fixed_val_(opts, in[i]);
+        int b = b64_fixed_val_(opts, in[i + 1]);
+        uint32_t v;
+
+        err |= a | b;
+        v      = B64_FIXED_BITS_(a, 18) | B64_FIXED_BITS_(b, 12);
+        out[j] = (uint8_t) (v >> 16);
+        i += 2;
+
+        if (2 == (n - j)) {
+            int c = b64_fixed_val_(opts, in[i]);
+
+            err |= c;
+            v |= B64_FIXED_BITS_(c, 6);
+            out[j + 1] = (uint8_t) (v >> 8);
+            i++;
+        }
+
+        if (B64_URL != (0x0f & opts)) {
+            for (; 0x03 & i; i++) {
+                err |= ('=' == in[i]) ? 0 : -1;
+            }
+        }
+    }
+
+    return (err < 0) ? -1 : 0;
+}
+
+
+/* Encodes 6 bytes into 8 characters. */
+static inline size_t b64_encode6(int opts, const uint8_t in[6], char out[8])
+{
+    return b64_fixed_encode_(opts, in, 6, out);
+}
+
+
+/* Encodes 16 bytes into 24 characters, or 22 for B64_URL. */
+static inline size_t b64_encode16(int opts, const uint8_t in[16], char out[24])
+{
+    return b64_fixed_encode_(opts, in, 16, out);
+}
+
+
+/* Encodes 32 bytes into 44 characters, or 43 for B64_URL. */
+static inline size_t b64_encode32(int opts, const uint8_t in[32], char out[44])
+{
+    return b64_fixed_encode_(opts, in, 32, out);
+}
+
+
+/* Decodes 8 characters into 6 bytes. */
+static inline int b64_decode6(int opts, const char in[8], uint8_t out[6])
+{
+    return b64_fixed_decode_(opts, in, 6, out);
+}
+
+
+/* Decodes 24 characters, or 22 for B64_URL, into 16 bytes. */
+static inline int b64_decode16(int opts, const char in[24], uint8_t out[16])
+{
+    return b64_fixed_decode_(opts, in, 16, out);
+}
+
+
+/* Decodes 44 characters, or 43 for B64_URL, into 32 bytes. */
+static inline int b64_decode32(int opts, const char in[44], uint8_t out[32])
+{
+    return b64_fixed_decode_(opts, in, 32, out);
+}
+
 #endif /* __BASE64_H__ */
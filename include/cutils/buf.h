@@ -0,0 +1,91 @@
+/* SPDX-FileCopyrightText: 2026 Comcast Cable Communications Management, LLC */
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#ifndef __BUF_H__
+#define __BUF_H__
+
+#include <stdarg.h>
+#include <stddef.h>
+
+/* A growable buffer.  The capacity at least doubles each time it grows, so
+ * appending n bytes in any number of pieces costs O(n).  A zeroed buffer is
+ * empty and ready to use.
+ *
+ * Once anything has been appended, data is followed by a '\0' that is not
+ * counted in len, so text can be used as a string.  data, len and cap may be
+ * read, but should only be changed by these functions. */
+typedef struct {
+    char *data;
+    size_t len;
+    size_t cap;
+} cu_buf_t;
+
+
+/**
+ * Makes sure at least extra more bytes can be appended without the buffer
+ * growing.
+ *
+ * @retval 0 on success
+ * @retval -1 if the arguments are not valid
+ * @retval -2 if there is a memory allocation issue, the buffer is unchanged
+ */
+int cu_buf_reserve(cu_buf_t *b, size_t extra);
+
+
+/**
+ * Appends the data to the buffer.  The data may be part of the buffer
+ * itself.
+ *
+ * @retval 0 on success
+ * @retval -1 if the arguments are not valid
+ * @retval -2 if there is a memory allocation issue, the buffer is unchanged
+ */
+int cu_buf_append(cu_buf_t *b, const void *src, size_t len);
+
+
+/**
+ * Appends the printf() formatted text to the buffer.  The arguments must not
+ * point into the buffer, since it may move or be written over.
+ *
+ * @retval 0 on success
+ * @retval -1 if the arguments are not valid
+ * @retval -2 if there is a memory allocation issue, the buffer is unchanged
+ */
+int cu_buf_appendf(cu_buf_t *b, const char *format, ...);
+int cu_buf_vappendf(cu_buf_t *b, const char *format, va_list args);
+
+
+/**
+ * Takes the data out of the buffer, leaving the buffer empty.  The returned
+ * data must have cu_free() called on it, and is '\0' terminated.
+ *
+ * @param b   the buffer
+ * @param len set to the length of the data if not NULL
+ *
+ * @return the data, or NULL if nothing was ever appended
+ */
+char *cu_buf_detach(cu_buf_t *b, size_t *len);
+
+
+/**
+ * Empties the buffer but keeps the memory to reuse.
+ */
+void cu_buf_reset(cu_buf_t *b);
+
+
+/**
+ * Frees the memory in the buffer, leaving it empty.
+ */
+void cu_buf_destroy(cu_buf_t *b);
+
+
+/**
+ * 'must' versions of the above functions that call abort() instead of
+ * returning an allocation error.
+ */
+void cu_must_buf_reserve(cu_buf_t *b, size_t extra);
+void cu_must_buf_append(cu_buf_t *b, const void *src, size_t len);
+void cu_must_buf_appendf(cu_buf_t *b, const char *format, ...);
+void cu_must_buf_vappendf(cu_buf_t *b, const char *format, va_list args);
+
+#endif
@@ -9,7 +9,8 @@
 /**
  * Reads the specified file into buffer and returns the buffer and length
  * as data & length.  If the max value is set larger than 0, then only proceed
- * if the file size is less than or equal to the max specified.
+ * if the file size is less than or equal to the max specified.  The buffer
+ * must have cu_free() called on it.
  *
  * @param filename the path and name of the file to read
  * @param max      the max file size supported, or 0 for no limit
@@ -35,8 +35,17 @@
 #ifndef SHEREDOM_HASHMAP_H_INCLUDED
 #define SHEREDOM_HASHMAP_H_INCLUDED
 
+#include <stdint.h>
 #include <stdlib.h>
 
+/* The largest number of slots a hashmap can have.  64 bit hosts can go well
+ * past 1G slots, 32 bit hosts run out of address space first. */
+#if SIZE_MAX > 0xffffffffu
+#define HASHMAP_MAX_SIZE ((size_t) 1 << 40)
+#else
+#define HASHMAP_MAX_SIZE ((size_t) 1 << 30)
+#endif
+
 /* We need to keep keys and values. */
 struct hashmap_element {
     const char *key;
@@ -46,20 +55,40 @@ struct hashmap_element {
 };
 
 /* A hashmap has some maximum size and current size, as well as the data to
- * hold. */
+ * hold.
+ *
+ * The layout follows CPython's compact dict: a sparse index of table_size
+ * slots refers to a dense array of elements kept in insertion order.  The
+ * index slots are 8, 16 or 32 bits wide depending on how many elements the
+ * table can hold, so small tables cost far less than a full element per
+ * slot.  Past 4G slots the index slots are 64 bits wide. */
 typedef struct {
     size_t table_size;
     size_t size;
     struct hashmap_element *data;
+    size_t data_used;
+    size_t data_size;
+    void *index;
+    size_t epoch;
 } hashmap_t;
 
 
+/* A handle to an element that stays valid as the hashmap grows.  Using it
+ * skips hashing the key and probing for it.  The handle goes stale when the
+ * element is removed, or when removed elements are squeezed out of the dense
+ * array and the elements move (the epoch of the hashmap changes). */
+typedef struct {
+    size_t index;
+    size_t epoch;
+} hashmap_handle_t;
+
+
 /**
  *  Create a hashmap.
  *
  *  Optional if the hashmap_t object is set to zero.
  *
- *  @param initial_size The initial size of the hashmap.
+ *  @param initial_size The initial size of the hashmap, up to HASHMAP_MAX_SIZE.
  *  @param out_hashmap  The storage for the created hashmap.
  *
  *  @return On success 0 is returned.
@@ -69,6 +98,51 @@ typedef struct {
 int hashmap_create(size_t initial_size, hashmap_t *const out_hashmap);
 
 
+/**
+ *  Create a hashmap from arrays of keys and values in one pass.
+ *
+ *  This is much faster than repeated calls to hashmap_put() for large
+ *  tables: the table is sized once, all the keys are hashed in one loop and
+ *  the index is filled in slot order.  If a key appears more than once, the
+ *  last value wins, just like with hashmap_put().
+ *
+ *  @note: The keys are not copied, see hashmap_put().
+ *
+ *  @param keys        The array of n string keys.
+ *  @param lens        The array of n key lengths.
+ *  @param values      The array of n values.
+ *  @param n           The number of elements in each array.
+ *  @param out_hashmap The storage for the created hashmap.
+ *
+ *  @return On success 0 is returned.
+ *          -1 is returned if an input is invalid
+ *          -2 is returned if there was a memory failure
+ *          -3 is returned if there was not space due to hash collisions
+ */
+int hashmap_build(const char *const *keys, const size_t *lens,
+                  void *const *values, size_t n, hashmap_t *const out_hashmap);
+
+
+/**
+ *  Rebuild a hashmap with a new number of slots, reclaiming the space left by
+ *  removed elements.  Large hashmaps are rebuilt by several threads.
+ *
+ *  @note Handles are stale after this if any elements had been removed.
+ *
+ *  @param hashmap  The hashmap to rebuild.
+ *  @param new_size The number of slots, 0 to keep the current number.  This is
+ *                  rounded up to a power of 2 and to what the entries need.
+ *  @param threads  The most threads to use (up to 64), 1 for none.
+ *
+ *  @return 0 is returned if the hashmap was rebuilt
+ *          -1 is returned if the size is too large or an input is invalid
+ *          -2 is returned if there was a memory allocation failure
+ *          -3 is returned if there are too many collisions
+ *          On failure the hashmap is left as it was.
+ */
+int hashmap_rehash(hashmap_t *const hashmap, size_t new_size, int threads);
+
+
 /**
  *  Put an element into the hashmap.
  *
@@ -103,6 +177,54 @@ void *hashmap_get(const hashmap_t *const hashmap,
                   const char *const key, size_t len);
 
 
+/**
+ *  Get a handle to an element in the hashmap.
+ *
+ *  @param hashmap    The hashmap to get from.
+ *  @param key        The string key to use.
+ *  @param len        The length of the string key.
+ *  @param out_handle The storage for the handle.
+ *
+ *  @return 0 is returned if the element was found
+ *          1 is returned if no element was found
+ *          -1 is returned if an input is invalid
+ */
+int hashmap_get_handle(const hashmap_t *const hashmap,
+                       const char *const key, size_t len,
+                       hashmap_handle_t *const out_handle);
+
+
+/**
+ *  Get the value of an element by its handle.
+ *
+ *  @note: Handles are not valid after hashmap_destroy().
+ *
+ *  @param hashmap The hashmap the handle came from.
+ *  @param handle  The handle to use.
+ *
+ *  @return The value, or NULL if the handle is stale.
+ */
+void *hashmap_handle_get(const hashmap_t *const hashmap,
+                         const hashmap_handle_t *const handle);
+
+
+/**
+ *  Set the value of an element by its handle.
+ *
+ *  @note: Handles are not valid after hashmap_destroy().
+ *
+ *  @param hashmap The hashmap the handle came from.
+ *  @param handle  The handle to use.
+ *  @param value   The value to set.
+ *
+ *  @return 0 is returned if the value was set
+ *          1 is returned if the handle is stale
+ */
+int hashmap_handle_set(hashmap_t *const hashmap,
+                       const hashmap_handle_t *const handle,
+                       void *const value);
+
+
 /**
  *  Remove an element from the hashmap.
  *
@@ -137,6 +259,7 @@ const char *hashmap_remove_and_return_key(hashmap_t *const hashmap,
  *
  *  @note When the function f() returns 0, processing continues as normals.
  *        If non-zero is returned, then processing stops.
+ *  @note Values are visited in the order their keys were first inserted.
  *
  *  @param hashmap The hashmap to iterate over.
  *  @param f       The function pointer to call on each element.
@@ -156,6 +279,8 @@ int hashmap_iterate(const hashmap_t *const hashmap,
  *  @note When the function f() returns 0, processing continues as normals.
  *        If non-zero is returned, then processing stops.
  *        If -1 is returned, the current item is removed and iteration continues.
+ *  @note The key is not used after f() returns -1, so f() may free it first.
+ *  @note Elements are visited in the order their keys were first inserted.
  *
  *  @param hashmap The hashmap to iterate over.
  *  @param f       The function pointer to call on each element.
@@ -172,6 +297,43 @@ int hashmap_iterate_pairs(hashmap_t *const hashmap,
                           void *const context);
 
 
+/**
+ *  Iterate over the elements in part of a hashmap's dense array, so several
+ *  threads can scan one hashmap together.  Positions run from 0 up to
+ *  hashmap_range_size(), and each element in use is at exactly one position,
+ *  so splitting that span into ranges visits every element once.
+ *
+ *  @note The hashmap must not be changed while any range is being iterated.
+ *  @note When the function f() returns 0, processing continues as normals.
+ *        If non-zero is returned, then processing stops.
+ *
+ *  @param hashmap The hashmap to iterate over.
+ *  @param start   The first position to visit.
+ *  @param end     The position to stop before, clamped to hashmap_range_size().
+ *  @param f       The function pointer to call on each element.
+ *  @param context The context to pass as the first argument to f.
+ *
+ *  @return If the entire range was iterated then 0 is returned. Otherwise if
+ *          the callback function f returned non-zero then non-zero is returned.
+ */
+int hashmap_iterate_range(const hashmap_t *const hashmap,
+                          size_t start, size_t end,
+                          int (*f)(void *const context,
+                                   const struct hashmap_element *const),
+                          void *const context);
+
+
+/**
+ *  Get the number of positions to split between hashmap_iterate_range()
+ *  calls.
+ *
+ *  @param hashmap The hashmap to get the span of.
+ *
+ *  @return The number of positions, which is at least the number of entries.
+ */
+size_t hashmap_range_size(const hashmap_t *const hashmap);
+
+
 /**
  *  Get the size of the hashmap.
  *
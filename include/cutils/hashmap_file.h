@@ -0,0 +1,170 @@
+/* SPDX-FileCopyrightText: 2026 Comcast Cable Communications Management, LLC */
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#ifndef __HASHMAP_FILE_H__
+#define __HASHMAP_FILE_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* A hashmap that lives in a memory mapped file, so it can be reopened after a
+ * restart without being rebuilt.
+ *
+ * The file holds two alternating headers, an index of file offsets and an
+ * append only log of key/value records.  Changes are made in the mapping and
+ * committed by hashmap_file_sync(), which flushes the records and index and
+ * then writes a header with the next generation number.  If the process or
+ * host dies between syncs, the next open rebuilds the index from the log up
+ * to the last committed record, so a crash loses the changes since the last
+ * sync but never leaves a broken file.
+ *
+ * The fields are private. */
+typedef struct {
+    char *path;
+    int fd;
+    uint8_t *base;
+    size_t map_size;
+    uint64_t generation;
+    uint64_t table_size;
+    uint64_t log_end;
+    uint64_t count;
+    uint64_t used;
+    uint64_t dead;
+    int dirty;
+} hashmap_file_t;
+
+
+/**
+ *  Open a file backed hashmap, creating the file if it does not exist.
+ *
+ *  @param path        The path of the file.
+ *  @param out_hashmap The hashmap to open.
+ *
+ *  @return 0 is returned on success
+ *          -1 is returned if an input is invalid
+ *          -2 is returned if there was a memory allocation failure
+ *          -4 is returned if the file could not be opened, resized, mapped or
+ *             synced
+ *          -5 is returned if the file is not a valid hashmap file
+ */
+int hashmap_file_open(const char *path, hashmap_file_t *const out_hashmap);
+
+
+/**
+ *  Commit the changes made so far, so they survive a crash.
+ *
+ *  @param hashmap The hashmap to sync.
+ *
+ *  @return 0 is returned on success
+ *          -1 is returned if an input is invalid
+ *          -4 is returned if the file could not be written
+ */
+int hashmap_file_sync(hashmap_file_t *const hashmap);
+
+
+/**
+ *  Sync and close a file backed hashmap.
+ *
+ *  @param hashmap The hashmap to close.
+ *
+ *  @return 0 is returned on success
+ *          -1 is returned if an input is invalid
+ *          -4 is returned if the file could not be written, but the hashmap
+ *             is still closed
+ */
+int hashmap_file_close(hashmap_file_t *const hashmap);
+
+
+/**
+ *  Put a key and value into the hashmap.  Both are copied into the file.
+ *
+ *  @note Values returned by hashmap_file_get() are not valid after this.
+ *
+ *  @param hashmap   The hashmap to insert into.
+ *  @param key       The key to use.
+ *  @param key_len   The length of the key.
+ *  @param value     The value to insert.
+ *  @param value_len The length of the value.
+ *
+ *  @return 0 is returned on success
+ *          -1 is returned if an input is invalid
+ *          -2 is returned if there was a memory allocation failure
+ *          -4 is returned if the file could not be resized, mapped or synced
+ */
+int hashmap_file_put(hashmap_file_t *const hashmap,
+                     const void *key, size_t key_len,
+                     const void *value, size_t value_len);
+
+
+/**
+ *  Get a value from the hashmap.
+ *
+ *  @note The value points into the mapped file, and is valid until the next
+ *        change to the hashmap.
+ *
+ *  @param hashmap   The hashmap to get from.
+ *  @param key       The key to use.
+ *  @param key_len   The length of the key.
+ *  @param value     The storage for the value.
+ *  @param value_len The storage for the length of the value.
+ *
+ *  @return 0 is returned if the key was found
+ *          1 is returned if the key was not found
+ *          -1 is returned if an input is invalid
+ */
+int hashmap_file_get(const hashmap_file_t *const hashmap,
+                     const void *key, size_t key_len,
+                     const void **value, size_t *value_len);
+
+
+/**
+ *  Remove a key from the hashmap.
+ *
+ *  @note Values returned by hashmap_file_get() are not valid after this.
+ *
+ *  @param hashmap The hashmap to remove from.
+ *  @param key     The key to remove.
+ *  @param key_len The length of the key.
+ *
+ *  @return 0 is returned if the key was removed
+ *          1 is returned if the key was not found
+ *          -1 is returned if an input is invalid
+ *          -2 is returned if there was a memory allocation failure
+ *          -4 is returned if the file could not be resized, mapped or synced
+ */
+int hashmap_file_remove(hashmap_file_t *const hashmap,
+                        const void *key, size_t key_len);
+
+
+/**
+ *  Iterate over all the keys and values in the hashmap, in the order they
+ *  were last put.
+ *
+ *  @note When the function f() returns 0, processing continues as normals.
+ *        If non-zero is returned, then processing stops.  The hashmap must
+ *        not be changed while iterating.
+ *
+ *  @param hashmap The hashmap to iterate over.
+ *  @param f       The function pointer to call on each key and value.
+ *  @param context The context to pass as the first argument to f.
+ *
+ *  @return If the entire hashmap was iterated then 0 is returned. Otherwise if
+ *          the callback function f returned non-zero then non-zero is returned.
+ */
+int hashmap_file_iterate(const hashmap_file_t *const hashmap,
+                         int (*f)(void *const context,
+                                  const void *key, size_t key_len,
+                                  const void *value, size_t value_len),
+                         void *const context);
+
+
+/**
+ *  Get the number of entries in the hashmap.
+ *
+ *  @param hashmap The hashmap to get the size of.
+ *
+ *  @return The number of entries in the hashmap.
+ */
+size_t hashmap_file_num_entries(const hashmap_file_t *const hashmap);
+
+#endif
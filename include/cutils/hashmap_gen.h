@@ -0,0 +1,333 @@
+/* SPDX-FileCopyrightText: 2026 Comcast Cable Communications Management, LLC */
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#ifndef __HASHMAP_GEN_H__
+#define __HASHMAP_GEN_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "alloc.h"
+#include "hashmap.h"
+
+/* Generates a hashmap specialized for one key and value type, so values are
+ * stored inline and the hash and compare functions can be inlined.  It uses
+ * the same rules as hashmap_t: power of 2 tables, linear probing over a chain
+ * of max(8, 2 * log2(table_size)) slots, at most 75% of the slots used, and
+ * a collision only grows the table once it is at least 25% full.
+ *
+ * Example:
+ *
+ *      static inline uint64_t u32_hash(uint32_t k) { return k; }
+ *      static inline int u32_eq(uint32_t a, uint32_t b) { return a == b; }
+ *
+ *      CU_HASHMAP_DECLARE(u32map, uint32_t, double, u32_hash, u32_eq)
+ *
+ *      u32map_t m = { 0 };
+ *      u32map_put(&m, 7, 1.5);
+ *      double *v = u32map_get(&m, 7);
+ *      u32map_destroy(&m);
+ *
+ * This declares, for the given name:
+ *
+ *      name_t          The hashmap.  Zero it, or use name_create().
+ *      name_entry_t    A key and its value.
+ *
+ *      int name_create(size_t initial_size, name_t *out_hashmap);
+ *      void name_destroy(name_t *hashmap);
+ *      int name_put(name_t *hashmap, key_type key, value_type value);
+ *      value_type *name_get(const name_t *hashmap, key_type key);
+ *      int name_remove(name_t *hashmap, key_type key);
+ *      int name_iterate(name_t *hashmap,
+ *                       int (*f)(void *context, name_entry_t *entry),
+ *                       void *context);
+ *      size_t name_num_entries(const name_t *hashmap);
+ *
+ * The return values match the hashmap_t functions of the same name.  The
+ * pointer from name_get() is valid until the next name_put().
+ *
+ * @param name       The prefix for the generated types and functions.
+ * @param key_type   The key type, which is copied by value.
+ * @param value_type The value type, which is copied by value.
+ * @param hash_fn    A function or macro taking a key, returning an integer.
+ *                   The result is mixed, so even the identity is fine.
+ * @param eq_fn      A function or macro taking two keys, returning non-zero
+ *                   if they are equal.
+ */
+#define CU_HASHMAP_DECLARE(name, key_type, value_type, hash_fn, eq_fn)        \
+    typedef struct {                                                           \
+        key_type key;                                                          \
+        value_type value;                                                      \
+    } name##_entry_t;                                                          \
+                                                                               \
+    typedef struct {                                                           \
+        size_t table_size;                                                     \
+        size_t size;                                                           \
+        name##_entry_t *entries;                                               \
+        unsigned char *in_use;                                                 \
+    } name##_t;                                                                \
+                                                                               \
+    /* Returns the slot holding key, or the first empty slot in its chain     \
+     * (SIZE_MAX if there is none).  found is set if the key was found. */     \
+    static inline size_t name##_find_helper(const name##_t *const m,           \
+                                            const key_type key,                \
+                                            int *const found)                  \
+    {                                                                          \
+        size_t mask  = m->table_size - 1;                                      \
+        size_t curr  = (size_t) cu_hashmap_mix((uint64_t) hash_fn(key));       \
+        size_t empty = SIZE_MAX;                                               \
+        int chain    = cu_hashmap_chain_length(m->table_size);                 \
+                                                                               \
+        *found = 0;                                                            \
+        curr &= mask;                                                          \
+        for (int i = 0; i < chain; i++) {                                      \
+            if (m->in_use[curr]) {                                             \
+                if (eq_fn(m->entries[curr].key, key)) {                        \
+                    *found = 1;                                                \
+                    return curr;                                               \
+                }                                                              \
+            } else if (SIZE_MAX == empty) {                                    \
+                empty = curr;                                                  \
+            }                                                                  \
+            curr = (curr + 1) & mask;                                          \
+        }                                                                      \
+                                                                               \
+        return empty;                                                          \
+    }                                                                          \
+                                                                               \
+    /* Moves the entries into a table of table_size slots.  On failure the   \
+     * hashmap is left as it was. */                                           \
+    static inline int name##_resize_helper(name##_t *const m,                  \
+                                           const size_t table_size)            \
+    {                                                                          \
+        name##_t n;                                                            \
+                                                                               \
+        if ((SIZE_MAX / sizeof(name##_entry_t)) < table_size) {                \
+            return -2;                                                         \
+        }                                                                      \
+                                                                               \
+        n.table_size = table_size;                                             \
+        n.size       = 0;                                                      \
+        n.entries    = (name##_entry_t *) cu_malloc(table_size                 \
+                                                    * sizeof(name##_entry_t)); \
+        n.in_use     = (unsigned char *) cu_calloc(table_size, 1);             \
+        if (!n.entries || !n.in_use) {                                         \
+            cu_free(n.entries);                                                \
+            cu_free(n.in_use);                                                 \
+            return -2;                                                         \
+        }                                                                      \
+                                                                               \
+        for (size_t i = 0; i < m->table_size; i++) {                           \
+            if (m->in_use[i]) {                                                \
+                int found   = 0;                                               \
+                size_t slot = name##_find_helper(&n, m->entries[i].key,        \
+                                                 &found);                      \
+                if (SIZE_MAX == slot) {                                        \
+                    cu_free(n.entries);                                        \
+                    cu_free(n.in_use);                                         \
+                    return -3;                                                 \
+                }                                                              \
+                n.entries[slot] = m->entries[i];                               \
+                n.in_use[slot]  = 1;                                           \
+                n.size++;                                                      \
+            }                                                                  \
+        }                                                                      \
+                                                                               \
+        cu_free(m->entries);                                                   \
+        cu_free(m->in_use);                                                    \
+        *m = n;                                                                \
+                                                                               \
+        return 0;                                                              \
+    }                                                                          \
+                                                                               \
+    static inline int name##_create(size_t initial_size,                       \
+                                    name##_t *const out_hashmap)               \
+    {                                                                          \
+        if (!out_hashmap || (HASHMAP_MAX_SIZE < initial_size)) {               \
+            return -1;                                                         \
+        }                                                                      \
+                                                                               \
+        if (0 == initial_size) {                                               \
+            initial_size = 16;                                                 \
+        }                                                                      \
+                                                                               \
+        memset(out_hashmap, 0, sizeof(name##_t));                              \
+                                                                               \
+        return name##_resize_helper(out_hashmap,                               \
+                                    cu_hashmap_pow2(initial_size));            \
+    }                                                                          \
+                                                                               \
+    static inline void name##_destroy(name##_t *const m)                       \
+    {                                                                          \
+        if (m) {                                                               \
+            cu_free(m->entries);                                               \
+            cu_free(m->in_use);                                                \
+            memset(m, 0, sizeof(name##_t));                                    \
+        }                                                                      \
+    }                                                                          \
+                                                                               \
+    static inline int name##_put(name##_t *const m, const key_type key,        \
+                                 const value_type value)                       \
+    {                                                                          \
+        size_t slot = 0;                                                       \
+        int found   = 0;                                                       \
+                                                                               \
+        if (!m) {                                                              \
+            return -1;                                                         \
+        }                                                                      \
+                                                                               \
+        if (!m->entries) {                                                     \
+            int rv = name##_create(0, m);                                      \
+            if (rv) {                                                          \
+                return rv;                                                     \
+            }                                                                  \
+        }                                                                      \
+                                                                               \
+        for (;;) {                                                             \
+            int rv = 0;                                                        \
+                                                                               \
+            slot = name##_find_helper(m, key, &found);                         \
+            if (found                                                          \
+                || ((SIZE_MAX != slot)                                         \
+                    && (m->size < cu_hashmap_usable_size(m->table_size))))     \
+            {                                                                  \
+                break;                                                         \
+            }                                                                  \
+                                                                               \
+            if (m->size < (m->table_size / 4)) {                               \
+                return -3;                                                     \
+            }                                                                  \
+            if (HASHMAP_MAX_SIZE <= m->table_size) {                           \
+                return -1;                                                     \
+            }                                                                  \
+                                                                               \
+            rv = name##_resize_helper(m, m->table_size * 2);                   \
+            if (rv) {                                                          \
+                return rv;                                                     \
+            }                                                                  \
+        }                                                                      \
+                                                                               \
+        if (!found) {                                                          \
+            m->in_use[slot] = 1;                                               \
+            m->size++;                                                         \
+        }                                                                      \
+        m->entries[slot].key   = key;                                          \
+        m->entries[slot].value = value;                                        \
+                                                                               \
+        return 0;                                                              \
+    }                                                                          \
+                                                                               \
+    static inline value_type *name##_get(const name##_t *const m,              \
+                                         const key_type key)                   \
+    {                                                                          \
+        size_t slot = 0;                                                       \
+        int found   = 0;                                                       \
+                                                                               \
+        if (!m || !m->entries) {                                               \
+            return NULL;                                                       \
+        }                                                                      \
+                                                                               \
+        slot = name##_find_helper(m, key, &found);                             \
+        if (!found) {                                                          \
+            return NULL;                                                       \
+        }                                                                      \
+                                                                               \
+        return &m->entries[slot].value;                                        \
+    }                                                                          \
+                                                                               \
+    static inline int name##_remove(name##_t *const m, const key_type key)     \
+    {                                                                          \
+        size_t slot = 0;                                                       \
+        int found   = 0;                                                       \
+                                                                               \
+        if (!m || !m->entries) {                                               \
+            return 1;                                                          \
+        }                                                                      \
+                                                                               \
+        slot = name##_find_helper(m, key, &found);                             \
+        if (!found) {                                                          \
+            return 1;                                                          \
+        }                                                                      \
+                                                                               \
+        m->in_use[slot] = 0;                                                   \
+        m->size--;                                                             \
+                                                                               \
+        return 0;                                                              \
+    }                                                                          \
+                                                                               \
+    static inline int name##_iterate(name##_t *const m,                        \
+                                     int (*f)(void *const,                     \
+                                              name##_entry_t *const),          \
+                                     void *const context)                      \
+    {                                                                          \
+        if (!m) {                                                              \
+            return 0;                                                          \
+        }                                                                      \
+                                                                               \
+        for (size_t i = 0; i < m->table_size; i++) {                           \
+            if (m->in_use[i] && f(context, &m->entries[i])) {                  \
+                return 1;                                                      \
+            }                                                                  \
+        }                                                                      \
+                                                                               \
+        return 0;                                                              \
+    }                                                                          \
+                                                                               \
+    static inline size_t name##_num_entries(const name##_t *const m)           \
+    {                                                                          \
+        if (m) {                                                               \
+            return m->size;                                                    \
+        }                                                                      \
+                                                                               \
+        return 0;                                                              \
+    }
+
+
+/* Helpers shared by the generated hashmaps. */
+
+/* Murmur3's fmix64, so the low bits used for the slot depend on all of the
+ * bits of the hash. */
+static inline uint64_t cu_hashmap_mix(uint64_t h)
+{
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+
+    return h;
+}
+
+
+static inline int cu_hashmap_chain_length(const size_t table_size)
+{
+    int bits = 0;
+
+    while (((size_t) 1 << bits) < table_size) {
+        bits++;
+    }
+
+    return (2 * bits < 8) ? 8 : 2 * bits;
+}
+
+
+static inline size_t cu_hashmap_usable_size(const size_t table_size)
+{
+    return table_size - (table_size / 4);
+}
+
+
+static inline size_t cu_hashmap_pow2(const size_t n)
+{
+    size_t p = 1;
+
+    while (p < n) {
+        p <<= 1;
+    }
+
+    return p;
+}
+
+#endif
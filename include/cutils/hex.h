@@ -0,0 +1,86 @@
+/* SPDX-FileCopyrightText: 2026 Comcast Cable Communications Management, LLC */
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#ifndef __HEX_H__
+#define __HEX_H__
+
+#include <stddef.h>
+
+/* The options to specify.  CU_HEX_PROVIDED works the same way as
+ * B64_PROVIDED. */
+#define CU_HEX_LOWER    (0x00)
+#define CU_HEX_UPPER    (0x01)
+#define CU_HEX_PROVIDED (0x80)
+
+/* Put the character c between each byte, for example CU_HEX_SEP(':') for
+ * MAC addresses. */
+#define CU_HEX_SEP(c) ((int) ((unsigned) (unsigned char) (c) << 8))
+
+
+/* The exact length of n bytes once encoded with the given options, not
+ * counting a '\0'.  The arguments are evaluated more than once. */
+#define CU_HEX_ENCODED_LEN(opts, n) \
+    (((n) * 2) + ((((unsigned) (opts) >> 8) && (n)) ? ((n) - 1) : 0))
+
+/* The number of bytes n characters decode to.  The arguments are evaluated
+ * more than once. */
+#define CU_HEX_DECODED_LEN(opts, n) \
+    (((unsigned) (opts) >> 8) ? (((n) + 1) / 3) : ((n) / 2))
+
+
+/**
+ * Encodes the input into hex.
+ *
+ * @note: If allocated, the returned buffer must have cu_free() called to
+ *        prevent a memory leak, and is '\0' terminated.
+ * @note: A provided buffer (CU_HEX_PROVIDED) needs CU_HEX_ENCODED_LEN() bytes
+ *        and is not terminated.
+ *
+ * @param opts    CU_HEX_LOWER or CU_HEX_UPPER, optionally with CU_HEX_SEP()
+ *                and CU_HEX_PROVIDED
+ * @param in      pointer to the raw data
+ * @param in_len  size of the raw data in bytes
+ * @param out     pointer to where the encoded data should be placed or NULL
+ *                to just get the resulting length
+ * @param out_len pointer to the resulting length value, and the size of the
+ *                provided buffer
+ *
+ * @retval 0 on success
+ * @retval -2 if the input is too long to encode
+ * @retval -3 if the user specified buffer is too small
+ * @retval -4 if there is a memory allocation issue
+ * @retval -5 if the arguments are not valid
+ */
+int cu_hex_encode(int opts, const void *in, size_t in_len,
+                  char **out, size_t *out_len);
+
+
+/**
+ * Decodes the hex encoded buffer.  Both upper and lower case are accepted.
+ * If CU_HEX_SEP() is given, exactly that character must be between each
+ * byte.
+ *
+ * @note: If allocated, the returned buffer must have cu_free() called to
+ *        prevent a memory leak, and has a '\0' after the data.
+ * @note: A provided buffer (CU_HEX_PROVIDED) needs CU_HEX_DECODED_LEN()
+ *        bytes.
+ *
+ * @param opts    optionally CU_HEX_SEP() and CU_HEX_PROVIDED
+ * @param in      pointer to the encoded data
+ * @param in_len  size of the encoded data
+ * @param out     pointer to where the decoded data should be placed or NULL
+ *                to just check the input and get the resulting length
+ * @param out_len pointer to the resulting length value, and the size of the
+ *                provided buffer
+ *
+ * @retval 0 on success
+ * @retval -1 if there is an invalid character or separator
+ * @retval -2 if the length is not valid
+ * @retval -3 if the user specified buffer is too small
+ * @retval -4 if there is a memory allocation issue
+ * @retval -5 if the arguments are not valid
+ */
+int cu_hex_decode(int opts, const void *in, size_t in_len,
+                  void **out, size_t *out_len);
+
+#endif
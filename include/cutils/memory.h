@@ -10,7 +10,8 @@
  * Makes sure to free the pointer ptr in the event that the call to realloc()
  * fails.
  *
- * Note: See realloc() man pages for additional details.
+ * Note: See realloc() man pages for additional details.  ptr must come from
+ *       the cutils allocator, see alloc.h.
  *
  * @param ptr the pointer to the memory to resize
  * @param size the new size of the memory block
@@ -22,8 +23,8 @@ void *saferealloc(void *ptr, size_t size);
 
 /**
  * Duplicates a specified block of memory into a new buffer and returns the
- * buffer to the caller.  The new buffer must have free() called on it or it
- * will leak.
+ * buffer to the caller.  The new buffer must have cu_free() called on it or
+ * it will leak.
  *
  *
  * @param src the pointer to the memory to duplicate
@@ -36,11 +37,14 @@ void *memdup(const void *src, size_t len);
 
 /**
  * Appends a specified block of memory to an existing buffer and returns the
- * new buffer to the caller.  This call uses realloc, so the inputs must be
- * compatible with that call.
+ * new buffer to the caller.  This call uses cu_realloc(), so the buffer must
+ * come from the cutils allocator (see alloc.h), and must have cu_free()
+ * called on it when done.
  *
  * @note: Resulting buffer is NOT nil terminated.
  * @note: If there is a malloc failure, the buffer being appended to is freed.
+ * @note: The buffer is resized to the exact length on every call.  To build
+ *        a buffer from many pieces use cu_buf_t from buf.h instead.
  *
  * @param buf     the buffer to append to
  * @param buf_len the length of the a buffer in, and the new buffer length out
@@ -0,0 +1,91 @@
+/* SPDX-FileCopyrightText: 2026 Comcast Cable Communications Management, LLC */
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#ifndef __POOL_H__
+#define __POOL_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "alloc.h"
+
+/* A pool of fixed size objects carved out of page sized slabs.  Each thread
+ * keeps a small cache (magazine) of free objects, so allocating and freeing
+ * on a thread usually takes no lock.  Objects may be freed on any thread.
+ * Slabs are kept until the pool is destroyed, so memory use only grows to
+ * the most objects in use at once.  All pools share one thread-specific key,
+ * so there is no limit on how many can exist at once. */
+typedef struct cu_pool cu_pool_t;
+
+typedef struct {
+    size_t obj_size;  /* The object size after rounding for alignment. */
+    size_t slabs;     /* The number of slabs allocated. */
+    size_t capacity;  /* The number of objects in all of the slabs. */
+    size_t in_use;    /* The number of objects allocated and not freed. */
+    uint64_t allocs;  /* The number of calls to cu_pool_alloc/calloc(). */
+    uint64_t frees;   /* The number of calls to cu_pool_free(). */
+} cu_pool_stats_t;
+
+
+/**
+ * Creates a pool of objects of the given size.
+ *
+ * @param obj_size the size of each object
+ *
+ * @return the pool, or NULL if obj_size is 0 or there is a failure
+ */
+cu_pool_t *cu_pool_create(size_t obj_size);
+
+
+/**
+ * The same as cu_pool_create(), but the pool and its slabs come from the
+ * given allocator, which must outlive the pool.  NULL means the one set with
+ * cu_set_allocator().  The per thread caches always come from that one.
+ */
+cu_pool_t *cu_pool_create_ex(size_t obj_size, const cu_allocator_t *alloc);
+
+
+/**
+ * Destroys the pool and all of its objects.  No other thread may be using
+ * the pool, but threads that used it before may keep running.  They free
+ * their cache for it the next time they use another pool, or when they exit.
+ */
+void cu_pool_destroy(cu_pool_t *p);
+
+
+/**
+ * Allocates an object from the pool, aligned like malloc().  The _calloc
+ * version zeros it.
+ *
+ * @return the object, or NULL if there is a failure
+ */
+void *cu_pool_alloc(cu_pool_t *p);
+void *cu_pool_calloc(cu_pool_t *p);
+
+
+/**
+ * Returns an object to the pool it came from.  This may be called on any
+ * thread.  NULL is ignored.
+ */
+void cu_pool_free(cu_pool_t *p, void *obj);
+
+
+/**
+ * Gets the pool's statistics.  The counts from other threads are read
+ * without stopping them, so they may be slightly behind.
+ *
+ * @retval 0 on success
+ * @retval -1 if the arguments are not valid
+ */
+int cu_pool_stats(cu_pool_t *p, cu_pool_stats_t *stats);
+
+
+/**
+ * 'must' versions of the above functions that will not return NULL as an
+ * error.
+ */
+cu_pool_t *cu_must_pool_create(size_t obj_size);
+void *cu_must_pool_alloc(cu_pool_t *p);
+void *cu_must_pool_calloc(cu_pool_t *p);
+
+#endif
@@ -8,19 +8,19 @@
 #include <stddef.h>
 
 /* Versions of printf() that provide an on demand allocated buffer
- * that fits the data.  The returned buffer must be called with free(). */
+ * that fits the data.  The returned buffer must be called with cu_free(). */
 char *maprintf(const char *format, ...);
 char *mvaprintf(const char *format, va_list args);
 
 /* Versions of printf() that provide an on demand allocated buffer that
  * fits the data.  The strlen() value of the string is returned in len if
- * it is not NULL.  The returned buffer must be called with free(). */
+ * it is not NULL.  The returned buffer must be called with cu_free(). */
 char *mlaprintf(size_t *len, const char *format, ...);
 char *mlvaprintf(size_t *len, const char *format, va_list args);
 
 
 /* Versions of printf() that always provide an on demand allocated buffer
- * that fits the data.  The returned buffer must be called with free().
+ * that fits the data.  The returned buffer must be called with cu_free().
  * NULL is never returned, abort() is called instead. */
 char *must_maprintf(const char *format, ...);
 char *must_mvaprintf(const char *format, va_list args);
@@ -7,7 +7,8 @@
 #include <stddef.h>
 
 /**
- * 'standard' but often missing functions
+ * 'standard' but often missing functions.  The strings returned by the dup
+ * functions must have cu_free() called on them.
  */
 size_t cu_strnlen(const char *s, size_t maxlen);
 char *cu_strdup(const char *s);
@@ -0,0 +1,310 @@
+/* SPDX-FileCopyrightText: 2026 Comcast Cable Communications Management, LLC */
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "alloc.h"
+
+/*----------------------------------------------------------------------------*/
+/*                                   Macros                                   */
+/*----------------------------------------------------------------------------*/
+
+/* Counters may be bumped from many threads at once. */
+#define COUNTER_ADD(c, n) __atomic_fetch_add(&(c), (n), __ATOMIC_RELAXED)
+#define COUNTER_GET(c)    __atomic_load_n(&(c), __ATOMIC_RELAXED)
+#define COUNTER_SET(c, n) __atomic_store_n(&(c), (n), __ATOMIC_RELAXED)
+
+/*----------------------------------------------------------------------------*/
+/*                               Data Structures                              */
+/*----------------------------------------------------------------------------*/
+/* none */
+
+/*----------------------------------------------------------------------------*/
+/*                             Function Prototypes                            */
+/*----------------------------------------------------------------------------*/
+
+static void *std_malloc(void *ctx, size_t size);
+static void *std_calloc(void *ctx, size_t nmemb, size_t size);
+static void *std_realloc(void *ctx, void *ptr, size_t size);
+static void std_free(void *ctx, void *ptr);
+
+/*----------------------------------------------------------------------------*/
+/*                            File Scoped Variables                           */
+/*----------------------------------------------------------------------------*/
+
+static const cu_allocator_t std_allocator = {
+    .malloc_fn  = std_malloc,
+    .calloc_fn  = std_calloc,
+    .realloc_fn = std_realloc,
+    .free_fn    = std_free,
+    .ctx        = NULL,
+};
+
+static cu_allocator_t allocator = {
+    .malloc_fn  = std_malloc,
+    .calloc_fn  = std_calloc,
+    .realloc_fn = std_realloc,
+    .free_fn    = std_free,
+    .ctx        = NULL,
+};
+
+#ifdef CU_ALLOC_STATS
+static cu_alloc_stats_t stats;
+
+static const char *api_names[CU_ALLOC_API_COUNT] = {
+    [CU_ALLOC_API_MAPRINTF]  = "maprintf",
+    [CU_ALLOC_API_MEMAPPEND] = "memappend",
+    [CU_ALLOC_API_STRNDUP]   = "cu_strndup",
+    [CU_ALLOC_API_B64]       = "b64",
+    [CU_ALLOC_API_FREADALL]  = "freadall",
+    [CU_ALLOC_API_HASHMAP]   = "hashmap",
+};
+#endif
+
+/*----------------------------------------------------------------------------*/
+/*                             Internal functions                             */
+/*----------------------------------------------------------------------------*/
+
+static void *std_malloc(void *ctx, size_t size)
+{
+    (void) ctx;
+    return malloc(size);
+}
+
+
+static void *std_calloc(void *ctx, size_t nmemb, size_t size)
+{
+    (void) ctx;
+    return calloc(nmemb, size);
+}
+
+
+static void *std_realloc(void *ctx, void *ptr, size_t size)
+{
+    (void) ctx;
+    return realloc(ptr, size);
+}
+
+
+static void std_free(void *ctx, void *ptr)
+{
+    (void) ctx;
+    free(ptr);
+}
+
+
+#ifdef CU_ALLOC_STATS
+/* Counts an allocation or reallocation of size bytes against the API. */
+static void count(int api, uint64_t *counter, size_t size)
+{
+    cu_alloc_api_stats_t *s = &stats.api[api];
+    size_t b                = 0;
+
+    while ((b < (CU_ALLOC_HIST_BUCKETS - 1)) && (((size_t) 1 << b) < size)) {
+        b++;
+    }
+
+    COUNTER_ADD(*counter, 1);
+    COUNTER_ADD(s->bytes, size);
+    COUNTER_ADD(s->hist[b], 1);
+}
+#endif
+
+/*----------------------------------------------------------------------------*/
+/*                             External Functions                             */
+/*----------------------------------------------------------------------------*/
+
+int cu_set_allocator(const cu_allocator_t *a)
+{
+    if (!a) {
+        allocator = std_allocator;
+        return 0;
+    }
+
+    if (!a->malloc_fn || !a->realloc_fn || !a->free_fn) {
+        return -1;
+    }
+
+    allocator = *a;
+
+    return 0;
+}
+
+
+const cu_allocator_t *cu_get_allocator(void)
+{
+    return &allocator;
+}
+
+
+void *cu_malloc(size_t size)
+{
+    return allocator.malloc_fn(allocator.ctx, size);
+}
+
+
+void *cu_calloc(size_t nmemb, size_t size)
+{
+    return cu_calloc_ex(&allocator, nmemb, size);
+}
+
+
+void *cu_realloc(void *ptr, size_t size)
+{
+    return allocator.realloc_fn(allocator.ctx, ptr, size);
+}
+
+
+void cu_free(void *ptr)
+{
+    if (ptr) {
+        allocator.free_fn(allocator.ctx, ptr);
+    }
+}
+
+
+void *cu_malloc_ex(const cu_allocator_t *a, size_t size)
+{
+    if (!a) {
+        a = &allocator;
+    }
+
+    return a->malloc_fn(a->ctx, size);
+}
+
+
+void *cu_calloc_ex(const cu_allocator_t *a, size_t nmemb, size_t size)
+{
+    void *p = NULL;
+
+    if (!a) {
+        a = &allocator;
+    }
+
+    if (a->calloc_fn) {
+        return a->calloc_fn(a->ctx, nmemb, size);
+    }
+
+    if (size && ((SIZE_MAX / size) < nmemb)) {
+        return NULL;
+    }
+
+    p = a->malloc_fn(a->ctx, nmemb * size);
+    if (p) {
+        memset(p, 0, nmemb * size);
+    }
+
+    return p;
+}
+
+
+void *cu_realloc_ex(const cu_allocator_t *a, void *ptr, size_t size)
+{
+    if (!a) {
+        a = &allocator;
+    }
+
+    return a->realloc_fn(a->ctx, ptr, size);
+}
+
+
+void cu_free_ex(const cu_allocator_t *a, void *ptr)
+{
+    if (!a) {
+        a = &allocator;
+    }
+
+    if (ptr) {
+        a->free_fn(a->ctx, ptr);
+    }
+}
+
+
+#ifdef CU_ALLOC_STATS
+/*-- Allocation stats --------------------------------------------------------*/
+
+
+void cu_alloc_stats(cu_alloc_stats_t *out)
+{
+    const uint64_t *src = (const uint64_t *) &stats;
+    uint64_t *dst       = (uint64_t *) out;
+
+    if (!out) {
+        return;
+    }
+
+    for (size_t i = 0; i < (sizeof(stats) / sizeof(uint64_t)); i++) {
+        dst[i] = COUNTER_GET(src[i]);
+    }
+}
+
+
+void cu_alloc_stats_reset(void)
+{
+    uint64_t *c = (uint64_t *) &stats;
+
+    for (size_t i = 0; i < (sizeof(stats) / sizeof(uint64_t)); i++) {
+        COUNTER_SET(c[i], 0);
+    }
+}
+
+
+const char *cu_alloc_api_name(int api)
+{
+    if ((api < 0) || (CU_ALLOC_API_COUNT <= api)) {
+        return NULL;
+    }
+
+    return api_names[api];
+}
+
+
+void *cu_malloc_api_(int api, size_t size)
+{
+    void *p = cu_malloc(size);
+
+    if (p) {
+        count(api, &stats.api[api].allocs, size);
+    }
+
+    return p;
+}
+
+
+void *cu_calloc_api_(int api, size_t nmemb, size_t size)
+{
+    void *p = cu_calloc(nmemb, size);
+
+    if (p) {
+        count(api, &stats.api[api].allocs, nmemb * size);
+    }
+
+    return p;
+}
+
+
+void *cu_realloc_api_(int api, void *ptr, size_t size)
+{
+    int had = (NULL != ptr);
+    void *p = cu_realloc(ptr, size);
+
+    if (p) {
+        cu_alloc_api_stats_t *s = &stats.api[api];
+
+        count(api, (had) ? &s->reallocs : &s->allocs, size);
+    }
+
+    return p;
+}
+
+
+void cu_free_api_(int api, void *ptr)
+{
+    if (ptr) {
+        COUNTER_ADD(stats.api[api].frees, 1);
+        cu_free(ptr);
+    }
+}
+#endif
@@ -0,0 +1,391 @@
+/* SPDX-FileCopyrightText: 2026 Comcast Cable Communications Management, LLC */
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "alloc.h"
+#include "arena.h"
+#include "must.h"
+#include "strings.h"
+
+/*----------------------------------------------------------------------------*/
+/*                                   Macros                                   */
+/*----------------------------------------------------------------------------*/
+/* none */
+
+/*----------------------------------------------------------------------------*/
+/*                               Data Structures                              */
+/*----------------------------------------------------------------------------*/
+
+/* The chunks are kept in the order they are used, so everything before cur
+ * (and the start of cur) is in use and everything after it is free. */
+struct cu_arena_chunk {
+    struct cu_arena_chunk *next;
+    size_t size;
+    size_t used;
+    unsigned char data[];
+};
+
+/*----------------------------------------------------------------------------*/
+/*                            File Scoped Variables                           */
+/*----------------------------------------------------------------------------*/
+/* none */
+
+/*----------------------------------------------------------------------------*/
+/*                             Function Prototypes                            */
+/*----------------------------------------------------------------------------*/
+/* none */
+
+/*----------------------------------------------------------------------------*/
+/*                             Internal functions                             */
+/*----------------------------------------------------------------------------*/
+
+/* Returns the padding needed to align the next allocation in the chunk. */
+static size_t get_pad(const struct cu_arena_chunk *c, size_t align)
+{
+    uintptr_t p = (uintptr_t) &c->data[c->used];
+
+    return (size_t) ((align - (p & (align - 1))) & (align - 1));
+}
+
+
+static int fits(const struct cu_arena_chunk *c, size_t size, size_t align)
+{
+    size_t pad = get_pad(c, align);
+
+    return (pad <= (c->size - c->used)) && (size <= (c->size - c->used - pad));
+}
+
+
+/* Moves to the next chunk, reusing it if it is big enough or adding a new
+ * one in front of it if not. */
+static struct cu_arena_chunk *next_chunk(cu_arena_t *a, size_t size,
+                                         size_t align)
+{
+    struct cu_arena_chunk *c = (a->cur) ? a->cur->next : a->head;
+    size_t chunk_size        = (a->chunk_size) ? a->chunk_size : CU_ARENA_CHUNK_SIZE;
+
+    if (c) {
+        c->used = 0;
+        if (fits(c, size, align)) {
+            a->cur = c;
+            return c;
+        }
+    }
+
+    if ((SIZE_MAX - sizeof(struct cu_arena_chunk) - align) < size) {
+        return NULL;
+    }
+    if (chunk_size < (size + align)) {
+        chunk_size = size + align;
+    }
+
+    c = cu_malloc_ex(a->alloc, sizeof(struct cu_arena_chunk) + chunk_size);
+    if (!c) {
+        return NULL;
+    }
+    c->size = chunk_size;
+    c->used = 0;
+
+    if (a->cur) {
+        c->next      = a->cur->next;
+        a->cur->next = c;
+    } else {
+        c->next = a->head;
+        a->head = c;
+    }
+    a->cur = c;
+
+    return c;
+}
+
+/*----------------------------------------------------------------------------*/
+/*                             External Functions                             */
+/*----------------------------------------------------------------------------*/
+
+int cu_arena_init(cu_arena_t *a, size_t chunk_size)
+{
+    return cu_arena_init_ex(a, chunk_size, NULL);
+}
+
+
+int cu_arena_init_ex(cu_arena_t *a, size_t chunk_size,
+                     const cu_allocator_t *alloc)
+{
+    if (!a) {
+        return -1;
+    }
+
+    memset(a, 0, sizeof(cu_arena_t));
+    a->chunk_size = chunk_size;
+    a->alloc      = alloc;
+
+    return 0;
+}
+
+
+void cu_arena_destroy(cu_arena_t *a)
+{
+    struct cu_arena_chunk *c = NULL;
+
+    if (!a) {
+        return;
+    }
+
+    c = a->head;
+    while (c) {
+        struct cu_arena_chunk *next = c->next;
+
+        cu_free_ex(a->alloc, c);
+        c = next;
+    }
+
+    a->head = NULL;
+    a->cur  = NULL;
+}
+
+
+void cu_arena_reset(cu_arena_t *a)
+{
+    cu_arena_mark_t start = { NULL, 0 };
+
+    cu_arena_rewind(a, start);
+}
+
+
+void *cu_arena_alloc(cu_arena_t *a, size_t size)
+{
+    return cu_arena_alloc_aligned(a, size, CU_ARENA_ALIGN);
+}
+
+
+void *cu_arena_alloc_aligned(cu_arena_t *a, size_t size, size_t align)
+{
+    struct cu_arena_chunk *c = NULL;
+    void *p                  = NULL;
+
+    if (!a || !size || !align || (align & (align - 1))) {
+        return NULL;
+    }
+
+    c = a->cur;
+    if (!c || !fits(c, size, align)) {
+        c = next_chunk(a, size, align);
+        if (!c) {
+            return NULL;
+        }
+    }
+
+    c->used += get_pad(c, align);
+    p = &c->data[c->used];
+    c->used += size;
+
+    return p;
+}
+
+
+void *cu_arena_calloc(cu_arena_t *a, size_t nmemb, size_t size)
+{
+    void *p = NULL;
+
+    if (size && ((SIZE_MAX / size) < nmemb)) {
+        return NULL;
+    }
+
+    p = cu_arena_alloc(a, nmemb * size);
+    if (p) {
+        memset(p, 0, nmemb * size);
+    }
+
+    return p;
+}
+
+
+void *cu_arena_memdup(cu_arena_t *a, const void *src, size_t len)
+{
+    void *p = NULL;
+
+    if (src && len) {
+        p = cu_arena_alloc(a, len);
+        if (p) {
+            memcpy(p, src, len);
+        }
+    }
+
+    return p;
+}
+
+
+char *cu_arena_strdup(cu_arena_t *a, const char *s)
+{
+    return cu_arena_strndup(a, s, SIZE_MAX);
+}
+
+
+char *cu_arena_strndup(cu_arena_t *a, const char *s, size_t maxlen)
+{
+    char *p = NULL;
+
+    if (s && (0 < maxlen)) {
+        size_t len = cu_strnlen(s, maxlen);
+
+        p = cu_arena_alloc_aligned(a, len + 1, 1);
+        if (p) {
+            memcpy(p, s, len);
+            p[len] = '\0';
+        }
+    }
+
+    return p;
+}
+
+
+char *cu_arena_aprintf(cu_arena_t *a, const char *format, ...)
+{
+    va_list args;
+    char *p = NULL;
+
+    va_start(args, format);
+    p = cu_arena_vaprintf(a, format, args);
+    va_end(args);
+
+    return p;
+}
+
+
+char *cu_arena_vaprintf(cu_arena_t *a, const char *format, va_list args)
+{
+    cu_arena_mark_t mark;
+    va_list copy;
+    char *p = NULL;
+    int l;
+
+    if (!a || !format) {
+        return NULL;
+    }
+
+    va_copy(copy, args);
+    l = vsnprintf(NULL, 0, format, copy);
+    va_end(copy);
+    if (l < 0) {
+        return NULL;
+    }
+
+    mark = cu_arena_mark(a);
+    p    = cu_arena_alloc_aligned(a, (size_t) l + 1, 1);
+    if (p && (l != vsnprintf(p, (size_t) l + 1, format, args))) {
+        cu_arena_rewind(a, mark);
+        p = NULL;
+    }
+
+    return p;
+}
+
+
+cu_arena_mark_t cu_arena_mark(const cu_arena_t *a)
+{
+    cu_arena_mark_t mark = { NULL, 0 };
+
+    if (a && a->cur) {
+        mark.chunk = a->cur;
+        mark.used  = a->cur->used;
+    }
+
+    return mark;
+}
+
+
+void cu_arena_rewind(cu_arena_t *a, cu_arena_mark_t mark)
+{
+    if (!a) {
+        return;
+    }
+
+    /* The chunks after the mark are reset as they are reused. */
+    a->cur = mark.chunk;
+    if (a->cur) {
+        a->cur->used = mark.used;
+    }
+}
+
+
+/*-- Must versions -----------------------------------------------------------*/
+
+
+void *cu_must_arena_alloc(cu_arena_t *a, size_t size)
+{
+    return cu_must_arena_alloc_aligned(a, size, CU_ARENA_ALIGN);
+}
+
+
+void *cu_must_arena_alloc_aligned(cu_arena_t *a, size_t size, size_t align)
+{
+    if (!size) {
+        return NULL;
+    }
+
+    return must(cu_arena_alloc_aligned(a, size, align));
+}
+
+
+void *cu_must_arena_calloc(cu_arena_t *a, size_t nmemb, size_t size)
+{
+    if (!nmemb || !size) {
+        return NULL;
+    }
+
+    return must(cu_arena_calloc(a, nmemb, size));
+}
+
+
+void *cu_must_arena_memdup(cu_arena_t *a, const void *src, size_t len)
+{
+    if (src && len) {
+        return must(cu_arena_memdup(a, src, len));
+    }
+
+    return NULL;
+}
+
+
+char *cu_must_arena_strdup(cu_arena_t *a, const char *s)
+{
+    return cu_must_arena_strndup(a, s, SIZE_MAX);
+}
+
+
+char *cu_must_arena_strndup(cu_arena_t *a, const char *s, size_t maxlen)
+{
+    if (s && (0 < maxlen)) {
+        return must(cu_arena_strndup(a, s, maxlen));
+    }
+
+    return NULL;
+}
+
+
+char *cu_must_arena_aprintf(cu_arena_t *a, const char *format, ...)
+{
+    va_list args;
+    char *p = NULL;
+
+    va_start(args, format);
+    p = cu_must_arena_vaprintf(a, format, args);
+    va_end(args);
+
+    return p;
+}
+
+
+char *cu_must_arena_vaprintf(cu_arena_t *a, const char *format, va_list args)
+{
+    if (!format) {
+        return NULL;
+    }
+
+    return must(cu_arena_vaprintf(a, format, args));
+}
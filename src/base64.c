@@ -1,10 +1,17 @@
 /* SPDX-FileCopyrightText: 2021-2022 Comcast Cable Communications Management, LLC */
 /* SPDX-License-Identifier: Apache-2.0 */
 
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <pthread.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 
+#include "alloc.h"
 #include "base64.h"
 
 /*----------------------------------------------------------------------------*/
@@ -13,12 +20,86 @@
 #define ENCODE 0
 #define DECODE 1
 
+/* The most threads used, and the least input each thread is given. */
+#define B64_MAX_THREADS      (64)
+#define B64_MIN_THREAD_BYTES (64 * 1024)
+
+/* The input per block for the sink functions, so the output of each block
+ * (with the end of the stream) fits in B64_SINK_BLOCK bytes. */
+#define B64_SINK_ENC_IN ((B64_SINK_BLOCK / 4) * 3)
+#define B64_SINK_DEC_IN ((B64_SINK_BLOCK / 3) * 4)
+
+/* Used to build the lookup tables at compile time.  c62 and c63 are the
+ * characters the alphabet uses for 62 and 63. */
+#define ENC_CHAR(x, c62, c63)                          \
+    (((x) < 26)   ? 'A' + (x)                          \
+     : ((x) < 52) ? 'a' + ((x) - 26)                   \
+     : ((x) < 62) ? '0' + ((x) - 52)                   \
+     : (62 == (x)) ? (c62)                             \
+                   : (c63))
+
+#define ENC_PAIR(i, c62, c63) \
+    { ENC_CHAR((i) >> 6, c62, c63), ENC_CHAR((i) & 0x3f, c62, c63) }
+
+#define DEC_VAL(c, c62, c63)                           \
+    ((('A' <= (c)) && ((c) <= 'Z'))   ? (c) - 'A'      \
+     : (('a' <= (c)) && ((c) <= 'z')) ? (c) - 'a' + 26 \
+     : (('0' <= (c)) && ((c) <= '9')) ? (c) - '0' + 52 \
+     : ((c62) == (c))                 ? 62             \
+     : ((c63) == (c))                 ? 63             \
+                                      : -1)
+
+/* Invalid characters set the top byte, which valid ones never touch. */
+#define DEC_ENTRY(c, shift, c62, c63)                  \
+    ((DEC_VAL(c, c62, c63) < 0)                        \
+         ? 0xff000000u                                 \
+         : ((uint32_t) DEC_VAL(c, c62, c63) << (shift)))
+
+#define REP4(M, i, ...)                                            \
+    M((i), __VA_ARGS__), M((i) + 1, __VA_ARGS__),                  \
+        M((i) + 2, __VA_ARGS__), M((i) + 3, __VA_ARGS__)
+#define REP16(M, i, ...)                                           \
+    REP4(M, (i), __VA_ARGS__), REP4(M, (i) + 4, __VA_ARGS__),      \
+        REP4(M, (i) + 8, __VA_ARGS__), REP4(M, (i) + 12, __VA_ARGS__)
+#define REP64(M, i, ...)                                           \
+    REP16(M, (i), __VA_ARGS__), REP16(M, (i) + 16, __VA_ARGS__),   \
+        REP16(M, (i) + 32, __VA_ARGS__), REP16(M, (i) + 48, __VA_ARGS__)
+#define REP256(M, i, ...)                                          \
+    REP64(M, (i), __VA_ARGS__), REP64(M, (i) + 64, __VA_ARGS__),   \
+        REP64(M, (i) + 128, __VA_ARGS__), REP64(M, (i) + 192, __VA_ARGS__)
+#define REP1024(M, i, ...)                                         \
+    REP256(M, (i), __VA_ARGS__), REP256(M, (i) + 256, __VA_ARGS__), \
+        REP256(M, (i) + 512, __VA_ARGS__), REP256(M, (i) + 768, __VA_ARGS__)
+#define REP4096(M, i, ...)                                             \
+    REP1024(M, (i), __VA_ARGS__), REP1024(M, (i) + 1024, __VA_ARGS__), \
+        REP1024(M, (i) + 2048, __VA_ARGS__),                           \
+        REP1024(M, (i) + 3072, __VA_ARGS__)
+
 /*----------------------------------------------------------------------------*/
 /*                               Data Structures                              */
 /*----------------------------------------------------------------------------*/
 struct b64_cfg {
     const char enc_map[65];
     const int8_t dec_map[256];
+
+    /* The 2 characters for each 12 bit value. */
+    const char enc_pairs[4096][2];
+
+    /* The value of each character shifted into place for each of the 4
+     * positions in a group. */
+    const uint32_t dec_shift[4][256];
+};
+
+/* One piece of the input for a thread to process. */
+struct b64_worker {
+    const struct b64_cfg *cfg;
+    int dir;
+    const uint8_t *in;
+    size_t len;
+    uint8_t *out;
+    size_t out_len;
+    int last;
+    int rv;
 };
 
 /*----------------------------------------------------------------------------*/
@@ -51,6 +132,13 @@ static const struct b64_cfg b64_data[2] = {
             -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, /* 0xe0-0xef */
             -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, /* 0xf0-0xff */
         },
+        .enc_pairs = { REP4096(ENC_PAIR, 0, '+', '/') },
+        .dec_shift = {
+            { REP256(DEC_ENTRY, 0, 18, '+', '/') },
+            { REP256(DEC_ENTRY, 0, 12, '+', '/') },
+            { REP256(DEC_ENTRY, 0,  6, '+', '/') },
+            { REP256(DEC_ENTRY, 0,  0, '+', '/') },
+        },
     },
     {
         /* URL */
@@ -77,30 +165,78 @@ static const struct b64_cfg b64_data[2] = {
             -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, /* 0xe0-0xef */
             -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, /* 0xf0-0xff */
         },
+        .enc_pairs = { REP4096(ENC_PAIR, 0, '-', '_') },
+        .dec_shift = {
+            { REP256(DEC_ENTRY, 0, 18, '-', '_') },
+            { REP256(DEC_ENTRY, 0, 12, '-', '_') },
+            { REP256(DEC_ENTRY, 0,  6, '-', '_') },
+            { REP256(DEC_ENTRY, 0,  0, '-', '_') },
+        },
     },
 };
 // clang-format on
 
+/*----------------------------------------------------------------------------*/
+/*                            Function Prototypes                             */
+/*----------------------------------------------------------------------------*/
+
+extern size_t b64_encode_simd(const char *enc_map, const uint8_t *in,
+                              size_t len, uint8_t *out);
+extern size_t b64_decode_simd(const char *enc_map, const uint8_t *in,
+                              size_t len, uint8_t *out);
+extern size_t b64_validate_simd(const char *enc_map, const uint8_t *in,
+                                size_t len);
+
 /*----------------------------------------------------------------------------*/
 /*                             Internal functions                             */
 /*----------------------------------------------------------------------------*/
-static size_t get_enc_size(int type, size_t decoded_size)
+/* Returns the type from the options, or -1 if it is not valid. */
+static int get_type(int opts)
 {
-    size_t remainder = 0;
-
-    if (B64_STD == type) {
-        return ((decoded_size + 2) / 3) * 4;
+    switch (0x0f & opts) {
+        case B64_STD:
+            return B64_STD;
+        case B64_URL:
+            return B64_URL;
+        default:
+            break;
     }
 
-    /* URL otherwise */
+    return -1;
+}
 
-    remainder = decoded_size % 3;
 
-    if (remainder) {
-        remainder++;
-    }
+/* Encodes 3 bytes into 4 characters. */
+static inline void encode_group(const struct b64_cfg *cfg, const uint8_t *in,
+                                uint8_t *out)
+{
+    uint32_t v = ((uint32_t) in[0] << 16) | ((uint32_t) in[1] << 8) | in[2];
+
+    memcpy(&out[0], cfg->enc_pairs[v >> 12], 2);
+    memcpy(&out[2], cfg->enc_pairs[0x0fff & v], 2);
+}
+
 
-    return (decoded_size / 3) * 4 + remainder;
+/* Returns the 24 bits of 4 characters, with bits above 23 set if any of them
+ * are invalid. */
+static inline uint32_t decode_group(const struct b64_cfg *cfg, const uint8_t *in)
+{
+    return cfg->dec_shift[0][in[0]] | cfg->dec_shift[1][in[1]]
+           | cfg->dec_shift[2][in[2]] | cfg->dec_shift[3][in[3]];
+}
+
+
+static inline void put_group(uint32_t v, uint8_t *out)
+{
+    out[0] = (uint8_t) (v >> 16);
+    out[1] = (uint8_t) (v >> 8);
+    out[2] = (uint8_t) v;
+}
+
+
+static size_t get_enc_size(int type, size_t decoded_size)
+{
+    return B64_ENCODED_LEN(type, decoded_size);
 }
 
 
@@ -144,19 +280,45 @@ static int encode(const struct b64_cfg *cfg, const uint8_t *in, size_t len,
 {
     uint32_t bits      = 0;
     int bit_count      = 0;
+    size_t i           = 0;
     size_t j           = 0;
     const uint8_t *map = (const uint8_t *) cfg->enc_map;
 
-    for (size_t i = 0; i < len; i++) {
+    /* Only the length is wanted. */
+    if (!out) {
+        j = (len / 3) * 4;
+        if (len % 3) {
+            j += ('\0' != map[64]) ? 4 : (len % 3) + 1;
+        }
+        *out_len = j;
+        return 0;
+    }
+
+    /* Do as much as possible with SIMD, then whole groups of 3 bytes using
+     * the pair table, then whatever is left. */
+    i = b64_encode_simd(cfg->enc_map, in, len, out);
+    j = (i / 3) * 4;
+
+    for (; 12 <= (len - i); i += 12) {
+        encode_group(cfg, &in[i], &out[j]);
+        encode_group(cfg, &in[i + 3], &out[j + 4]);
+        encode_group(cfg, &in[i + 6], &out[j + 8]);
+        encode_group(cfg, &in[i + 9], &out[j + 12]);
+        j += 16;
+    }
+
+    for (; 3 <= (len - i); i += 3) {
+        encode_group(cfg, &in[i], &out[j]);
+        j += 4;
+    }
+
+    for (; i < len; i++) {
         bits = (bits << 8) | in[i];
         bit_count += 8;
 
         while (6 <= bit_count) {
             bit_count -= 6;
-            if (out) {
-                out[j] = map[0x3f & (bits >> bit_count)];
-            }
-            j++;
+            out[j++] = map[0x3f & (bits >> bit_count)];
         }
     }
 
@@ -165,18 +327,12 @@ static int encode(const struct b64_cfg *cfg, const uint8_t *in, size_t len,
         bits <<= 8;
         bit_count += 8;
         bit_count -= 6;
-        if (out) {
-            out[j] = map[0x3f & (bits >> bit_count)];
-        }
-        j++;
+        out[j++] = map[0x3f & (bits >> bit_count)];
     }
 
     /* Pad */
     while (('\0' != map[64]) && (0x03 & j)) {
-        if (out) {
-            out[j] = map[64];
-        }
-        j++;
+        out[j++] = map[64];
     }
 
     *out_len = j;
@@ -192,6 +348,7 @@ static int decode(const struct b64_cfg *cfg, const uint8_t *in, size_t len,
     uint32_t bits  = 0;
     int bit_count  = 0;
     size_t padding = 0;
+    size_t i       = 0;
     size_t j       = 0;
 
     if ('=' == in[len - 1]) {
@@ -210,7 +367,51 @@ static int decode(const struct b64_cfg *cfg, const uint8_t *in, size_t len,
 
     len -= padding;
 
-    for (size_t i = 0; i < len; i++) {
+    /* Only the length is wanted, so just check the characters. */
+    if (!out) {
+        for (i = b64_validate_simd(cfg->enc_map, in, len); i < len; i++) {
+            if (cfg->dec_map[in[i]] < 0) {
+                *out_len = 0;
+                return -1;
+            }
+        }
+
+        *out_len = (len / 4) * 3 + ((len % 4) * 3) / 4;
+        return 0;
+    }
+
+    /* The SIMD code and the table loops stop before any invalid characters,
+     * so the last loop finds them and reports the error. */
+    i = b64_decode_simd(cfg->enc_map, in, len, out);
+    j = (i / 4) * 3;
+
+    for (; 16 <= (len - i); i += 16) {
+        uint32_t a = decode_group(cfg, &in[i]);
+        uint32_t b = decode_group(cfg, &in[i + 4]);
+        uint32_t c = decode_group(cfg, &in[i + 8]);
+        uint32_t d = decode_group(cfg, &in[i + 12]);
+
+        if (0xff000000 & (a | b | c | d)) {
+            break;
+        }
+        put_group(a, &out[j]);
+        put_group(b, &out[j + 3]);
+        put_group(c, &out[j + 6]);
+        put_group(d, &out[j + 9]);
+        j += 12;
+    }
+
+    for (; 4 <= (len - i); i += 4) {
+        uint32_t v = decode_group(cfg, &in[i]);
+
+        if (0xff000000 & v) {
+            break;
+        }
+        put_group(v, &out[j]);
+        j += 3;
+    }
+
+    for (; i < len; i++) {
         int8_t val;
 
         val = cfg->dec_map[in[i]];
@@ -221,6 +422,80 @@ static int decode(const struct b64_cfg *cfg, const uint8_t *in, size_t len,
         bits = (bits << 6) | val;
         bit_count += 6;
 
+        if (8 <= bit_count) {
+            out[j++] = (uint8_t) (0x0ff & (bits >> (bit_count - 8)));
+            bit_count -= 8;
+        }
+    }
+
+    *out_len = j;
+    return 0;
+}
+
+
+static int is_ws(uint8_t c)
+{
+    return (' ' == c) || ('\t' == c) || ('\r' == c) || ('\n' == c);
+}
+
+
+/* Skips the line breaks and the like while otherwise following the same
+ * rules as decode(). */
+static int decode_ws(const struct b64_cfg *cfg, const uint8_t *in, size_t len,
+                     uint8_t *out, size_t *out_len)
+{
+    uint32_t bits   = 0;
+    int bit_count   = 0;
+    size_t count    = 0;
+    size_t padding  = 0;
+    size_t simd_end = 0;
+    size_t i        = 0;
+    size_t j        = 0;
+
+    while (i < len) {
+        int8_t val;
+
+        if (is_ws(in[i])) {
+            i++;
+            continue;
+        }
+
+        /* At the start of a group, hand the rest of the line to the SIMD
+         * code.  It stops before any invalid character, including '='. */
+        if (out && (0 == bit_count) && !padding && (simd_end <= i)) {
+            size_t n = 0;
+
+            simd_end = i;
+            while ((simd_end < len) && !is_ws(in[simd_end])) {
+                simd_end++;
+            }
+
+            n = b64_decode_simd(cfg->enc_map, &in[i], simd_end - i, &out[j]);
+            i += n;
+            j += (n / 4) * 3;
+            count += n;
+            if (n) {
+                continue;
+            }
+        }
+
+        if ('=' == in[i]) {
+            padding++;
+            i++;
+            continue;
+        }
+
+        /* Nothing but padding and whitespace may follow the padding. */
+        val = cfg->dec_map[in[i]];
+        if ((val < 0) || padding) {
+            *out_len = 0;
+            return -1;
+        }
+        bits = (bits << 6) | val;
+        bit_count += 6;
+        count++;
+        i++;
+
         if (8 <= bit_count) {
             if (out) {
                 out[j] = (uint8_t) (0x0ff & (bits >> (bit_count - 8)));
@@ -230,14 +505,201 @@ static int decode(const struct b64_cfg *cfg, const uint8_t *in, size_t len,
         }
     }
 
+    /* If there is padding then it should only pad to ensure the string
+     * has a multiple of 4.  Anything else is an error. */
+    if (padding && ((2 < padding) || (0 != (0x03 & (count + padding))))) {
+        *out_len = 0;
+        return -1;
+    }
+
     *out_len = j;
     return 0;
 }
 
 
-int process(int opts,
-            size_t (*get_size)(int, size_t),
-            int (*transform)(const struct b64_cfg *, const uint8_t *, size_t, uint8_t *, size_t *out_len),
+static void *worker(void *arg)
+{
+    struct b64_worker *w = (struct b64_worker *) arg;
+
+    if (ENCODE == w->dir) {
+        w->rv = encode(w->cfg, w->in, w->len, w->out, &w->out_len);
+        return NULL;
+    }
+
+    /* Only the last piece may end with padding. */
+    if (!w->last && ('=' == w->in[w->len - 1])) {
+        w->rv = -1;
+        return NULL;
+    }
+
+    w->rv = decode(w->cfg, w->in, w->len, w->out, &w->out_len);
+
+    return NULL;
+}
+
+
+/*
+ * Splits the input into pieces of whole groups (3 bytes to encode, 4
+ * characters to decode) and encodes or decodes each piece with its own
+ * thread.  Each piece writes to its own part of the output, and only the
+ * last piece can have the partial group or padding, so the result is the
+ * same as doing everything at once.
+ */
+static int parallel(const struct b64_cfg *cfg, int dir, int threads,
+                    const uint8_t *in, size_t len, uint8_t *out, size_t *out_len)
+{
+    struct b64_worker workers[B64_MAX_THREADS];
+    pthread_t tids[B64_MAX_THREADS];
+    int started[B64_MAX_THREADS];
+    size_t in_group  = (ENCODE == dir) ? 3 : 4;
+    size_t out_group = (ENCODE == dir) ? 4 : 3;
+    size_t per       = 0;
+    size_t j         = 0;
+    int rv           = 0;
+
+    if (B64_MAX_THREADS < threads) {
+        threads = B64_MAX_THREADS;
+    }
+    if (len / B64_MIN_THREAD_BYTES < (size_t) threads) {
+        threads = (int) (len / B64_MIN_THREAD_BYTES);
+    }
+    if (threads < 2) {
+        threads = 1;
+    }
+
+    per = ((len / (size_t) threads) / in_group) * in_group;
+
+    for (int t = 0; t < threads; t++) {
+        struct b64_worker *w = &workers[t];
+        size_t start         = (size_t) t * per;
+
+        w->cfg     = cfg;
+        w->dir     = dir;
+        w->in      = &in[start];
+        w->len     = (t == threads - 1) ? (len - start) : per;
+        w->out     = &out[(start / in_group) * out_group];
+        w->out_len = 0;
+        w->last    = (t == threads - 1);
+        w->rv      = 0;
+    }
+
+    for (int t = 1; t < threads; t++) {
+        started[t] = (0 == pthread_create(&tids[t], NULL, worker, &workers[t]));
+        if (!started[t]) {
+            worker(&workers[t]);
+        }
+    }
+    worker(&workers[0]);
+
+    for (int t = 1; t < threads; t++) {
+        if (started[t]) {
+            pthread_join(tids[t], NULL);
+        }
+    }
+
+    for (int t = 0; !rv && (t < threads); t++) {
+        rv = workers[t].rv;
+        j += workers[t].out_len;
+    }
+
+    *out_len = rv ? 0 : j;
+
+    return rv;
+}
+
+
+/* Returns the number of characters between line breaks, or 0. */
+static size_t get_wrap(int opts)
+{
+    return (size_t) (((unsigned) opts) >> 8);
+}
+
+
+static size_t get_enc_size_opts(int opts, const uint8_t *in, size_t len)
+{
+    (void) in;
+
+    return B64_ENCODED_LEN(opts, len);
+}
+
+
+static size_t get_dec_size_opts(int opts, const uint8_t *in, size_t len)
+{
+    if (B64_SKIP_WS & opts) {
+        size_t count = 0;
+
+        for (size_t i = 0; i < len; i++) {
+            if (!is_ws(in[i])) {
+                count++;
+            }
+        }
+        len = count;
+    }
+
+    return get_dec_size(get_type(opts), len);
+}
+
+
+static int encode_opts(const struct b64_cfg *cfg, int opts, int threads,
+                       const uint8_t *in, size_t len, uint8_t *out,
+                       size_t *out_len)
+{
+    size_t wrap  = get_wrap(opts);
+    size_t brk   = (B64_CRLF & opts) ? 2 : 1;
+    size_t lines = 0;
+    size_t j     = 0;
+
+    if (out && (1 < threads)) {
+        parallel(cfg, ENCODE, threads, in, len, out, &j);
+    } else {
+        encode(cfg, in, len, out, &j);
+    }
+
+    if (!wrap || !j) {
+        *out_len = j;
+        return 0;
+    }
+
+    lines = (j - 1) / wrap;
+
+    /* Spread the lines out from the back, so nothing is overwritten before
+     * it is moved. */
+    if (out) {
+        for (size_t k = lines; 0 < k; k--) {
+            size_t src = k * wrap;
+            size_t dst = src + k * brk;
+            size_t n   = ((j - src) < wrap) ? (j - src) : wrap;
+
+            memmove(&out[dst], &out[src], n);
+            memcpy(&out[dst - brk], &"\r\n"[2 - brk], brk);
+        }
+    }
+
+    *out_len = j + lines * brk;
+
+    return 0;
+}
+
+
+static int decode_opts(const struct b64_cfg *cfg, int opts, int threads,
+                       const uint8_t *in, size_t len, uint8_t *out,
+                       size_t *out_len)
+{
+    if (B64_SKIP_WS & opts) {
+        return decode_ws(cfg, in, len, out, out_len);
+    }
+
+    if (out && (1 < threads)) {
+        return parallel(cfg, DECODE, threads, in, len, out, out_len);
+    }
+
+    return decode(cfg, in, len, out, out_len);
+}
+
+
+int process(int opts, int threads,
+            size_t (*get_size)(int, const uint8_t *, size_t),
+            int (*transform)(const struct b64_cfg *, int, int, const uint8_t *, size_t, uint8_t *, size_t *out_len),
             const uint8_t *in, size_t in_len, uint8_t **_out, size_t *out_len)
 {
 
@@ -252,16 +714,10 @@ int process(int opts,
     }
 
     /* Validate types */
-    switch (0x0f & opts) {
-        case B64_STD:
-            type = B64_STD;
-            break;
-        case B64_URL:
-            type = B64_URL;
-            break;
-        default:
-            *out_len = 0;
-            return -5;
+    type = get_type(opts);
+    if (type < 0) {
+        *out_len = 0;
+        return -5;
     }
 
     /* If a NULL buffer or zero length is passed in, return successfully with
@@ -275,7 +731,7 @@ int process(int opts,
     }
 
     /* Figure out the actual size */
-    dec_size = (*get_size)(type, in_len);
+    dec_size = (*get_size)(opts, in, in_len);
     if (!dec_size) {
         *out_len = 0;
         return -2;
@@ -290,21 +746,24 @@ int process(int opts,
             }
             out = *_out;
         } else {
+            /* Every byte up to out_len is written, so there is no need to
+             * zero it.  The extra byte is for the '\0'. */
             alloced_buf = 1;
-            out         = calloc(dec_size, sizeof(uint8_t));
+            out         = CU_MALLOC_(CU_ALLOC_API_B64, dec_size + 1);
             if (!out) {
                 return -4;
             }
         }
     }
 
-    rv = (*transform)(&b64_data[type], in, in_len, out, out_len);
+    rv = (*transform)(&b64_data[type], opts, threads, in, in_len, out, out_len);
 
     if (alloced_buf) {
         if (0 != rv) {
-            free(out);
+            CU_FREE_(CU_ALLOC_API_B64, out);
         } else if (_out) {
-            *_out = out;
+            out[*out_len] = '\0';
+            *_out         = out;
         }
     }
 
@@ -320,14 +779,500 @@ int process(int opts,
 int b64_decode(int opts, const void *in, size_t in_len,
                void **out, size_t *out_len)
 {
-    return process(opts, get_dec_size, decode, (const uint8_t *) in, in_len,
+    return process(opts, 1, get_dec_size_opts, decode_opts, (const uint8_t *) in, in_len,
                    (uint8_t **) out, out_len);
 }
 
 
+int b64_validate(int opts, const void *in, size_t in_len)
+{
+    size_t len = 0;
+
+    return b64_decode(opts, in, in_len, NULL, &len);
+}
+
+
+int b64_decode_parallel(int opts, const void *in, size_t in_len,
+                        void **out, size_t *out_len, int threads)
+{
+    return process(opts, threads, get_dec_size_opts, decode_opts,
+                   (const uint8_t *) in, in_len, (uint8_t **) out, out_len);
+}
+
+
+int b64_decode_inplace(int opts, void *buf, size_t len, size_t *out_len)
+{
+    void *out = buf;
+
+    if (NULL == out_len) {
+        return -5;
+    }
+
+    /* decode() and the SIMD kernels only write to bytes they have already
+     * read, so the input can be its own output. */
+    *out_len = len;
+    return b64_decode(opts | B64_PROVIDED, buf, len, &out, out_len);
+}
+
+
 int b64_encode(int opts, const void *in, size_t in_len,
                char **out, size_t *out_len)
 {
-    return process(opts, get_enc_size, encode, (const uint8_t *) in, in_len,
+    return process(opts, 1, get_enc_size_opts, encode_opts, (const uint8_t *) in, in_len,
                    (uint8_t **) out, out_len);
 }
+
+
+int b64_encode_parallel(int opts, const void *in, size_t in_len,
+                        char **out, size_t *out_len, int threads)
+{
+    return process(opts, threads, get_enc_size_opts, encode_opts,
+                   (const uint8_t *) in, in_len, (uint8_t **) out, out_len);
+}
+
+
+int b64_encoder_init(b64_encoder_t *e, int opts)
+{
+    if (!e || (get_type(opts) < 0) || (opts & ~0x0f)) {
+        return -5;
+    }
+
+    memset(e, 0, sizeof(b64_encoder_t));
+    e->type = get_type(opts);
+
+    return 0;
+}
+
+
+int b64_encoder_update(b64_encoder_t *e, const void *in, size_t in_len,
+                       char *out, size_t *out_len)
+{
+    const struct b64_cfg *cfg = NULL;
+    const uint8_t *p          = (const uint8_t *) in;
+    size_t j                  = 0;
+    size_t len                = 0;
+    size_t n                  = 0;
+
+    if (!e || !out_len || (!in && in_len) || !out) {
+        return -5;
+    }
+
+    if (*out_len < ((e->carry_len + in_len) / 3) * 4) {
+        *out_len = 0;
+        return -3;
+    }
+
+    cfg = &b64_data[e->type];
+
+    /* Finish the group left over from the last call. */
+    if (e->carry_len && (3 <= (e->carry_len + in_len))) {
+        n = 3 - e->carry_len;
+        memcpy(&e->carry[e->carry_len], p, n);
+        encode(cfg, e->carry, 3, (uint8_t *) out, &j);
+        e->carry_len = 0;
+        p += n;
+        in_len -= n;
+    }
+
+    /* Encode the whole groups straight from the input. */
+    n = (in_len / 3) * 3;
+    if (n) {
+        encode(cfg, p, n, (uint8_t *) &out[j], &len);
+        j += len;
+    }
+
+    if (in_len - n) {
+        memcpy(&e->carry[e->carry_len], &p[n], in_len - n);
+        e->carry_len += in_len - n;
+    }
+
+    *out_len = j;
+
+    return 0;
+}
+
+
+int b64_encoder_final(b64_encoder_t *e, char *out, size_t *out_len)
+{
+    size_t j = 0;
+
+    if (!e || !out_len || !out) {
+        return -5;
+    }
+
+    if (e->carry_len) {
+        if (*out_len < get_enc_size(e->type, e->carry_len)) {
+            *out_len = 0;
+            return -3;
+        }
+        encode(&b64_data[e->type], e->carry, e->carry_len, (uint8_t *) out, &j);
+    }
+
+    e->carry_len = 0;
+    *out_len     = j;
+
+    return 0;
+}
+
+
+int b64_decoder_init(b64_decoder_t *d, int opts)
+{
+    if (!d || (get_type(opts) < 0) || (opts & ~0x0f)) {
+        return -5;
+    }
+
+    memset(d, 0, sizeof(b64_decoder_t));
+    d->type = get_type(opts);
+
+    return 0;
+}
+
+
+int b64_decoder_update(b64_decoder_t *d, const void *in, size_t in_len,
+                       void *_out, size_t *out_len)
+{
+    const struct b64_cfg *cfg = NULL;
+    const uint8_t *p          = (const uint8_t *) in;
+    uint8_t *out              = (uint8_t *) _out;
+    size_t j                  = 0;
+    size_t len                = 0;
+    size_t n                  = 0;
+
+    if (!d || !out_len || (!in && in_len) || !out) {
+        return -5;
+    }
+
+    if (*out_len < ((d->carry_len + in_len) / 4) * 3) {
+        *out_len = 0;
+        return -3;
+    }
+
+    *out_len = 0;
+
+    /* Nothing may follow the padding. */
+    if (d->done && in_len) {
+        return -1;
+    }
+
+    cfg = &b64_data[d->type];
+
+    /* Finish the group left over from the last call. */
+    if (d->carry_len && (4 <= (d->carry_len + in_len))) {
+        n = 4 - d->carry_len;
+        memcpy(&d->carry[d->carry_len], p, n);
+        if (0 != decode(cfg, d->carry, 4, out, &j)) {
+            return -1;
+        }
+        d->done      = ('=' == d->carry[3]);
+        d->carry_len = 0;
+        p += n;
+        in_len -= n;
+
+        if (d->done && in_len) {
+            return -1;
+        }
+    }
+
+    /* Decode the whole groups straight from the input.  decode() rejects
+     * padding anywhere but the end. */
+    n = (in_len / 4) * 4;
+    if (n) {
+        if (0 != decode(cfg, p, n, &out[j], &len)) {
+            return -1;
+        }
+        j += len;
+        d->done = ('=' == p[n - 1]);
+
+        if (d->done && (in_len - n)) {
+            return -1;
+        }
+    }
+
+    if (in_len - n) {
+        memcpy(&d->carry[d->carry_len], &p[n], in_len - n);
+        d->carry_len += in_len - n;
+    }
+
+    *out_len = j;
+
+    return 0;
+}
+
+
+int b64_decoder_final(b64_decoder_t *d, void *out, size_t *out_len)
+{
+    size_t dec_size = 0;
+    size_t j        = 0;
+    int rv          = 0;
+
+    if (!d || !out_len || !out) {
+        return -5;
+    }
+
+    if (d->carry_len) {
+        /* Only the URL form can end with a partial group. */
+        dec_size = get_dec_size(d->type, d->carry_len);
+        if (!dec_size) {
+            rv = -2;
+        } else if (*out_len < dec_size) {
+            *out_len = 0;
+            return -3;
+        } else {
+            rv = decode(&b64_data[d->type], d->carry, d->carry_len,
+                        (uint8_t *) out, &j);
+        }
+    }
+
+    d->carry_len = 0;
+    d->done      = 0;
+    *out_len     = j;
+
+    return rv;
+}
+
+
+/* Sets up the output buffer for the vector functions.  Returns 0 if out_buf
+ * is ready, 1 if there is nothing to do, or an error. */
+static int iov_prep(int opts, const struct iovec *iov, int iovcnt, int encode,
+                    uint8_t **_out, size_t *out_len, uint8_t **out_buf,
+                    size_t *size)
+{
+    size_t total = 0;
+    int type     = get_type(opts);
+
+    if (!_out || !out_len || (iovcnt < 0) || (!iov && iovcnt) || (type < 0)
+        || (opts & ~(0x0f | B64_PROVIDED)))
+    {
+        return -5;
+    }
+
+    for (int i = 0; i < iovcnt; i++) {
+        total += iov[i].iov_len;
+    }
+
+    if (0 == total) {
+        if (B64_PROVIDED != (B64_PROVIDED & opts)) {
+            *_out = NULL;
+        }
+        *out_len = 0;
+        return 1;
+    }
+
+    *size = encode ? get_enc_size(type, total) : get_dec_size(type, total);
+    if (0 == *size) {
+        *out_len = 0;
+        return -2;
+    }
+
+    if (B64_PROVIDED == (B64_PROVIDED & opts)) {
+        if (*out_len < *size) {
+            *out_len = 0;
+            return -3;
+        }
+        *out_buf = *_out;
+        return 0;
+    }
+
+    *out_buf = CU_MALLOC_(CU_ALLOC_API_B64, *size + 1);
+    if (!*out_buf) {
+        return -4;
+    }
+
+    return 0;
+}
+
+
+/* Finishes the output from the vector functions. */
+static int iov_done(int opts, int rv, uint8_t **_out, size_t *out_len,
+                    uint8_t *out_buf, size_t j)
+{
+    if (B64_PROVIDED == (B64_PROVIDED & opts)) {
+        *out_len = rv ? 0 : j;
+        return rv;
+    }
+
+    if (rv) {
+        CU_FREE_(CU_ALLOC_API_B64, out_buf);
+        *out_len = 0;
+        return rv;
+    }
+
+    out_buf[j] = '\0';
+    *_out      = out_buf;
+    *out_len   = j;
+
+    return 0;
+}
+
+
+int b64_encodev(int opts, const struct iovec *iov, int iovcnt,
+                char **_out, size_t *out_len)
+{
+    b64_encoder_t e;
+    uint8_t *out = NULL;
+    size_t size  = 0;
+    size_t j     = 0;
+    size_t n     = 0;
+    int rv       = 0;
+
+    rv = iov_prep(opts, iov, iovcnt, 1, (uint8_t **) _out, out_len, &out, &size);
+    if (rv) {
+        return (rv < 0) ? rv : 0;
+    }
+
+    b64_encoder_init(&e, 0x0f & opts);
+    for (int i = 0; (0 == rv) && (i < iovcnt); i++) {
+        n  = size - j;
+        rv = b64_encoder_update(&e, iov[i].iov_base, iov[i].iov_len, (char *) &out[j], &n);
+        j += n;
+    }
+    if (0 == rv) {
+        n  = size - j;
+        rv = b64_encoder_final(&e, (char *) &out[j], &n);
+        j += n;
+    }
+
+    return iov_done(opts, rv, (uint8_t **) _out, out_len, out, j);
+}
+
+
+int b64_decodev(int opts, const struct iovec *iov, int iovcnt,
+                void **_out, size_t *out_len)
+{
+    b64_decoder_t d;
+    uint8_t *out = NULL;
+    size_t size  = 0;
+    size_t j     = 0;
+    size_t n     = 0;
+    int rv       = 0;
+
+    rv = iov_prep(opts, iov, iovcnt, 0, (uint8_t **) _out, out_len, &out, &size);
+    if (rv) {
+        return (rv < 0) ? rv : 0;
+    }
+
+    b64_decoder_init(&d, 0x0f & opts);
+    for (int i = 0; (0 == rv) && (i < iovcnt); i++) {
+        n  = size - j;
+        rv = b64_decoder_update(&d, iov[i].iov_base, iov[i].iov_len, &out[j], &n);
+        j += n;
+    }
+    if (0 == rv) {
+        n  = size - j;
+        rv = b64_decoder_final(&d, &out[j], &n);
+        j += n;
+    }
+
+    return iov_done(opts, rv, (uint8_t **) _out, out_len, out, j);
+}
+
+
+int b64_encode_to_sink(int opts, const void *in, size_t in_len,
+                       b64_sink_fn sink, void *ctx)
+{
+    const uint8_t *p = (const uint8_t *) in;
+    char buf[B64_SINK_BLOCK];
+    b64_encoder_t e;
+    size_t n = 0;
+    size_t j = 0;
+
+    if (!sink || (0 != b64_encoder_init(&e, opts)) || (!in && in_len)) {
+        return -5;
+    }
+
+    while (in_len) {
+        n = (in_len < B64_SINK_ENC_IN) ? in_len : B64_SINK_ENC_IN;
+        j = sizeof(buf);
+        b64_encoder_update(&e, p, n, buf, &j);
+        p += n;
+        in_len -= n;
+
+        /* The end of the stream always fits after the last block. */
+        if (!in_len) {
+            n = sizeof(buf) - j;
+            b64_encoder_final(&e, &buf[j], &n);
+            j += n;
+        }
+
+        if (j && (0 != (*sink)(ctx, buf, j))) {
+            return -6;
+        }
+    }
+
+    return 0;
+}
+
+
+int b64_decode_to_sink(int opts, const void *in, size_t in_len,
+                       b64_sink_fn sink, void *ctx)
+{
+    const uint8_t *p = (const uint8_t *) in;
+    uint8_t buf[B64_SINK_BLOCK];
+    b64_decoder_t d;
+    size_t n = 0;
+    size_t j = 0;
+    int rv   = 0;
+
+    if (!sink || (0 != b64_decoder_init(&d, opts)) || (!in && in_len)) {
+        return -5;
+    }
+
+    while (in_len) {
+        n  = (in_len < B64_SINK_DEC_IN) ? in_len : B64_SINK_DEC_IN;
+        j  = sizeof(buf);
+        rv = b64_decoder_update(&d, p, n, buf, &j);
+        p += n;
+        in_len -= n;
+
+        if ((0 == rv) && !in_len) {
+            n  = sizeof(buf) - j;
+            rv = b64_decoder_final(&d, &buf[j], &n);
+            j += n;
+        }
+
+        if (rv) {
+            return rv;
+        }
+
+        if (j && (0 != (*sink)(ctx, buf, j))) {
+            return -6;
+        }
+    }
+
+    return 0;
+}
+
+
+/* A sink that writes to the file descriptor ctx points to. */
+static int fd_sink(void *ctx, const void *buf, size_t len)
+{
+    const char *p = (const char *) buf;
+    int fd        = *(int *) ctx;
+
+    while (len) {
+        ssize_t n = write(fd, p, len);
+
+        if (n < 0) {
+            if (EINTR == errno) {
+                continue;
+            }
+            return -1;
+        }
+        p += n;
+        len -= (size_t) n;
+    }
+
+    return 0;
+}
+
+
+int b64_encode_to_fd(int opts, const void *in, size_t in_len, int fd)
+{
+    return b64_encode_to_sink(opts, in, in_len, fd_sink, &fd);
+}
+
+
+int b64_decode_to_fd(int opts, const void *in, size_t in_len, int fd)
+{
+    return b64_decode_to_sink(opts, in, in_len, fd_sink, &fd);
+}
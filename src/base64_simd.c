@@ -0,0 +1,472 @@
+/* SPDX-FileCopyrightText: 2026 Comcast Cable Communications Management, LLC */
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*----------------------------------------------------------------------------*/
+/*                                   Macros                                   */
+/*----------------------------------------------------------------------------*/
+
+/* The kernels need x86 and the GCC/clang target attribute, everything else
+ * uses the scalar code in base64.c. */
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define B64_X86 1
+#include <immintrin.h>
+#endif
+
+/* The same levels cu_simd_level() returns. */
+#define B64_SIMD_NONE  0
+#define B64_SIMD_SSSE3 1
+#define B64_SIMD_AVX2  2
+
+/* The highest kernel to use, even if the CPU supports more.  Overridable so
+ * every kernel can be tested on a CPU that supports them all. */
+#ifndef B64_SIMD_MAX_LEVEL
+#define B64_SIMD_MAX_LEVEL B64_SIMD_AVX2
+#endif
+
+/*----------------------------------------------------------------------------*/
+/*                            Function Prototypes                             */
+/*----------------------------------------------------------------------------*/
+
+extern int cu_simd_level(void);
+
+extern size_t b64_encode_simd(const char *enc_map, const uint8_t *in,
+                              size_t len, uint8_t *out);
+extern size_t b64_decode_simd(const char *enc_map, const uint8_t *in,
+                              size_t len, uint8_t *out);
+extern size_t b64_validate_simd(const char *enc_map, const uint8_t *in,
+                                size_t len);
+
+/*----------------------------------------------------------------------------*/
+/*                             Internal functions                             */
+/*----------------------------------------------------------------------------*/
+#ifdef B64_X86
+
+/* The CPU's level from cu_simd_level(), capped at B64_SIMD_MAX_LEVEL. */
+static int simd_level(void)
+{
+    int l = cu_simd_level();
+
+    if (B64_SIMD_MAX_LEVEL < l) {
+        l = B64_SIMD_MAX_LEVEL;
+    }
+
+    return l;
+}
+
+
+/*
+ * The encoders follow Muła and Lemire, "Faster Base64 Encoding and Decoding
+ * using AVX2 Instructions".  Each group of 3 bytes is spread into 4 bytes of
+ * 6 bits each, then each 6 bit value is turned into its character by adding
+ * an offset that only depends on which range (A-Z, a-z, 0-9, 62, 63) it is
+ * in.  The offsets for 62 and 63 come from the alphabet, so the same kernels
+ * do both the standard and URL forms.
+ */
+
+/* Returns the offset table for the alphabet. */
+__attribute__((target("ssse3")))
+static __m128i enc_offsets(const char *enc_map)
+{
+    return _mm_setr_epi8((char) ('a' - 26), (char) ('0' - 52), (char) ('0' - 52),
+                         (char) ('0' - 52), (char) ('0' - 52), (char) ('0' - 52),
+                         (char) ('0' - 52), (char) ('0' - 52), (char) ('0' - 52),
+                         (char) ('0' - 52), (char) ('0' - 52),
+                         (char) (enc_map[62] - 62), (char) (enc_map[63] - 63),
+                         'A', 0, 0);
+}
+
+
+/*
+ * Encodes 12 bytes at a time into 16 characters.  Each step loads 16 bytes,
+ * so this stops while at least 4 bytes are left over.  Returns the number of
+ * bytes encoded, which is a multiple of 3.
+ */
+__attribute__((target("ssse3")))
+static size_t encode_ssse3(const char *enc_map, const uint8_t *in, size_t len,
+                           uint8_t *out)
+{
+    const __m128i spread  = _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7,
+                                         4, 5, 3, 4, 1, 2, 0, 1);
+    const __m128i offsets = enc_offsets(enc_map);
+    size_t i              = 0;
+    size_t j              = 0;
+
+    while (16 <= (len - i)) {
+        __m128i v = _mm_loadu_si128((const __m128i *) (in + i));
+        __m128i hi, lo, range;
+
+        /* Spread the bytes so each 32 bit lane holds 3 of them, then move
+         * the 4 groups of 6 bits into their own bytes. */
+        v  = _mm_shuffle_epi8(v, spread);
+        hi = _mm_mulhi_epu16(_mm_and_si128(v, _mm_set1_epi32(0x0fc0fc00)),
+                             _mm_set1_epi32(0x04000040));
+        lo = _mm_mullo_epi16(_mm_and_si128(v, _mm_set1_epi32(0x003f03f0)),
+                             _mm_set1_epi32(0x01000010));
+        v  = _mm_or_si128(hi, lo);
+
+        /* 0..51 -> 0, 52..61 -> 1..10, 62 -> 11, 63 -> 12, then 0..25 -> 13 */
+        range = _mm_subs_epu8(v, _mm_set1_epi8(51));
+        range = _mm_or_si128(range,
+                             _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), v),
+                                           _mm_set1_epi8(13)));
+        v     = _mm_add_epi8(v, _mm_shuffle_epi8(offsets, range));
+
+        _mm_storeu_si128((__m128i *) (out + j), v);
+        i += 12;
+        j += 16;
+    }
+
+    return i;
+}
+
+
+/*
+ * The same as encode_ssse3(), but 24 bytes at a time into 32 characters.
+ * Each step loads 28 bytes.
+ */
+__attribute__((target("avx2")))
+static size_t encode_avx2(const char *enc_map, const uint8_t *in, size_t len,
+                          uint8_t *out)
+{
+    const __m256i spread  = _mm256_broadcastsi128_si256(
+        _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+    const __m256i offsets = _mm256_broadcastsi128_si256(enc_offsets(enc_map));
+    size_t i              = 0;
+    size_t j              = 0;
+
+    while (28 <= (len - i)) {
+        __m128i a = _mm_loadu_si128((const __m128i *) (in + i));
+        __m128i b = _mm_loadu_si128((const __m128i *) (in + i + 12));
+        __m256i v = _mm256_inserti128_si256(_mm256_castsi128_si256(a), b, 1);
+        __m256i hi, lo, range;
+
+        v  = _mm256_shuffle_epi8(v, spread);
+        hi = _mm256_mulhi_epu16(_mm256_and_si256(v, _mm256_set1_epi32(0x0fc0fc00)),
+                                _mm256_set1_epi32(0x04000040));
+        lo = _mm256_mullo_epi16(_mm256_and_si256(v, _mm256_set1_epi32(0x003f03f0)),
+                                _mm256_set1_epi32(0x01000010));
+        v  = _mm256_or_si256(hi, lo);
+
+        range = _mm256_subs_epu8(v, _mm256_set1_epi8(51));
+        range = _mm256_or_si256(range,
+                                _mm256_and_si256(_mm256_cmpgt_epi8(_mm256_set1_epi8(26), v),
+                                                 _mm256_set1_epi8(13)));
+        v     = _mm256_add_epi8(v, _mm256_shuffle_epi8(offsets, range));
+
+        _mm256_storeu_si256((__m256i *) (out + j), v);
+        i += 24;
+        j += 32;
+    }
+
+    return i;
+}
+
+
+/*
+ * The decoders also follow Muła and Lemire.  Each character is checked
+ * against the ranges A-Z, a-z, 0-9 and the 2 characters for 62 and 63 from
+ * the alphabet.  The range it is in picks the value added to turn it into its
+ * 6 bit value.  A character in no range (including '=' and anything past
+ * 0x7f) is invalid, and the kernel stops before that block so the scalar code
+ * can find it and report the error.
+ *
+ * The packing writes 4 bytes past the data it produces, so the kernels stop
+ * while enough input is left that the caller's buffer holds those bytes.
+ */
+
+/*
+ * Turns the characters in c into their 6 bit values.  Returns 0 if any of
+ * them are invalid, leaving c unchanged.
+ */
+__attribute__((target("ssse3")))
+static inline int translate_ssse3(__m128i *c, __m128i c62, __m128i c63,
+                                  __m128i s62, __m128i s63)
+{
+    __m128i upper, lower, digit, is62, is63, shift;
+
+    upper = _mm_and_si128(_mm_cmpgt_epi8(*c, _mm_set1_epi8('A' - 1)),
+                          _mm_cmpgt_epi8(_mm_set1_epi8('Z' + 1), *c));
+    lower = _mm_and_si128(_mm_cmpgt_epi8(*c, _mm_set1_epi8('a' - 1)),
+                          _mm_cmpgt_epi8(_mm_set1_epi8('z' + 1), *c));
+    digit = _mm_and_si128(_mm_cmpgt_epi8(*c, _mm_set1_epi8('0' - 1)),
+                          _mm_cmpgt_epi8(_mm_set1_epi8('9' + 1), *c));
+    is62  = _mm_cmpeq_epi8(*c, c62);
+    is63  = _mm_cmpeq_epi8(*c, c63);
+
+    if (0xffff != _mm_movemask_epi8(_mm_or_si128(
+                      _mm_or_si128(upper, lower),
+                      _mm_or_si128(digit, _mm_or_si128(is62, is63)))))
+    {
+        return 0;
+    }
+
+    shift = _mm_or_si128(_mm_and_si128(upper, _mm_set1_epi8(-'A')),
+                         _mm_and_si128(lower, _mm_set1_epi8(26 - 'a')));
+    shift = _mm_or_si128(shift, _mm_and_si128(digit, _mm_set1_epi8(52 - '0')));
+    shift = _mm_or_si128(shift, _mm_and_si128(is62, s62));
+    shift = _mm_or_si128(shift, _mm_and_si128(is63, s63));
+    *c    = _mm_add_epi8(*c, shift);
+
+    return 1;
+}
+
+
+/* The same as translate_ssse3(), but 32 characters. */
+__attribute__((target("avx2")))
+static inline int translate_avx2(__m256i *c, __m256i c62, __m256i c63,
+                                 __m256i s62, __m256i s63)
+{
+    __m256i upper, lower, digit, is62, is63, shift;
+
+    upper = _mm256_and_si256(_mm256_cmpgt_epi8(*c, _mm256_set1_epi8('A' - 1)),
+                             _mm256_cmpgt_epi8(_mm256_set1_epi8('Z' + 1), *c));
+    lower = _mm256_and_si256(_mm256_cmpgt_epi8(*c, _mm256_set1_epi8('a' - 1)),
+                             _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), *c));
+    digit = _mm256_and_si256(_mm256_cmpgt_epi8(*c, _mm256_set1_epi8('0' - 1)),
+                             _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), *c));
+    is62  = _mm256_cmpeq_epi8(*c, c62);
+    is63  = _mm256_cmpeq_epi8(*c, c63);
+
+    if (-1 != _mm256_movemask_epi8(_mm256_or_si256(
+                  _mm256_or_si256(upper, lower),
+                  _mm256_or_si256(digit, _mm256_or_si256(is62, is63)))))
+    {
+        return 0;
+    }
+
+    shift = _mm256_or_si256(_mm256_and_si256(upper, _mm256_set1_epi8(-'A')),
+                            _mm256_and_si256(lower, _mm256_set1_epi8(26 - 'a')));
+    shift = _mm256_or_si256(shift,
+                            _mm256_and_si256(digit, _mm256_set1_epi8(52 - '0')));
+    shift = _mm256_or_si256(shift, _mm256_and_si256(is62, s62));
+    shift = _mm256_or_si256(shift, _mm256_and_si256(is63, s63));
+    *c    = _mm256_add_epi8(*c, shift);
+
+    return 1;
+}
+
+
+/*
+ * Decodes 16 characters at a time into 12 bytes.  Returns the number of
+ * characters decoded, which is a multiple of 4.
+ */
+__attribute__((target("ssse3")))
+static size_t decode_ssse3(const char *enc_map, const uint8_t *in, size_t len,
+                           uint8_t *out)
+{
+    const __m128i c62  = _mm_set1_epi8(enc_map[62]);
+    const __m128i c63  = _mm_set1_epi8(enc_map[63]);
+    const __m128i s62  = _mm_set1_epi8((char) (62 - enc_map[62]));
+    const __m128i s63  = _mm_set1_epi8((char) (63 - enc_map[63]));
+    const __m128i pack = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12,
+                                       -1, -1, -1, -1);
+    size_t i           = 0;
+    size_t j           = 0;
+
+    while (24 <= (len - i)) {
+        __m128i c = _mm_loadu_si128((const __m128i *) (in + i));
+
+        if (!translate_ssse3(&c, c62, c63, s62, s63)) {
+            break;
+        }
+
+        /* Merge the 6 bit values into 24 bits per 32 bit lane, then pull the
+         * 3 bytes of each lane together in big endian order. */
+        c = _mm_maddubs_epi16(c, _mm_set1_epi32(0x01400140));
+        c = _mm_madd_epi16(c, _mm_set1_epi32(0x00011000));
+        c = _mm_shuffle_epi8(c, pack);
+
+        _mm_storeu_si128((__m128i *) (out + j), c);
+        i += 16;
+        j += 12;
+    }
+
+    return i;
+}
+
+
+/*
+ * The same as decode_ssse3(), but 32 characters at a time into 24 bytes.
+ */
+__attribute__((target("avx2")))
+static size_t decode_avx2(const char *enc_map, const uint8_t *in, size_t len,
+                          uint8_t *out)
+{
+    const __m256i c62  = _mm256_set1_epi8(enc_map[62]);
+    const __m256i c63  = _mm256_set1_epi8(enc_map[63]);
+    const __m256i s62  = _mm256_set1_epi8((char) (62 - enc_map[62]));
+    const __m256i s63  = _mm256_set1_epi8((char) (63 - enc_map[63]));
+    const __m256i pack = _mm256_broadcastsi128_si256(
+        _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7);
+    size_t i            = 0;
+    size_t j            = 0;
+
+    while (44 <= (len - i)) {
+        __m256i c = _mm256_loadu_si256((const __m256i *) (in + i));
+
+        if (!translate_avx2(&c, c62, c63, s62, s63)) {
+            break;
+        }
+
+        c = _mm256_maddubs_epi16(c, _mm256_set1_epi32(0x01400140));
+        c = _mm256_madd_epi16(c, _mm256_set1_epi32(0x00011000));
+        c = _mm256_shuffle_epi8(c, pack);
+
+        /* Each 128 bit lane holds 12 bytes, move them next to each other. */
+        c = _mm256_permutevar8x32_epi32(c, lanes);
+
+        _mm256_storeu_si256((__m256i *) (out + j), c);
+        i += 32;
+        j += 24;
+    }
+
+    return i;
+}
+
+
+
+/*
+ * Checks 16 (SSSE3) or 32 (AVX2) characters at a time.  Returns the number of
+ * characters before the first block with an invalid one.
+ */
+__attribute__((target("ssse3")))
+static size_t validate_ssse3(const char *enc_map, const uint8_t *in, size_t len)
+{
+    const __m128i c62 = _mm_set1_epi8(enc_map[62]);
+    const __m128i c63 = _mm_set1_epi8(enc_map[63]);
+    const __m128i s62 = _mm_set1_epi8((char) (62 - enc_map[62]));
+    const __m128i s63 = _mm_set1_epi8((char) (63 - enc_map[63]));
+    size_t i          = 0;
+
+    while (16 <= (len - i)) {
+        __m128i c = _mm_loadu_si128((const __m128i *) (in + i));
+
+        if (!translate_ssse3(&c, c62, c63, s62, s63)) {
+            break;
+        }
+        i += 16;
+    }
+
+    return i;
+}
+
+
+__attribute__((target("avx2")))
+static size_t validate_avx2(const char *enc_map, const uint8_t *in, size_t len)
+{
+    const __m256i c62 = _mm256_set1_epi8(enc_map[62]);
+    const __m256i c63 = _mm256_set1_epi8(enc_map[63]);
+    const __m256i s62 = _mm256_set1_epi8((char) (62 - enc_map[62]));
+    const __m256i s63 = _mm256_set1_epi8((char) (63 - enc_map[63]));
+    size_t i          = 0;
+
+    while (32 <= (len - i)) {
+        __m256i c = _mm256_loadu_si256((const __m256i *) (in + i));
+
+        if (!translate_avx2(&c, c62, c63, s62, s63)) {
+            break;
+        }
+        i += 32;
+    }
+
+    return i;
+}
+
+#endif /* B64_X86 */
+
+/*----------------------------------------------------------------------------*/
+/*                             External Functions                             */
+/*----------------------------------------------------------------------------*/
+
+
+/*
+ * Encodes as much of the input as the best kernel for this CPU can, and
+ * returns how many bytes were encoded (a multiple of 3).  The caller encodes
+ * the rest.
+ */
+extern size_t b64_encode_simd(const char *enc_map, const uint8_t *in,
+                              size_t len, uint8_t *out)
+{
+    size_t i = 0;
+
+#ifdef B64_X86
+    int level = simd_level();
+
+    if (B64_SIMD_AVX2 <= level) {
+        i = encode_avx2(enc_map, in, len, out);
+    }
+    if (B64_SIMD_SSSE3 <= level) {
+        i += encode_ssse3(enc_map, in + i, len - i, out + (i / 3) * 4);
+    }
+#else
+    (void) enc_map;
+    (void) in;
+    (void) len;
+    (void) out;
+#endif
+
+    return i;
+}
+
+
+/*
+ * Decodes as much of the input as the best kernel for this CPU can, and
+ * returns how many characters were decoded (a multiple of 4).  The input must
+ * not include the padding.  The kernels stop at a block with an invalid
+ * character, so the caller decodes the rest and reports any error.
+ */
+extern size_t b64_decode_simd(const char *enc_map, const uint8_t *in,
+                              size_t len, uint8_t *out)
+{
+    size_t i = 0;
+
+#ifdef B64_X86
+    int level = simd_level();
+
+    if (B64_SIMD_AVX2 <= level) {
+        i = decode_avx2(enc_map, in, len, out);
+    }
+    if (B64_SIMD_SSSE3 <= level) {
+        i += decode_ssse3(enc_map, in + i, len - i, out + (i / 4) * 3);
+    }
+#else
+    (void) enc_map;
+    (void) in;
+    (void) len;
+    (void) out;
+#endif
+
+    return i;
+}
+
+
+/*
+ * Checks as much of the input as the best kernel for this CPU can, and
+ * returns how many characters are valid.  The caller checks the rest.
+ */
+extern size_t b64_validate_simd(const char *enc_map, const uint8_t *in,
+                                size_t len)
+{
+    size_t i = 0;
+
+#ifdef B64_X86
+    int level = simd_level();
+
+    if (B64_SIMD_AVX2 <= level) {
+        i = validate_avx2(enc_map, in, len);
+    }
+    if (B64_SIMD_SSSE3 <= level) {
+        i += validate_ssse3(enc_map, in + i, len - i);
+    }
+#else
+    (void) enc_map;
+    (void) in;
+    (void) len;
+#endif
+
+    return i;
+}
@@ -0,0 +1,269 @@
+/* SPDX-FileCopyrightText: 2026 Comcast Cable Communications Management, LLC */
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "alloc.h"
+#include "buf.h"
+#include "must.h"
+
+/*----------------------------------------------------------------------------*/
+/*                                   Macros                                   */
+/*----------------------------------------------------------------------------*/
+
+/* The smallest capacity allocated. */
+#define CU_BUF_MIN_CAP (64)
+
+/*----------------------------------------------------------------------------*/
+/*                               Data Structures                              */
+/*----------------------------------------------------------------------------*/
+/* none */
+
+/*----------------------------------------------------------------------------*/
+/*                            File Scoped Variables                           */
+/*----------------------------------------------------------------------------*/
+/* none */
+
+/*----------------------------------------------------------------------------*/
+/*                             Function Prototypes                            */
+/*----------------------------------------------------------------------------*/
+/* none */
+
+/*----------------------------------------------------------------------------*/
+/*                             Internal functions                             */
+/*----------------------------------------------------------------------------*/
+
+/* Grows the buffer so len + extra bytes and the '\0' fit. */
+static int grow(cu_buf_t *b, size_t extra)
+{
+    size_t need = 0;
+    size_t cap  = 0;
+    char *p     = NULL;
+
+    if ((SIZE_MAX - 1 - b->len) < extra) {
+        return -2;
+    }
+
+    need = b->len + extra + 1;
+    if (need <= b->cap) {
+        return 0;
+    }
+
+    cap = (b->cap < CU_BUF_MIN_CAP) ? CU_BUF_MIN_CAP : b->cap;
+    while (cap < need) {
+        cap = ((SIZE_MAX / 2) < cap) ? need : cap * 2;
+    }
+
+    p = cu_realloc(b->data, cap);
+    if (!p) {
+        return -2;
+    }
+
+    b->data = p;
+    b->cap  = cap;
+
+    return 0;
+}
+
+/*----------------------------------------------------------------------------*/
+/*                             External Functions                             */
+/*----------------------------------------------------------------------------*/
+
+int cu_buf_reserve(cu_buf_t *b, size_t extra)
+{
+    int rv = 0;
+
+    if (!b) {
+        return -1;
+    }
+
+    rv = grow(b, extra);
+    if (!rv) {
+        b->data[b->len] = '\0';
+    }
+
+    return rv;
+}
+
+
+int cu_buf_append(cu_buf_t *b, const void *src, size_t len)
+{
+    uintptr_t start = 0;
+    uintptr_t s     = (uintptr_t) src;
+    int inside      = 0;
+    int rv          = 0;
+
+    if (!b || (!src && len)) {
+        return -1;
+    }
+
+    /* src may point into the buffer, which grow() can move, so keep its
+     * offset instead. */
+    start = (uintptr_t) b->data;
+    if (b->data && (start <= s) && (s < (start + b->len))) {
+        inside = 1;
+    }
+
+    rv = grow(b, len);
+    if (rv) {
+        return rv;
+    }
+
+    if (inside) {
+        src = &b->data[s - start];
+    }
+
+    if (len) {
+        memcpy(&b->data[b->len], src, len);
+        b->len += len;
+    }
+    b->data[b->len] = '\0';
+
+    return 0;
+}
+
+
+int cu_buf_appendf(cu_buf_t *b, const char *format, ...)
+{
+    va_list args;
+    int rv = 0;
+
+    va_start(args, format);
+    rv = cu_buf_vappendf(b, format, args);
+    va_end(args);
+
+    return rv;
+}
+
+
+int cu_buf_vappendf(cu_buf_t *b, const char *format, va_list args)
+{
+    va_list copy;
+    size_t room = 0;
+    int rv      = 0;
+    int l;
+
+    if (!b || !format) {
+        return -1;
+    }
+
+    /* Try to print into the space that is already there, and only measure
+     * and grow if it doesn't fit. */
+    room = (b->cap) ? (b->cap - b->len) : 0;
+
+    va_copy(copy, args);
+    l = vsnprintf((room) ? &b->data[b->len] : NULL, room, format, copy);
+    va_end(copy);
+    if (l < 0) {
+        if (room) {
+            b->data[b->len] = '\0';
+        }
+        return -1;
+    }
+
+    if ((size_t) l < room) {
+        b->len += (size_t) l;
+        return 0;
+    }
+
+    rv = grow(b, (size_t) l);
+    if (rv) {
+        if (room) {
+            b->data[b->len] = '\0';
+        }
+        return rv;
+    }
+
+    vsnprintf(&b->data[b->len], (size_t) l + 1, format, args);
+    b->len += (size_t) l;
+
+    return 0;
+}
+
+
+char *cu_buf_detach(cu_buf_t *b, size_t *len)
+{
+    char *p = NULL;
+
+    if (len) {
+        *len = 0;
+    }
+
+    if (!b) {
+        return NULL;
+    }
+
+    p = b->data;
+    if (len) {
+        *len = b->len;
+    }
+
+    b->data = NULL;
+    b->len  = 0;
+    b->cap  = 0;
+
+    return p;
+}
+
+
+void cu_buf_reset(cu_buf_t *b)
+{
+    if (b) {
+        b->len = 0;
+        if (b->data) {
+            b->data[0] = '\0';
+        }
+    }
+}
+
+
+void cu_buf_destroy(cu_buf_t *b)
+{
+    if (b) {
+        cu_free(b->data);
+        b->data = NULL;
+        b->len  = 0;
+        b->cap  = 0;
+    }
+}
+
+
+/*-- Must versions -----------------------------------------------------------*/
+
+
+void cu_must_buf_reserve(cu_buf_t *b, size_t extra)
+{
+    if (-2 == cu_buf_reserve(b, extra)) {
+        must(NULL);
+    }
+}
+
+
+void cu_must_buf_append(cu_buf_t *b, const void *src, size_t len)
+{
+    if (-2 == cu_buf_append(b, src, len)) {
+        must(NULL);
+    }
+}
+
+
+void cu_must_buf_appendf(cu_buf_t *b, const char *format, ...)
+{
+    va_list args;
+
+    va_start(args, format);
+    cu_must_buf_vappendf(b, format, args);
+    va_end(args);
+}
+
+
+void cu_must_buf_vappendf(cu_buf_t *b, const char *format, va_list args)
+{
+    if (-2 == cu_buf_vappendf(b, format, args)) {
+        must(NULL);
+    }
+}
@@ -5,6 +5,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#include "alloc.h"
 #include "file.h"
 
 /*----------------------------------------------------------------------------*/
@@ -59,7 +60,7 @@ int freadall(const char *filename, size_t max, void **data, size_t *len)
     *len  = 0;
     *data = NULL;
     if (0 < file_len) {
-        *data = malloc(file_len);
+        *data = CU_MALLOC_(CU_ALLOC_API_FREADALL, file_len);
         if (*data) {
             char *p     = (char *) *data;
             size_t want = file_len;
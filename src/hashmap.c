@@ -34,23 +34,57 @@
 
    For more information, please refer to <http://unlicense.org/>
 */
+#define _POSIX_C_SOURCE 200809L
+#include <pthread.h>
 #include <stdint.h>
 #include <string.h>
 
+#include "alloc.h"
 #include "hashmap.h"
 
-#define HASHMAP_MAX_CHAIN_LENGTH (8)
-#define HASHMAP_MAX_SIZE         (size_t)(1 << 30) /* Up to 1G entries work */
-#define HASHMAP_DEFAULT_SIZE     (16)
+#define HASHMAP_MIN_CHAIN_LENGTH  (8)
+#define HASHMAP_DEFAULT_SIZE      (16)
+#define HASHMAP_PARTITION_MIN     (4096)
+#define HASHMAP_PARTITION_BUCKETS (65536)
+#define HASHMAP_MAX_THREADS       (64)
+
+/* Tables with more slots than this use the 64 bit hash.  The 32 bit path
+ * drops 3 bits before Knuth's multiply, so it only has 2^29 distinct results
+ * and can't reach every slot of a larger table.  Overridable so the 64 bit
+ * path can be tested. */
+#ifndef HASHMAP_HASH64_THRESHOLD
+#define HASHMAP_HASH64_THRESHOLD ((uint64_t) 1 << 29)
+#endif
+
+/* An index slot holds the element index + 1, so 0 marks an empty slot. */
+#define HASHMAP_EMPTY_SLOT (0)
+
+/*----------------------------------------------------------------------------*/
+/*                               Data Structures                              */
+/*----------------------------------------------------------------------------*/
+/* One worker's share of a parallel index fill: the elements in
+ * data[start, end), the first of which will be at pos once squeezed. */
+struct hashmap_worker {
+    const hashmap_t *m;
+    void *index;
+    size_t table_size;
+    size_t width;
+    size_t start;
+    size_t end;
+    size_t pos;
+    int *fail;
+    int rv;
+};
 
 /*----------------------------------------------------------------------------*/
 /*                            Function Prototypes                             */
 /*----------------------------------------------------------------------------*/
 
 extern uint32_t hashmap_crc32_helper(const char *const s, const size_t len);
+extern uint64_t hashmap_fnv1a64_helper(const char *const s, const size_t len);
 
 
-static size_t hashmap_hash_helper_int_helper(const hashmap_t *const m,
+static size_t hashmap_hash_helper_int_helper(const size_t table_size,
                                              const char *const keystring,
                                              const size_t len);
 static int hashmap_match_helper(const struct hashmap_element *const element,
@@ -59,9 +93,36 @@ static int hashmap_match_helper(const struct hashmap_element *const element,
 static int hashmap_hash_helper(const hashmap_t *const m,
                                const char *const key, const size_t len,
                                size_t *const out_index);
-static int hashmap_rehash_iterator(void *const new_hash,
-                                   struct hashmap_element *const e);
+static struct hashmap_element *hashmap_find_helper(const hashmap_t *const m,
+                                                   const char *const key,
+                                                   const size_t len,
+                                                   size_t *const out_slot);
+static void hashmap_remove_helper(hashmap_t *const m, const size_t slot);
+static void hashmap_sweep_helper(hashmap_t *const m);
+static struct hashmap_element *hashmap_handle_helper(const hashmap_t *const m,
+                                                     const hashmap_handle_t *const h);
 static int hashmap_rehash_helper(hashmap_t *const m);
+static int hashmap_rebuild_helper(hashmap_t *const m, const size_t table_size,
+                                  const int threads);
+static int hashmap_index_helper(hashmap_t *const m, void *const index,
+                                const size_t table_size, const size_t width,
+                                const int merge, const int threads);
+static int hashmap_index_parallel_helper(hashmap_t *const m, void *const index,
+                                         const size_t table_size,
+                                         const size_t width, int threads);
+static void *hashmap_worker_helper(void *arg);
+static int hashmap_place_helper(hashmap_t *const m, void *const index,
+                                const size_t table_size, const size_t width,
+                                size_t curr, const size_t pos, const int merge);
+static size_t hashmap_usable_size(const size_t table_size);
+static int hashmap_chain_length(const size_t table_size);
+static size_t hashmap_index_width(const size_t data_size);
+static size_t hashmap_index_get(const void *const index, const size_t width,
+                                const size_t slot);
+static void hashmap_index_set(void *const index, const size_t width,
+                              const size_t slot, const size_t value);
+static int hashmap_index_claim(void *const index, const size_t width,
+                               const size_t slot, const size_t value);
 static size_t num_to_pow2(size_t num);
 
 
@@ -83,22 +144,116 @@ int hashmap_create(size_t initial_size, hashmap_t *const out_hashmap)
     }
     initial_size = num_to_pow2(initial_size);
 
-    out_hashmap->table_size = initial_size;
-    out_hashmap->size       = 0;
+    memset(out_hashmap, 0, sizeof(hashmap_t));
 
-    out_hashmap->data = calloc(initial_size, sizeof(struct hashmap_element));
-    if (!out_hashmap->data) {
-        return -2;
+    return hashmap_rebuild_helper(out_hashmap, initial_size, 1);
+}
+
+
+int hashmap_build(const char *const *keys, const size_t *lens,
+                  void *const *values, size_t n, hashmap_t *const out_hashmap)
+{
+    size_t table_size = HASHMAP_DEFAULT_SIZE;
+    int rv            = 0;
+
+    if (!out_hashmap || (n && (!keys || !lens || !values))) {
+        return -1;
     }
 
-    return 0;
+    /* Size the table once, so it never needs to grow while loading. */
+    while (hashmap_usable_size(table_size) < n) {
+        if (HASHMAP_MAX_SIZE <= table_size) {
+            return -1;
+        }
+        table_size <<= 1;
+    }
+
+    for (;;) {
+        rv = hashmap_create(table_size, out_hashmap);
+        if (rv) {
+            return rv;
+        }
+
+        /* The elements go into the dense array in order, then get indexed. */
+        for (size_t i = 0; i < n; i++) {
+            out_hashmap->data[i].key     = keys[i];
+            out_hashmap->data[i].key_len = lens[i];
+            out_hashmap->data[i].in_use  = 1;
+            out_hashmap->data[i].data    = values[i];
+        }
+        out_hashmap->data_used = n;
+        out_hashmap->size      = n;
+
+        rv = hashmap_index_helper(out_hashmap, out_hashmap->index, table_size,
+                                  hashmap_index_width(out_hashmap->data_size),
+                                  1, 1);
+        if (0 == rv) {
+            return 0;
+        }
+        hashmap_destroy(out_hashmap);
+
+        /* Follow the same rules as hashmap_put(): only grow on a collision if
+         * the table is at least 25% full. */
+        if ((-3 != rv) || (n < (table_size / 4))
+            || (HASHMAP_MAX_SIZE <= table_size))
+        {
+            return rv;
+        }
+        table_size <<= 1;
+    }
+}
+
+
+int hashmap_rehash(hashmap_t *const m, size_t new_size, int threads)
+{
+    int rv = 0;
+
+    if (!m || (HASHMAP_MAX_SIZE < new_size)) {
+        return -1;
+    }
+
+    if (!m->data) {
+        return hashmap_create(new_size, m);
+    }
+
+    if (0 == new_size) {
+        new_size = m->table_size;
+    }
+    new_size = num_to_pow2(new_size);
+
+    /* Never shrink below what the elements in use need. */
+    while (hashmap_usable_size(new_size) < m->size) {
+        if (HASHMAP_MAX_SIZE <= new_size) {
+            return -1;
+        }
+        new_size <<= 1;
+    }
+
+    if (threads < 1) {
+        threads = 1;
+    }
+
+    for (;;) {
+        rv = hashmap_rebuild_helper(m, new_size, threads);
+
+        /* Follow the same rules as hashmap_put(): only grow on a collision if
+         * the table is at least 25% full. */
+        if ((-3 != rv) || (m->size < (new_size / 4))
+            || (HASHMAP_MAX_SIZE <= new_size))
+        {
+            return rv;
+        }
+        new_size <<= 1;
+    }
 }
 
 
 int hashmap_put(hashmap_t *const m, const char *const key,
                 size_t len, void *const value)
 {
+    size_t slot  = 0;
     size_t index = 0;
+    size_t width = 0;
 
     if (!m) {
         return -1;
@@ -113,87 +268,125 @@ int hashmap_put(hashmap_t *const m, const char *const key,
     }
 
     /* Find a place to put our value. */
-    while (!hashmap_hash_helper(m, key, len, &index)) {
+    while (!hashmap_hash_helper(m, key, len, &slot)) {
         int rv = hashmap_rehash_helper(m);
         if (rv) {
             return rv;
         }
     }
 
-    /* Set the data. */
-    m->data[index].data    = value;
-    m->data[index].key     = key;
-    m->data[index].key_len = len;
+    width = hashmap_index_width(m->data_size);
+    index = hashmap_index_get(m->index, width, slot);
+
+    /* If the slot was not already in use, append a new element to the dense
+     * array, point the slot at it and bump our size. */
+    if (HASHMAP_EMPTY_SLOT == index) {
+        index = m->data_used++;
+        hashmap_index_set(m->index, width, slot, index + 1);
 
-    /* If the hashmap element was not already in use, set that it is being used
-     * and bump our size. */
-    if (0 == m->data[index].in_use) {
         m->data[index].in_use = 1;
         m->size++;
+    } else {
+        index--;
     }
 
+    /* Set the data. */
+    m->data[index].data    = value;
+    m->data[index].key     = key;
+    m->data[index].key_len = len;
+
     return 0;
 }
 
 
 void *hashmap_get(const hashmap_t *const m, const char *const key, size_t len)
 {
-    size_t curr;
+    struct hashmap_element *e = NULL;
 
     /* Return empty if the hash is not created */
     if (!m || !m->data) {
         return NULL;
     }
 
-    /* Find data location */
-    curr = hashmap_hash_helper_int_helper(m, key, len);
+    e = hashmap_find_helper(m, key, len, NULL);
+    if (e) {
+        return e->data;
+    }
+
+    /* Not found */
+    return NULL;
+}
 
-    /* Linear probing, if necessary */
-    for (int i = 0; i < HASHMAP_MAX_CHAIN_LENGTH; i++) {
-        if (m->data[curr].in_use) {
-            if (hashmap_match_helper(&m->data[curr], key, len)) {
-                return m->data[curr].data;
-            }
-        }
 
-        curr = (curr + 1) % m->table_size;
+int hashmap_get_handle(const hashmap_t *const m, const char *const key,
+                       size_t len, hashmap_handle_t *const out_handle)
+{
+    const struct hashmap_element *e = NULL;
+
+    if (!m || !out_handle) {
+        return -1;
+    }
+
+    if (!m->data) {
+        return 1;
+    }
+
+    e = hashmap_find_helper(m, key, len, NULL);
+    if (!e) {
+        return 1;
+    }
+
+    out_handle->index = (size_t) (e - m->data);
+    out_handle->epoch = m->epoch;
+
+    return 0;
+}
+
+
+void *hashmap_handle_get(const hashmap_t *const m,
+                         const hashmap_handle_t *const h)
+{
+    struct hashmap_element *e = hashmap_handle_helper(m, h);
+
+    if (e) {
+        return e->data;
     }
 
-    /* Not found */
     return NULL;
 }
 
 
-int hashmap_remove(hashmap_t *const m, const char *const key, size_t len)
+int hashmap_handle_set(hashmap_t *const m, const hashmap_handle_t *const h,
+                       void *const value)
 {
-    size_t curr;
+    struct hashmap_element *e = hashmap_handle_helper(m, h);
 
-    /* Nothing to remove. */
-    if (!m || !m->data) {
+    if (!e) {
         return 1;
     }
 
-    /* Find key */
-    curr = hashmap_hash_helper_int_helper(m, key, len);
+    e->data = value;
 
-    /* Linear probing, if necessary */
-    for (int i = 0; i < HASHMAP_MAX_CHAIN_LENGTH; i++) {
-        if (m->data[curr].in_use) {
-            if (hashmap_match_helper(&m->data[curr], key, len)) {
-                /* Blank out the fields including in_use */
-                memset(&m->data[curr], 0, sizeof(struct hashmap_element));
+    return 0;
+}
 
-                /* Reduce the size */
-                m->size--;
 
-                return 0;
-            }
-        }
+int hashmap_remove(hashmap_t *const m, const char *const key, size_t len)
+{
+    size_t slot = 0;
 
-        curr = (curr + 1) % m->table_size;
+    /* Nothing to remove. */
+    if (!m || !m->data) {
+        return 1;
+    }
+
+    if (!hashmap_find_helper(m, key, len, &slot)) {
+        return 1;
     }
 
-    return 1;
+    hashmap_remove_helper(m, slot);
+
+    return 0;
 }
 
 
@@ -201,37 +394,24 @@ const char *hashmap_remove_and_return_key(hashmap_t *const m,
                                           const char *const key,
                                           size_t len)
 {
-    size_t curr;
+    const struct hashmap_element *e = NULL;
+    const char *stored_key          = NULL;
+    size_t slot                     = 0;
 
     /* Nothing to remove. */
     if (!m || !m->data) {
         return NULL;
     }
 
-    /* Find key */
-    curr = hashmap_hash_helper_int_helper(m, key, len);
-
-    /* Linear probing, if necessary */
-    for (int i = 0; i < HASHMAP_MAX_CHAIN_LENGTH; i++) {
-        if (m->data[curr].in_use) {
-            if (hashmap_match_helper(&m->data[curr], key, len)) {
-                const char *const stored_key = m->data[curr].key;
-
-                /* Blank out the fields */
-                m->data[curr].in_use = 0;
-                m->data[curr].data   = NULL;
-                m->data[curr].key    = NULL;
-
-                /* Reduce the size */
-                m->size--;
-
-                return stored_key;
-            }
-        }
-        curr = (curr + 1) % m->table_size;
+    e = hashmap_find_helper(m, key, len, &slot);
+    if (!e) {
+        return NULL;
     }
 
-    return NULL;
+    stored_key = e->key;
+    hashmap_remove_helper(m, slot);
+
+    return stored_key;
 }
 
 
@@ -242,8 +422,8 @@ int hashmap_iterate(const hashmap_t *const m,
         return 0;
     }
 
-    /* Linear probing */
-    for (size_t i = 0; i < m->table_size; i++) {
+    /* The elements are dense, so just walk them in insertion order. */
+    for (size_t i = 0; i < m->data_used; i++) {
         if (m->data[i].in_use) {
             if (f(context, m->data[i].data)) {
                 return 1;
@@ -258,12 +438,15 @@ int hashmap_iterate_pairs(hashmap_t *const m,
                           int (*f)(void *const, struct hashmap_element *const),
                           void *const context)
 {
+    int removed = 0;
+    int rv      = 0;
+
     if (!m) {
         return 0;
     }
 
-    /* Linear probing */
-    for (size_t i = 0; i < m->table_size; i++) {
+    /* The elements are dense, so just walk them in insertion order. */
+    for (size_t i = 0; !rv && (i < m->data_used); i++) {
         struct hashmap_element *p = &m->data[i];
 
         if (p->in_use) {
@@ -271,13 +454,46 @@ int hashmap_iterate_pairs(hashmap_t *const m,
 
             switch (r) {
                 case -1: /* remove item */
+                    /* The callback may have freed the key, so it can't be
+                     * hashed to find the slot.  Leave a hole and sweep the
+                     * index once the walk is done. */
                     memset(p, 0, sizeof(struct hashmap_element));
                     m->size--;
+                    removed = 1;
                     break;
                 case 0: /* continue iterating */
                     break;
                 default: /* early exit */
-                    return 1;
+                    rv = 1;
+                    break;
+            }
+        }
+    }
+
+    if (removed) {
+        hashmap_sweep_helper(m);
+    }
+
+    return rv;
+}
+
+
+int hashmap_iterate_range(const hashmap_t *const m, size_t start, size_t end,
+                          int (*f)(void *const, const struct hashmap_element *const),
+                          void *const context)
+{
+    if (!m) {
+        return 0;
+    }
+
+    if (m->data_used < end) {
+        end = m->data_used;
+    }
+
+    for (size_t i = start; i < end; i++) {
+        if (m->data[i].in_use) {
+            if (f(context, &m->data[i])) {
+                return 1;
             }
         }
     }
@@ -285,11 +501,24 @@ int hashmap_iterate_pairs(hashmap_t *const m,
 }
 
 
+size_t hashmap_range_size(const hashmap_t *const m)
+{
+    if (m) {
+        return m->data_used;
+    }
+
+    return 0;
+}
+
+
 void hashmap_destroy(hashmap_t *const m)
 {
     if (m) {
         if (m->data) {
-            free(m->data);
+            CU_FREE_(CU_ALLOC_API_HASHMAP, m->data);
+        }
+        if (m->index) {
+            CU_FREE_(CU_ALLOC_API_HASHMAP, m->index);
         }
         memset(m, 0, sizeof(hashmap_t));
     }
@@ -311,11 +540,26 @@ size_t hashmap_num_entries(const hashmap_t *const m)
 /*----------------------------------------------------------------------------*/
 
 
-static size_t hashmap_hash_helper_int_helper(const hashmap_t *const m,
+static size_t hashmap_hash_helper_int_helper(const size_t table_size,
                                              const char *const keystring,
                                              const size_t len)
 {
-    uint32_t key = hashmap_crc32_helper(keystring, len);
+    uint32_t key = 0;
+
+    if (HASHMAP_HASH64_THRESHOLD < (uint64_t) table_size) {
+        uint64_t key64 = hashmap_fnv1a64_helper(keystring, len);
+
+        /* MurmurHash3's 64 bit finalizer */
+        key64 ^= (key64 >> 33);
+        key64 *= 0xff51afd7ed558ccdULL;
+        key64 ^= (key64 >> 33);
+        key64 *= 0xc4ceb9fe1a85ec53ULL;
+        key64 ^= (key64 >> 33);
+
+        return (size_t) key64 & (table_size - 1);
+    }
+
+    key = hashmap_crc32_helper(keystring, len);
 
     /* Robert Jenkins' 32 bit Mix Function */
     key += (key << 12);
@@ -330,40 +574,42 @@ static size_t hashmap_hash_helper_int_helper(const hashmap_t *const m,
     /* Knuth's Multiplicative Method */
     key = (key >> 3) * 2654435761;
 
-    return key % m->table_size;
+    /* The table size is always a power of 2. */
+    return key & (table_size - 1);
 }
 
 
 static int hashmap_match_helper(const struct hashmap_element *const element,
                                 const char *const key, const size_t len)
 {
-    return (element->key_len == len) && (0 == memcmp(element->key, key, len));
+    /* Holes may still be in the index while hashmap_iterate_pairs() runs. */
+    return element->in_use && (element->key_len == len)
+           && (0 == memcmp(element->key, key, len));
 }
 
 
+/*
+ * Finds the index slot for the key.  The slot either already refers to the
+ * key or is the first empty slot in the chain.  If there is no slot, or the
+ * key is new and there is no room left in the dense array, 0 is returned.
+ */
 static int hashmap_hash_helper(const hashmap_t *const m, const char *const key,
                                const size_t len, size_t *const out_index)
 {
     size_t curr        = 0;
     size_t first_empty = SIZE_MAX;
-    int total_in_use   = 0;
-
-    /* If full, return immediately */
-    if (m->size >= m->table_size) {
-        return 0;
-    }
+    size_t width       = hashmap_index_width(m->data_size);
+    int chain          = hashmap_chain_length(m->table_size);
 
     /* Find the best index */
-    curr = hashmap_hash_helper_int_helper(m, key, len);
+    curr = hashmap_hash_helper_int_helper(m->table_size, key, len);
 
     /* First linear probe to check if we've already insert the element */
-    total_in_use = 0;
-
-    for (int i = 0; i < HASHMAP_MAX_CHAIN_LENGTH; i++) {
-        if (m->data[curr].in_use) {
-            total_in_use++;
+    for (int i = 0; i < chain; i++) {
+        size_t index = hashmap_index_get(m->index, width, curr);
 
-            if (hashmap_match_helper(&m->data[curr], key, len)) {
+        if (HASHMAP_EMPTY_SLOT != index) {
+            if (hashmap_match_helper(&m->data[index - 1], key, len)) {
                 /* exit if we found it. */
                 *out_index = curr;
                 return 1;
@@ -372,11 +618,12 @@ static int hashmap_hash_helper(const hashmap_t *const m, const char *const key,
             first_empty = curr;
         }
 
-        curr = (curr + 1) % m->table_size;
+        curr = (curr + 1) & (m->table_size - 1);
     }
 
-    /* Actually insert our element at the first found empty slot. */
-    if (SIZE_MAX != first_empty) {
+    /* Actually insert our element at the first found empty slot, as long as
+     * the dense array has room for it. */
+    if ((SIZE_MAX != first_empty) && (m->data_used < m->data_size)) {
         /* exit if we found a place for it. */
         *out_index = first_empty;
         return 1;
@@ -387,55 +634,599 @@ static int hashmap_hash_helper(const hashmap_t *const m, const char *const key,
 }
 
 
-static int hashmap_rehash_iterator(void *const new_hash,
-                                   struct hashmap_element *const e)
+static struct hashmap_element *hashmap_find_helper(const hashmap_t *const m,
+                                                   const char *const key,
+                                                   const size_t len,
+                                                   size_t *const out_slot)
 {
-    int temp = hashmap_put((hashmap_t *) new_hash, e->key, e->key_len, e->data);
-    if (0 != temp) {
-        return 1;
+    size_t curr  = 0;
+    size_t width = hashmap_index_width(m->data_size);
+    int chain    = hashmap_chain_length(m->table_size);
+
+    /* Find data location */
+    curr = hashmap_hash_helper_int_helper(m->table_size, key, len);
+
+    /* Linear probing, if necessary */
+    for (int i = 0; i < chain; i++) {
+        size_t index = hashmap_index_get(m->index, width, curr);
+
+        if (HASHMAP_EMPTY_SLOT != index) {
+            struct hashmap_element *e = &m->data[index - 1];
+
+            if (hashmap_match_helper(e, key, len)) {
+                if (out_slot) {
+                    *out_slot = curr;
+                }
+                return e;
+            }
+        }
+
+        curr = (curr + 1) & (m->table_size - 1);
+    }
+
+    return NULL;
+}
+
+
+/*
+ * Empties the index slot and leaves a hole in the dense array.  Holes are
+ * reclaimed the next time the hashmap is rebuilt.
+ */
+static void hashmap_remove_helper(hashmap_t *const m, const size_t slot)
+{
+    size_t width = hashmap_index_width(m->data_size);
+    size_t index = hashmap_index_get(m->index, width, slot);
+
+    hashmap_index_set(m->index, width, slot, HASHMAP_EMPTY_SLOT);
+
+    /* Blank out the fields including in_use */
+    memset(&m->data[index - 1], 0, sizeof(struct hashmap_element));
+
+    /* Reduce the size */
+    m->size--;
+}
+
+
+/*
+ * Empties the index slots that refer to holes in the dense array.  This is
+ * how elements blanked out while iterating are removed from the index.
+ */
+static void hashmap_sweep_helper(hashmap_t *const m)
+{
+    size_t width = hashmap_index_width(m->data_size);
+
+    for (size_t slot = 0; slot < m->table_size; slot++) {
+        size_t index = hashmap_index_get(m->index, width, slot);
+
+        if ((HASHMAP_EMPTY_SLOT != index) && !m->data[index - 1].in_use) {
+            hashmap_index_set(m->index, width, slot, HASHMAP_EMPTY_SLOT);
+        }
+    }
+}
+
+
+/*
+ * Resolves a handle to its element, or NULL if the handle is stale.  Elements
+ * only move when the epoch changes, and removed elements stay holes until
+ * then, so a matching epoch and an element in use is all it takes.
+ */
+static struct hashmap_element *hashmap_handle_helper(const hashmap_t *const m,
+                                                     const hashmap_handle_t *const h)
+{
+    if (!m || !h || !m->data) {
+        return NULL;
     }
-    /* clear old value to avoid stale pointers */
-    return -1;
+
+    if ((h->epoch != m->epoch) || (m->data_used <= h->index)) {
+        return NULL;
+    }
+
+    if (!m->data[h->index].in_use) {
+        return NULL;
+    }
+
+    return &m->data[h->index];
 }
 
 
 /*
- * Doubles the size of the hashmap, and rehashes all the elements
+ * Makes room for another element, either by reclaiming the holes left by
+ * removed elements or by doubling the size of the hashmap.
  */
 static int hashmap_rehash_helper(hashmap_t *const m)
 {
     /* If this multiplication overflows hashmap_create will fail. */
     size_t new_size = 0;
-    int rv          = 0;
-    hashmap_t new_hash;
 
-    /* If the hashmap is less than 75% full and we had a collision, then
+    /* The dense array is full, but some of it is holes. */
+    if ((m->data_used >= m->data_size) && (m->size < m->data_used)) {
+        return hashmap_rebuild_helper(m, m->table_size, 1);
+    }
+
+    /* If the hashmap is less than 25% full and we had a collision, then
      * instead of increasing the number of buckets, we should fail out.
      * This helps prevent run-away allocations due to a non-ideal hashing
      * algorithm.*/
-    if (m->size < (3 * (m->table_size / 4))) {
+    if (m->size < (m->table_size / 4)) {
         return -3;
     }
 
     /* While this will result in doubling the size, this will not accidentally
      * overflow the size. */
-    new_size = m->table_size + HASHMAP_DEFAULT_SIZE;
-    rv       = hashmap_create(new_size, &new_hash);
-    if (0 == rv) {
+    new_size = num_to_pow2(m->table_size + HASHMAP_DEFAULT_SIZE);
+    if (HASHMAP_MAX_SIZE < new_size) {
+        return -1;
+    }
 
-        /* copy the old elements to the new table */
-        rv = hashmap_iterate_pairs(m, hashmap_rehash_iterator, &new_hash);
-        if (0 == rv) {
+    return hashmap_rebuild_helper(m, new_size, 1);
+}
+
+
+/*
+ * Rebuilds the index with table_size slots from the elements in use, and
+ * squeezes the holes out of the dense array.  On failure the hashmap is left
+ * as it was.  The dense array must still fit the elements in use.
+ */
+static int hashmap_rebuild_helper(hashmap_t *const m, const size_t table_size,
+                                  const int threads)
+{
+    size_t data_size = hashmap_usable_size(table_size);
+    size_t width     = hashmap_index_width(data_size);
+    size_t next      = 0;
+    void *index      = NULL;
+    int rv           = 0;
+
+    index = CU_CALLOC_(CU_ALLOC_API_HASHMAP, table_size, width);
+    if (!index) {
+        return -2;
+    }
+
+    rv = hashmap_index_helper(m, index, table_size, width, 0, threads);
+    if (rv) {
+        CU_FREE_(CU_ALLOC_API_HASHMAP, index);
+        return rv;
+    }
+
+    if (data_size > m->data_size) {
+        struct hashmap_element *data = NULL;
+
+        if ((SIZE_MAX / sizeof(struct hashmap_element)) < data_size) {
+            CU_FREE_(CU_ALLOC_API_HASHMAP, index);
+            return -2;
+        }
+
+        data = CU_REALLOC_(CU_ALLOC_API_HASHMAP, m->data, data_size * sizeof(struct hashmap_element));
+        if (!data) {
+            CU_FREE_(CU_ALLOC_API_HASHMAP, index);
+            return -2;
+        }
+        m->data = data;
+    }
+
+    /* Squeeze out the holes, keeping the insertion order. */
+    next = 0;
+    for (size_t i = 0; i < m->data_used; i++) {
+        if (m->data[i].in_use) {
+            if (next != i) {
+                m->data[next] = m->data[i];
+            }
+            next++;
+        }
+    }
 
-            hashmap_destroy(m);
-            /* put new hash into old hash structure by copying */
-            memcpy(m, &new_hash, sizeof(hashmap_t));
+    /* Shrinking cannot fail, at worst the larger allocation is kept. */
+    if (data_size < m->data_size) {
+        struct hashmap_element *data = NULL;
+
+        data = CU_REALLOC_(CU_ALLOC_API_HASHMAP, m->data, data_size * sizeof(struct hashmap_element));
+        if (data) {
+            m->data = data;
         }
     }
+    memset(&m->data[next], 0, (data_size - next) * sizeof(struct hashmap_element));
+
+    /* Elements moved, so outstanding handles are stale. */
+    if (next != m->data_used) {
+        m->epoch++;
+    }
+
+    if (m->index) {
+        CU_FREE_(CU_ALLOC_API_HASHMAP, m->index);
+    }
+
+    m->index      = index;
+    m->table_size = table_size;
+    m->data_size  = data_size;
+    m->data_used  = next;
+
+    return 0;
+}
+
+
+/*
+ * Fills an empty index with table_size slots from the elements in use.  Each
+ * element is indexed at the position it will have once the holes are
+ * squeezed out of the dense array.
+ *
+ * Large tables are filled in three passes: hash every key, partition the
+ * elements by the top bits of their home slot (a counting sort) and then
+ * place them, so the writes to the index are sequential instead of random.
+ * If the scratch space cannot be allocated the elements are placed directly.
+ *
+ * If merge is set, an element with the same key as an earlier one is folded
+ * into it and left as a hole.  This requires that there are no holes yet.
+ * Otherwise large tables can be filled by several threads.
+ */
+static int hashmap_index_helper(hashmap_t *const m, void *const index,
+                                const size_t table_size, const size_t width,
+                                const int merge, const int threads)
+{
+    size_t *home   = NULL;
+    size_t *order  = NULL;
+    size_t *count  = NULL;
+    size_t live    = m->size;
+    size_t buckets = table_size;
+    size_t k       = 0;
+    int shift      = 0;
+    int rv         = 0;
+
+    if ((1 < threads) && !merge && (HASHMAP_PARTITION_MIN <= live)) {
+        return hashmap_index_parallel_helper(m, index, table_size, width,
+                                             threads);
+    }
+
+    if (HASHMAP_PARTITION_MIN <= live) {
+        if (HASHMAP_PARTITION_BUCKETS < buckets) {
+            buckets = HASHMAP_PARTITION_BUCKETS;
+        }
+        while ((buckets << shift) < table_size) {
+            shift++;
+        }
+
+        home  = CU_MALLOC_(CU_ALLOC_API_HASHMAP, live * sizeof(size_t));
+        order = CU_MALLOC_(CU_ALLOC_API_HASHMAP, live * sizeof(size_t));
+        count = CU_CALLOC_(CU_ALLOC_API_HASHMAP, buckets + 1, sizeof(size_t));
+    }
+
+    if (home && order && count) {
+        /* Hash all the keys in one tight loop. */
+        for (size_t i = 0; i < m->data_used; i++) {
+            if (m->data[i].in_use) {
+                home[k] = hashmap_hash_helper_int_helper(table_size,
+                                                         m->data[i].key,
+                                                         m->data[i].key_len);
+                count[(home[k] >> shift) + 1]++;
+                k++;
+            }
+        }
+
+        /* Partition by home slot.  The sort is stable, so duplicate keys
+         * are still seen in insertion order. */
+        for (size_t b = 0; b < buckets; b++) {
+            count[b + 1] += count[b];
+        }
+        for (k = 0; k < live; k++) {
+            order[count[home[k] >> shift]++] = k;
+        }
+
+        for (k = 0; !rv && (k < live); k++) {
+            rv = hashmap_place_helper(m, index, table_size, width,
+                                      home[order[k]], order[k], merge);
+        }
+    } else {
+        for (size_t i = 0; !rv && (i < m->data_used); i++) {
+            if (m->data[i].in_use) {
+                size_t curr = hashmap_hash_helper_int_helper(table_size,
+                                                             m->data[i].key,
+                                                             m->data[i].key_len);
+
+                rv = hashmap_place_helper(m, index, table_size, width,
+                                          curr, k, merge);
+                k++;
+            }
+        }
+    }
+
+    CU_FREE_(CU_ALLOC_API_HASHMAP, home);
+    CU_FREE_(CU_ALLOC_API_HASHMAP, order);
+    CU_FREE_(CU_ALLOC_API_HASHMAP, count);
+
     return rv;
 }
 
 
+/*
+ * Fills the index using several threads.  Each worker takes a range of the
+ * dense array and claims slots with a compare and swap, so no locks are
+ * needed.  Slots only ever go from empty to used, so every element still
+ * ends up in the first slot of its chain that was free when it was placed,
+ * which is all the probing in hashmap_find_helper() relies on.
+ *
+ * If a thread cannot be started its range is done on this thread instead.
+ */
+static int hashmap_index_parallel_helper(hashmap_t *const m, void *const index,
+                                         const size_t table_size,
+                                         const size_t width, int threads)
+{
+    struct hashmap_worker workers[HASHMAP_MAX_THREADS];
+    pthread_t tids[HASHMAP_MAX_THREADS];
+    int started[HASHMAP_MAX_THREADS];
+    size_t per  = 0;
+    size_t pos  = 0;
+    int fail    = 0;
+    int rv      = 0;
+
+    if (HASHMAP_MAX_THREADS < threads) {
+        threads = HASHMAP_MAX_THREADS;
+    }
+    per = (m->data_used + (size_t) threads - 1) / (size_t) threads;
+
+    /* Work out where each range starts once the holes are squeezed out. */
+    for (int t = 0; t < threads; t++) {
+        struct hashmap_worker *w = &workers[t];
+
+        w->m          = m;
+        w->index      = index;
+        w->table_size = table_size;
+        w->width      = width;
+        w->start      = (size_t) t * per;
+        w->end        = w->start + per;
+        w->fail       = &fail;
+        w->rv         = 0;
+
+        if (m->data_used < w->start) {
+            w->start = m->data_used;
+        }
+        if (m->data_used < w->end) {
+            w->end = m->data_used;
+        }
+
+        w->pos = pos;
+        for (size_t i = w->start; i < w->end; i++) {
+            if (m->data[i].in_use) {
+                pos++;
+            }
+        }
+    }
+
+    for (int t = 1; t < threads; t++) {
+        started[t] = (0 == pthread_create(&tids[t], NULL, hashmap_worker_helper,
+                                          &workers[t]));
+        if (!started[t]) {
+            hashmap_worker_helper(&workers[t]);
+        }
+    }
+    hashmap_worker_helper(&workers[0]);
+
+    for (int t = 1; t < threads; t++) {
+        if (started[t]) {
+            pthread_join(tids[t], NULL);
+        }
+    }
+
+    for (int t = 0; !rv && (t < threads); t++) {
+        rv = workers[t].rv;
+    }
+
+    return rv;
+}
+
+
+static void *hashmap_worker_helper(void *arg)
+{
+    struct hashmap_worker *w = (struct hashmap_worker *) arg;
+    const hashmap_t *m       = w->m;
+    int chain                = hashmap_chain_length(w->table_size);
+    size_t pos               = w->pos;
+
+    for (size_t i = w->start; i < w->end; i++) {
+        const struct hashmap_element *e = &m->data[i];
+        size_t curr                     = 0;
+        int placed                      = 0;
+
+        if (!e->in_use) {
+            continue;
+        }
+
+        /* Stop early if another worker already failed. */
+        if (__atomic_load_n(w->fail, __ATOMIC_RELAXED)) {
+            return NULL;
+        }
+
+        curr = hashmap_hash_helper_int_helper(w->table_size, e->key, e->key_len);
+        for (int j = 0; !placed && (j < chain); j++) {
+            placed = hashmap_index_claim(w->index, w->width, curr, pos + 1);
+            curr   = (curr + 1) & (w->table_size - 1);
+        }
+
+        if (!placed) {
+            w->rv = -3;
+            __atomic_store_n(w->fail, 1, __ATOMIC_RELAXED);
+            return NULL;
+        }
+        pos++;
+    }
+
+    return NULL;
+}
+
+
+/*
+ * Points the first empty slot in the chain starting at curr to the element
+ * at pos, or merges the element into an earlier one with the same key.
+ */
+static int hashmap_place_helper(hashmap_t *const m, void *const index,
+                                const size_t table_size, const size_t width,
+                                size_t curr, const size_t pos, const int merge)
+{
+    int chain = hashmap_chain_length(table_size);
+
+    for (int i = 0; i < chain; i++) {
+        size_t slot = hashmap_index_get(index, width, curr);
+
+        if (HASHMAP_EMPTY_SLOT == slot) {
+            hashmap_index_set(index, width, curr, pos + 1);
+            return 0;
+        }
+
+        if (merge) {
+            struct hashmap_element *e   = &m->data[slot - 1];
+            struct hashmap_element *dup = &m->data[pos];
+
+            if (hashmap_match_helper(e, dup->key, dup->key_len)) {
+                /* Same as a second hashmap_put() of the key. */
+                e->key  = dup->key;
+                e->data = dup->data;
+                memset(dup, 0, sizeof(struct hashmap_element));
+                m->size--;
+                return 0;
+            }
+        }
+
+        curr = (curr + 1) & (table_size - 1);
+    }
+
+    return -3;
+}
+
+
+/*
+ * The dense array only needs to hold as many elements as the hashmap allows
+ * before it grows, which is 75% of the index slots.
+ */
+static size_t hashmap_usable_size(const size_t table_size)
+{
+    return table_size - (table_size / 4);
+}
+
+
+/*
+ * Runs of used slots get longer as the table grows, so the number of slots
+ * probed grows with it: 2 * log2(table_size), but never less than
+ * HASHMAP_MIN_CHAIN_LENGTH.
+ */
+static int hashmap_chain_length(const size_t table_size)
+{
+    uint64_t n = (uint64_t) table_size;
+    int bits   = 0;
+
+    for (int shift = 32; 0 < shift; shift >>= 1) {
+        if (n >> shift) {
+            n >>= shift;
+            bits += shift;
+        }
+    }
+
+    if ((2 * bits) < HASHMAP_MIN_CHAIN_LENGTH) {
+        return HASHMAP_MIN_CHAIN_LENGTH;
+    }
+
+    return 2 * bits;
+}
+
+
+/*
+ * The narrowest index slot that can refer to every element, with 0 reserved
+ * for empty slots.
+ */
+static size_t hashmap_index_width(const size_t data_size)
+{
+    if (data_size <= UINT8_MAX) {
+        return sizeof(uint8_t);
+    }
+
+    if (data_size <= UINT16_MAX) {
+        return sizeof(uint16_t);
+    }
+
+    if ((uint64_t) data_size <= UINT32_MAX) {
+        return sizeof(uint32_t);
+    }
+
+    return sizeof(uint64_t);
+}
+
+
+static size_t hashmap_index_get(const void *const index, const size_t width,
+                                const size_t slot)
+{
+    switch (width) {
+        case sizeof(uint8_t):
+            return ((const uint8_t *) index)[slot];
+        case sizeof(uint16_t):
+            return ((const uint16_t *) index)[slot];
+        case sizeof(uint32_t):
+            return ((const uint32_t *) index)[slot];
+        default:
+            break;
+    }
+
+    return (size_t) ((const uint64_t *) index)[slot];
+}
+
+
+static void hashmap_index_set(void *const index, const size_t width,
+                              const size_t slot, const size_t value)
+{
+    switch (width) {
+        case sizeof(uint8_t):
+            ((uint8_t *) index)[slot] = (uint8_t) value;
+            break;
+        case sizeof(uint16_t):
+            ((uint16_t *) index)[slot] = (uint16_t) value;
+            break;
+        case sizeof(uint32_t):
+            ((uint32_t *) index)[slot] = (uint32_t) value;
+            break;
+        default:
+            ((uint64_t *) index)[slot] = (uint64_t) value;
+            break;
+    }
+}
+
+
+/*
+ * Atomically sets an empty index slot.  Returns 1 if the slot was claimed, or
+ * 0 if it was already in use.
+ */
+static int hashmap_index_claim(void *const index, const size_t width,
+                               const size_t slot, const size_t value)
+{
+    switch (width) {
+        case sizeof(uint8_t):
+        {
+            uint8_t empty = HASHMAP_EMPTY_SLOT;
+            return __atomic_compare_exchange_n(&((uint8_t *) index)[slot],
+                                               &empty, (uint8_t) value, 0,
+                                               __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+        }
+        case sizeof(uint16_t):
+        {
+            uint16_t empty = HASHMAP_EMPTY_SLOT;
+            return __atomic_compare_exchange_n(&((uint16_t *) index)[slot],
+                                               &empty, (uint16_t) value, 0,
+                                               __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+        }
+        case sizeof(uint32_t):
+        {
+            uint32_t empty = HASHMAP_EMPTY_SLOT;
+            return __atomic_compare_exchange_n(&((uint32_t *) index)[slot],
+                                               &empty, (uint32_t) value, 0,
+                                               __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+        }
+        default:
+            break;
+    }
+
+    {
+        uint64_t empty = HASHMAP_EMPTY_SLOT;
+        return __atomic_compare_exchange_n(&((uint64_t *) index)[slot],
+                                           &empty, (uint64_t) value, 0,
+                                           __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+    }
+}
+
+
 /**
  * Figure out the power of 2 size that fits the ask.
  *
@@ -453,6 +1244,7 @@ static size_t num_to_pow2(size_t n)
     n |= n >> 4;
     n |= n >> 8;
     n |= n >> 16;
+    n |= (n >> 16) >> 16; /* Safe even when size_t is 32 bits. */
     n++;
 
     return n;
@@ -99,3 +99,16 @@ extern uint32_t hashmap_crc32_helper(const char *const s, const size_t len)
     }
     return crc32val;
 }
+
+
+extern uint64_t hashmap_fnv1a64_helper(const char *const s, const size_t len)
+{
+    /* FNV-1a, 64 bit offset basis and prime. */
+    uint64_t hash = 0xcbf29ce484222325ULL;
+
+    for (size_t i = 0; i < len; i++) {
+        hash ^= (uint8_t) s[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
@@ -0,0 +1,976 @@
+/* SPDX-FileCopyrightText: 2026 Comcast Cable Communications Management, LLC */
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#define _POSIX_C_SOURCE 200809L
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "alloc.h"
+#include "hashmap_file.h"
+#include "strings.h"
+
+/*----------------------------------------------------------------------------*/
+/*                                   Macros                                   */
+/*----------------------------------------------------------------------------*/
+
+/* The file starts with a page holding two header slots.  Headers are written
+ * to alternating slots, so a torn header write leaves the previous one. */
+#define HASHMAP_FILE_HEADER_SIZE (4096)
+#define HASHMAP_FILE_HEADER_SLOT (2048)
+#define HASHMAP_FILE_MAGIC       "CUHMAPv1"
+
+#define HASHMAP_FILE_MIN_SLOTS (1024)
+#define HASHMAP_FILE_MIN_LOG   (65536)
+#define HASHMAP_FILE_MAX_LEN   (SIZE_MAX / 4)
+
+/* Index slots hold the file offset of a record, or one of these.  Records
+ * always come after the header, so neither is a valid offset. */
+#define HASHMAP_FILE_EMPTY   (0)
+#define HASHMAP_FILE_REMOVED (1)
+
+#define HASHMAP_FILE_PUT    (1)
+#define HASHMAP_FILE_DELETE (2)
+
+/*----------------------------------------------------------------------------*/
+/*                               Data Structures                              */
+/*----------------------------------------------------------------------------*/
+struct hashmap_file_header {
+    char magic[8];
+    uint64_t generation;
+    uint64_t table_size;
+    uint64_t log_end;
+    uint64_t count;
+    uint64_t used;
+    uint64_t dead;
+    uint32_t dirty;
+    uint32_t crc;
+};
+
+/* A record is followed by the key, then the value, padded to 8 bytes.  The
+ * crc covers everything after the crc field. */
+struct hashmap_file_record {
+    uint32_t crc;
+    uint32_t type;
+    uint64_t key_len;
+    uint64_t value_len;
+};
+
+/*----------------------------------------------------------------------------*/
+/*                            Function Prototypes                             */
+/*----------------------------------------------------------------------------*/
+
+extern uint32_t hashmap_crc32_helper(const char *const s, const size_t len);
+extern uint64_t hashmap_fnv1a64_helper(const char *const s, const size_t len);
+
+static int hashmap_file_init_helper(hashmap_file_t *const m,
+                                    const uint64_t table_size,
+                                    const uint64_t file_size);
+static int hashmap_file_load_helper(hashmap_file_t *const m,
+                                    const uint64_t file_size);
+static int hashmap_file_replay_helper(hashmap_file_t *const m);
+static int hashmap_file_check_helper(const hashmap_file_t *const m);
+static int hashmap_file_commit_helper(hashmap_file_t *const m);
+static int hashmap_file_touch_helper(hashmap_file_t *const m);
+static int hashmap_file_reserve_helper(hashmap_file_t *const m,
+                                       const uint64_t size, const int slot);
+static int hashmap_file_grow_helper(hashmap_file_t *const m, const uint64_t size);
+static int hashmap_file_compact_helper(hashmap_file_t *const m,
+                                       const uint64_t size);
+static int hashmap_file_find_helper(const hashmap_file_t *const m,
+                                    const void *key, const size_t len,
+                                    uint64_t *const out_slot);
+static int hashmap_file_fits_helper(const hashmap_file_t *const m,
+                                    const uint64_t off);
+static int hashmap_file_live_helper(const hashmap_file_t *const m,
+                                    const uint64_t off);
+static uint64_t hashmap_file_append_helper(hashmap_file_t *const m,
+                                           const uint32_t type,
+                                           const void *key, const size_t key_len,
+                                           const void *value,
+                                           const size_t value_len);
+static uint32_t hashmap_file_record_crc(const struct hashmap_file_record *const r);
+static uint64_t hashmap_file_record_size(const uint64_t key_len,
+                                         const uint64_t value_len);
+static uint64_t hashmap_file_log_start(const hashmap_file_t *const m);
+static uint64_t *hashmap_file_index(const hashmap_file_t *const m);
+static struct hashmap_file_record *hashmap_file_record(const hashmap_file_t *const m,
+                                                       const uint64_t off);
+static void hashmap_file_unmap(hashmap_file_t *const m);
+static int hashmap_file_sync_dir_helper(const char *const path);
+
+
+/*----------------------------------------------------------------------------*/
+/*                             External Functions                             */
+/*----------------------------------------------------------------------------*/
+
+
+int hashmap_file_open(const char *path, hashmap_file_t *const out_hashmap)
+{
+    hashmap_file_t *m = out_hashmap;
+    struct stat st;
+    int rv = 0;
+
+    if (!path || !m) {
+        return -1;
+    }
+
+    memset(m, 0, sizeof(hashmap_file_t));
+    m->fd = -1;
+
+    m->path = cu_strdup(path);
+    if (!m->path) {
+        return -2;
+    }
+
+    m->fd = open(path, O_RDWR | O_CREAT, 0644);
+    if ((m->fd < 0) || (0 != fstat(m->fd, &st))) {
+        rv = -4;
+    } else if (0 == st.st_size) {
+        rv = hashmap_file_init_helper(m, HASHMAP_FILE_MIN_SLOTS,
+                                      HASHMAP_FILE_HEADER_SIZE
+                                          + HASHMAP_FILE_MIN_SLOTS * sizeof(uint64_t)
+                                          + HASHMAP_FILE_MIN_LOG);
+        if (!rv) {
+            /* The file may be new, so make its directory entry stick. */
+            rv = hashmap_file_sync_dir_helper(path);
+        }
+    } else {
+        rv = hashmap_file_load_helper(m, (uint64_t) st.st_size);
+    }
+
+    if (rv) {
+        hashmap_file_unmap(m);
+    }
+
+    return rv;
+}
+
+
+int hashmap_file_sync(hashmap_file_t *const m)
+{
+    int rv = 0;
+
+    if (!m || !m->base) {
+        return -1;
+    }
+
+    if (!m->dirty) {
+        return 0;
+    }
+
+    /* The records and index must be on disk before the header that says
+     * they are there. */
+    if (0 != msync(m->base, m->map_size, MS_SYNC)) {
+        return -4;
+    }
+
+    m->dirty = 0;
+    rv       = hashmap_file_commit_helper(m);
+    if (rv) {
+        m->dirty = 1;
+    }
+
+    return rv;
+}
+
+
+int hashmap_file_close(hashmap_file_t *const m)
+{
+    int rv = 0;
+
+    if (!m || !m->base) {
+        return -1;
+    }
+
+    rv = hashmap_file_sync(m);
+    hashmap_file_unmap(m);
+
+    return rv;
+}
+
+
+int hashmap_file_put(hashmap_file_t *const m, const void *key, size_t key_len,
+                     const void *value, size_t value_len)
+{
+    uint64_t *index = NULL;
+    uint64_t size   = 0;
+    uint64_t slot   = 0;
+    uint64_t off    = 0;
+    int found       = 0;
+    int rv          = 0;
+
+    if (!m || !m->base || (!key && key_len) || (!value && value_len)
+        || (HASHMAP_FILE_MAX_LEN < key_len) || (HASHMAP_FILE_MAX_LEN < value_len))
+    {
+        return -1;
+    }
+
+    size = hashmap_file_record_size(key_len, value_len);
+
+    /* Compacting leaves a clean file, so only mark it dirty afterwards. */
+    rv = hashmap_file_reserve_helper(m, size, 1);
+    if (rv) {
+        return rv;
+    }
+
+    rv = hashmap_file_touch_helper(m);
+    if (rv) {
+        return rv;
+    }
+
+    found = hashmap_file_find_helper(m, key, key_len, &slot);
+    index = hashmap_file_index(m);
+
+    if (found) {
+        const struct hashmap_file_record *old = hashmap_file_record(m, index[slot]);
+
+        m->dead += hashmap_file_record_size(old->key_len, old->value_len);
+    } else {
+        if (HASHMAP_FILE_EMPTY == index[slot]) {
+            m->used++;
+        }
+        m->count++;
+    }
+
+    off = hashmap_file_append_helper(m, HASHMAP_FILE_PUT, key, key_len,
+                                     value, value_len);
+
+    index[slot] = off;
+
+    return 0;
+}
+
+
+int hashmap_file_get(const hashmap_file_t *const m, const void *key,
+                     size_t key_len, const void **value, size_t *value_len)
+{
+    const struct hashmap_file_record *r = NULL;
+    uint64_t slot                       = 0;
+
+    if (!m || !m->base || (!key && key_len) || !value || !value_len) {
+        return -1;
+    }
+
+    if (!hashmap_file_find_helper(m, key, key_len, &slot)) {
+        return 1;
+    }
+
+    r          = hashmap_file_record(m, hashmap_file_index(m)[slot]);
+    *value     = (const uint8_t *) (r + 1) + r->key_len;
+    *value_len = (size_t) r->value_len;
+
+    return 0;
+}
+
+
+int hashmap_file_remove(hashmap_file_t *const m, const void *key, size_t key_len)
+{
+    const struct hashmap_file_record *old = NULL;
+    uint64_t *index                       = NULL;
+    uint64_t size                         = 0;
+    uint64_t slot                         = 0;
+    int rv                                = 0;
+
+    if (!m || !m->base || (!key && key_len) || (HASHMAP_FILE_MAX_LEN < key_len)) {
+        return -1;
+    }
+
+    if (!hashmap_file_find_helper(m, key, key_len, &slot)) {
+        return 1;
+    }
+
+    /* The removal is logged too, so replaying the log gets it right. */
+    size = hashmap_file_record_size(key_len, 0);
+
+    rv = hashmap_file_reserve_helper(m, size, 0);
+    if (rv) {
+        return rv;
+    }
+
+    rv = hashmap_file_touch_helper(m);
+    if (rv) {
+        return rv;
+    }
+
+    /* Growing may have moved everything. */
+    hashmap_file_find_helper(m, key, key_len, &slot);
+    index = hashmap_file_index(m);
+    old   = hashmap_file_record(m, index[slot]);
+
+    m->dead += hashmap_file_record_size(old->key_len, old->value_len) + size;
+    m->count--;
+
+    hashmap_file_append_helper(m, HASHMAP_FILE_DELETE, key, key_len, NULL, 0);
+    index[slot] = HASHMAP_FILE_REMOVED;
+
+    return 0;
+}
+
+
+int hashmap_file_iterate(const hashmap_file_t *const m,
+                         int (*f)(void *const, const void *, size_t,
+                                  const void *, size_t),
+                         void *const context)
+{
+    uint64_t off  = 0;
+    uint64_t size = 0;
+
+    if (!m || !m->base) {
+        return 0;
+    }
+
+    for (off = hashmap_file_log_start(m); off < m->log_end; off += size) {
+        const struct hashmap_file_record *r = hashmap_file_record(m, off);
+        const uint8_t *key                  = (const uint8_t *) (r + 1);
+
+        size = hashmap_file_record_size(r->key_len, r->value_len);
+
+        if ((HASHMAP_FILE_PUT == r->type) && hashmap_file_live_helper(m, off)) {
+            if (f(context, key, (size_t) r->key_len, key + r->key_len,
+                  (size_t) r->value_len))
+            {
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+
+size_t hashmap_file_num_entries(const hashmap_file_t *const m)
+{
+    if (m) {
+        return (size_t) m->count;
+    }
+
+    return 0;
+}
+
+
+/*----------------------------------------------------------------------------*/
+/*                            Internal Functions                              */
+/*----------------------------------------------------------------------------*/
+
+
+/*
+ * Sizes and maps an empty file with table_size index slots, and commits the
+ * first header.
+ */
+static int hashmap_file_init_helper(hashmap_file_t *const m,
+                                    const uint64_t table_size,
+                                    const uint64_t file_size)
+{
+    void *base = NULL;
+
+    if (0 != ftruncate(m->fd, (off_t) file_size)) {
+        return -4;
+    }
+
+    base = mmap(NULL, (size_t) file_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                m->fd, 0);
+    if (MAP_FAILED == base) {
+        return -4;
+    }
+
+    m->base       = (uint8_t *) base;
+    m->map_size   = (size_t) file_size;
+    m->generation = 0;
+    m->table_size = table_size;
+    m->log_end    = hashmap_file_log_start(m);
+    m->count      = 0;
+    m->used       = 0;
+    m->dead       = 0;
+    m->dirty      = 0;
+
+    return hashmap_file_commit_helper(m);
+}
+
+
+/*
+ * Maps an existing file and picks the newest valid header.  If the file was
+ * not synced since it was last changed, the index is rebuilt from the log,
+ * otherwise the index and log are checked against the file.
+ */
+static int hashmap_file_load_helper(hashmap_file_t *const m,
+                                    const uint64_t file_size)
+{
+    const struct hashmap_file_header *best = NULL;
+    void *base                             = NULL;
+
+    if (file_size < HASHMAP_FILE_HEADER_SIZE) {
+        return -5;
+    }
+
+    base = mmap(NULL, (size_t) file_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                m->fd, 0);
+    if (MAP_FAILED == base) {
+        return -4;
+    }
+    m->base     = (uint8_t *) base;
+    m->map_size = (size_t) file_size;
+
+    for (int i = 0; i < 2; i++) {
+        const struct hashmap_file_header *h =
+            (const struct hashmap_file_header *) (m->base + i * HASHMAP_FILE_HEADER_SLOT);
+        uint64_t log_start = 0;
+
+        if ((0 != memcmp(h->magic, HASHMAP_FILE_MAGIC, sizeof(h->magic)))
+            || (h->crc != hashmap_crc32_helper((const char *) h,
+                                               offsetof(struct hashmap_file_header, crc))))
+        {
+            continue;
+        }
+
+        /* Make sure the header describes something that fits the file. */
+        if ((0 == h->table_size) || (h->table_size & (h->table_size - 1))
+            || ((file_size / sizeof(uint64_t)) < h->table_size))
+        {
+            continue;
+        }
+        log_start = HASHMAP_FILE_HEADER_SIZE + h->table_size * sizeof(uint64_t);
+        if ((h->log_end < log_start) || (file_size < h->log_end)) {
+            continue;
+        }
+
+        if (!best || (best->generation < h->generation)) {
+            best = h;
+        }
+    }
+
+    if (!best) {
+        return -5;
+    }
+
+    m->generation = best->generation;
+    m->table_size = best->table_size;
+    m->log_end    = best->log_end;
+    m->count      = best->count;
+    m->used       = best->used;
+    m->dead       = best->dead;
+    m->dirty      = (0 != best->dirty);
+
+    if (m->dirty) {
+        int rv = hashmap_file_replay_helper(m);
+        if (rv) {
+            return rv;
+        }
+        return hashmap_file_sync(m);
+    }
+
+    return hashmap_file_check_helper(m);
+}
+
+
+/*
+ * Rebuilds the index from the committed part of the log.  Anything past the
+ * last committed (or last intact) record is cleared away.
+ */
+static int hashmap_file_replay_helper(hashmap_file_t *const m)
+{
+    uint64_t *index = hashmap_file_index(m);
+    uint64_t off    = hashmap_file_log_start(m);
+
+    memset(index, 0, (size_t) (m->table_size * sizeof(uint64_t)));
+    m->count = 0;
+    m->used  = 0;
+    m->dead  = 0;
+
+    while (hashmap_file_fits_helper(m, off)) {
+        const struct hashmap_file_record *r = hashmap_file_record(m, off);
+        uint64_t size = hashmap_file_record_size(r->key_len, r->value_len);
+        uint64_t slot = 0;
+        int found     = 0;
+
+        if (r->crc != hashmap_file_record_crc(r)) {
+            break;
+        }
+
+        found = hashmap_file_find_helper(m, r + 1, (size_t) r->key_len, &slot);
+        if (found) {
+            const struct hashmap_file_record *old = hashmap_file_record(m, index[slot]);
+
+            m->dead += hashmap_file_record_size(old->key_len, old->value_len);
+        }
+
+        if (HASHMAP_FILE_PUT == r->type) {
+            if (UINT64_MAX == slot) {
+                return -5;
+            }
+            if (!found) {
+                if (HASHMAP_FILE_EMPTY == index[slot]) {
+                    m->used++;
+                }
+                m->count++;
+            }
+            index[slot] = off;
+        } else {
+            if (found) {
+                index[slot] = HASHMAP_FILE_REMOVED;
+                m->count--;
+            }
+            m->dead += size;
+        }
+
+        off += size;
+    }
+
+    m->log_end = off;
+    memset(m->base + off, 0, m->map_size - (size_t) off);
+
+    return 0;
+}
+
+
+/*
+ * Makes sure every record in the log, and every record the index points at,
+ * lies within the log.  A damaged file is rejected instead of being read past
+ * its end.  The record checksums are only checked when replaying.
+ */
+static int hashmap_file_check_helper(const hashmap_file_t *const m)
+{
+    const uint64_t *index = hashmap_file_index(m);
+    uint64_t start        = hashmap_file_log_start(m);
+    uint64_t off          = start;
+
+    while (off < m->log_end) {
+        const struct hashmap_file_record *r = hashmap_file_record(m, off);
+
+        if (!hashmap_file_fits_helper(m, off)) {
+            return -5;
+        }
+        off += hashmap_file_record_size(r->key_len, r->value_len);
+    }
+
+    for (uint64_t i = 0; i < m->table_size; i++) {
+        off = index[i];
+
+        if ((HASHMAP_FILE_EMPTY == off) || (HASHMAP_FILE_REMOVED == off)) {
+            continue;
+        }
+        if ((off < start) || (off & 7) || !hashmap_file_fits_helper(m, off)
+            || (HASHMAP_FILE_PUT != hashmap_file_record(m, off)->type))
+        {
+            return -5;
+        }
+    }
+
+    return 0;
+}
+
+
+/*
+ * Writes the next header into the slot the current one is not in.
+ */
+static int hashmap_file_commit_helper(hashmap_file_t *const m)
+{
+    struct hashmap_file_header h;
+
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, HASHMAP_FILE_MAGIC, sizeof(h.magic));
+    h.generation = m->generation + 1;
+    h.table_size = m->table_size;
+    h.log_end    = m->log_end;
+    h.count      = m->count;
+    h.used       = m->used;
+    h.dead       = m->dead;
+    h.dirty      = (uint32_t) m->dirty;
+    h.crc = hashmap_crc32_helper((const char *) &h,
+                                 offsetof(struct hashmap_file_header, crc));
+
+    memcpy(m->base + (h.generation & 1) * HASHMAP_FILE_HEADER_SLOT, &h, sizeof(h));
+    if (0 != msync(m->base, HASHMAP_FILE_HEADER_SIZE, MS_SYNC)) {
+        return -4;
+    }
+    m->generation = h.generation;
+
+    return 0;
+}
+
+
+/*
+ * Before the first change after a sync, commit a header marking the file as
+ * dirty, so a crash before the next sync makes the next open replay the log.
+ */
+static int hashmap_file_touch_helper(hashmap_file_t *const m)
+{
+    int rv = 0;
+
+    if (m->dirty) {
+        return 0;
+    }
+
+    m->dirty = 1;
+    rv       = hashmap_file_commit_helper(m);
+    if (rv) {
+        m->dirty = 0;
+    }
+
+    return rv;
+}
+
+
+/*
+ * Makes sure there is room in the log for size more bytes and, if slot is
+ * set, room in the index for another key.  The index is kept at most 75%
+ * used, counting the slots of removed keys.
+ */
+static int hashmap_file_reserve_helper(hashmap_file_t *const m,
+                                       const uint64_t size, const int slot)
+{
+    uint64_t usable   = m->table_size - (m->table_size / 4);
+    uint64_t log_used = m->log_end - hashmap_file_log_start(m);
+    int full_log      = ((m->map_size - m->log_end) < size);
+
+    if ((slot && (usable < (m->used + 1))) || (full_log && ((log_used / 2) <= m->dead))) {
+        return hashmap_file_compact_helper(m, size);
+    }
+
+    if (full_log) {
+        return hashmap_file_grow_helper(m, size);
+    }
+
+    return 0;
+}
+
+
+/*
+ * Doubles the file until size more bytes fit in the log.  The new mapping is
+ * made before the old one is dropped, so a failure leaves the old one.
+ */
+static int hashmap_file_grow_helper(hashmap_file_t *const m, const uint64_t size)
+{
+    uint64_t file_size = m->map_size;
+    void *base         = NULL;
+
+    while ((file_size - m->log_end) < size) {
+        file_size *= 2;
+    }
+
+    if (0 != ftruncate(m->fd, (off_t) file_size)) {
+        return -4;
+    }
+
+    base = mmap(NULL, (size_t) file_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                m->fd, 0);
+    if (MAP_FAILED == base) {
+        return -4;
+    }
+
+    munmap(m->base, m->map_size);
+    m->base     = (uint8_t *) base;
+    m->map_size = (size_t) file_size;
+
+    return 0;
+}
+
+
+/*
+ * Writes the live records into a new file with an index sized for them (at
+ * most 37.5% used) and room in the log for size more bytes, then renames it
+ * over the old file.  The new file is synced before the rename, so a crash
+ * leaves either the old file or the complete new one.  The directory is
+ * synced after the rename so the new file is the one that survives.
+ */
+static int hashmap_file_compact_helper(hashmap_file_t *const m,
+                                       const uint64_t size)
+{
+    hashmap_file_t n;
+    uint64_t table_size = HASHMAP_FILE_MIN_SLOTS;
+    uint64_t live       = m->log_end - hashmap_file_log_start(m) - m->dead;
+    uint64_t log_size   = 2 * (live + size);
+    uint64_t file_size  = 0;
+    uint64_t rsize      = 0;
+    char *tmp           = NULL;
+    int rv              = 0;
+
+    while ((table_size - (table_size / 4)) < (2 * (m->count + 1))) {
+        table_size *= 2;
+    }
+    if (log_size < HASHMAP_FILE_MIN_LOG) {
+        log_size = HASHMAP_FILE_MIN_LOG;
+    }
+    file_size = HASHMAP_FILE_HEADER_SIZE + table_size * sizeof(uint64_t) + log_size;
+    file_size = (file_size + HASHMAP_FILE_HEADER_SIZE - 1)
+                & ~((uint64_t) HASHMAP_FILE_HEADER_SIZE - 1);
+
+    tmp = cu_malloc(strlen(m->path) + sizeof(".tmp"));
+    if (!tmp) {
+        return -2;
+    }
+    strcpy(tmp, m->path);
+    strcat(tmp, ".tmp");
+
+    memset(&n, 0, sizeof(hashmap_file_t));
+    n.fd = open(tmp, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (n.fd < 0) {
+        cu_free(tmp);
+        return -4;
+    }
+
+    rv = hashmap_file_init_helper(&n, table_size, file_size);
+    if (!rv) {
+        uint64_t *index = hashmap_file_index(&n);
+
+        for (uint64_t off = hashmap_file_log_start(m); off < m->log_end; off += rsize) {
+            const struct hashmap_file_record *r = hashmap_file_record(m, off);
+            uint64_t slot                       = 0;
+
+            rsize = hashmap_file_record_size(r->key_len, r->value_len);
+
+            if ((HASHMAP_FILE_PUT == r->type) && hashmap_file_live_helper(m, off)) {
+                hashmap_file_find_helper(&n, r + 1, (size_t) r->key_len, &slot);
+                memcpy(n.base + n.log_end, r, (size_t) rsize);
+                index[slot] = n.log_end;
+                n.log_end += rsize;
+                n.used++;
+                n.count++;
+            }
+        }
+
+        n.dirty = 1;
+        rv      = hashmap_file_sync(&n);
+    }
+
+    if (!rv && (0 != rename(tmp, m->path))) {
+        rv = -4;
+    }
+
+    if (rv) {
+        hashmap_file_unmap(&n);
+        unlink(tmp);
+        cu_free(tmp);
+        return rv;
+    }
+    cu_free(tmp);
+
+    /* Swap the new file in, keeping the path.  It is in place even if the
+     * directory sync fails, so the map follows it either way. */
+    n.path = m->path;
+    m->path = NULL;
+    hashmap_file_unmap(m);
+    *m = n;
+
+    return hashmap_file_sync_dir_helper(m->path);
+}
+
+
+/*
+ * Finds the index slot of a key.  If the key is not there, out_slot is the
+ * slot it should go in, or UINT64_MAX if the index is full.
+ */
+static int hashmap_file_find_helper(const hashmap_file_t *const m,
+                                    const void *key, const size_t len,
+                                    uint64_t *const out_slot)
+{
+    const uint64_t *index = hashmap_file_index(m);
+    uint64_t mask         = m->table_size - 1;
+    uint64_t free_slot    = UINT64_MAX;
+    uint64_t curr         = hashmap_fnv1a64_helper((const char *) key, len);
+
+    /* Murmur3's fmix64, so the low bits depend on all of the key. */
+    curr ^= curr >> 33;
+    curr *= 0xff51afd7ed558ccdULL;
+    curr ^= curr >> 33;
+    curr *= 0xc4ceb9fe1a85ec53ULL;
+    curr ^= curr >> 33;
+
+    curr &= mask;
+    for (uint64_t i = 0; i < m->table_size; i++) {
+        uint64_t off = index[curr];
+
+        if (HASHMAP_FILE_EMPTY == off) {
+            if (UINT64_MAX == free_slot) {
+                free_slot = curr;
+            }
+            break;
+        }
+
+        if (HASHMAP_FILE_REMOVED == off) {
+            if (UINT64_MAX == free_slot) {
+                free_slot = curr;
+            }
+        } else {
+            const struct hashmap_file_record *r = hashmap_file_record(m, off);
+
+            if ((r->key_len == len) && (!len || (0 == memcmp(r + 1, key, len)))) {
+                *out_slot = curr;
+                return 1;
+            }
+        }
+
+        curr = (curr + 1) & mask;
+    }
+
+    *out_slot = free_slot;
+
+    return 0;
+}
+
+
+/*
+ * Checks that a whole record, key and value included, starts at off and ends
+ * before the end of the log.
+ */
+static int hashmap_file_fits_helper(const hashmap_file_t *const m,
+                                    const uint64_t off)
+{
+    const struct hashmap_file_record *r = NULL;
+    uint64_t room                       = 0;
+
+    if ((m->log_end <= off)
+        || ((m->log_end - off) < sizeof(struct hashmap_file_record)))
+    {
+        return 0;
+    }
+
+    r    = hashmap_file_record(m, off);
+    room = m->log_end - off - sizeof(struct hashmap_file_record);
+    if ((room < r->key_len) || ((room - r->key_len) < r->value_len)) {
+        return 0;
+    }
+
+    return hashmap_file_record_size(r->key_len, r->value_len) <= (m->log_end - off);
+}
+
+
+/*
+ * A put record is live if the index still points at it.
+ */
+static int hashmap_file_live_helper(const hashmap_file_t *const m,
+                                    const uint64_t off)
+{
+    const struct hashmap_file_record *r = hashmap_file_record(m, off);
+    uint64_t slot                       = 0;
+
+    if (hashmap_file_find_helper(m, r + 1, (size_t) r->key_len, &slot)) {
+        return hashmap_file_index(m)[slot] == off;
+    }
+
+    return 0;
+}
+
+
+/*
+ * Appends a record to the log, which must have room for it.
+ */
+static uint64_t hashmap_file_append_helper(hashmap_file_t *const m,
+                                           const uint32_t type,
+                                           const void *key, const size_t key_len,
+                                           const void *value,
+                                           const size_t value_len)
+{
+    struct hashmap_file_record *r = hashmap_file_record(m, m->log_end);
+    uint8_t *p                    = (uint8_t *) (r + 1);
+    uint64_t off                  = m->log_end;
+    uint64_t size                 = hashmap_file_record_size(key_len, value_len);
+
+    r->type      = type;
+    r->key_len   = key_len;
+    r->value_len = value_len;
+    if (key_len) {
+        memcpy(p, key, key_len);
+    }
+    if (value_len) {
+        memcpy(p + key_len, value, value_len);
+    }
+    memset(p + key_len + value_len, 0,
+           (size_t) (size - sizeof(struct hashmap_file_record) - key_len - value_len));
+    r->crc = hashmap_file_record_crc(r);
+
+    m->log_end += size;
+
+    return off;
+}
+
+
+static uint32_t hashmap_file_record_crc(const struct hashmap_file_record *const r)
+{
+    size_t len = sizeof(struct hashmap_file_record) - sizeof(r->crc)
+                 + (size_t) r->key_len + (size_t) r->value_len;
+
+    return hashmap_crc32_helper((const char *) &r->type, len);
+}
+
+
+static uint64_t hashmap_file_record_size(const uint64_t key_len,
+                                         const uint64_t value_len)
+{
+    return (sizeof(struct hashmap_file_record) + key_len + value_len + 7)
+           & ~((uint64_t) 7);
+}
+
+
+static uint64_t hashmap_file_log_start(const hashmap_file_t *const m)
+{
+    return HASHMAP_FILE_HEADER_SIZE + m->table_size * sizeof(uint64_t);
+}
+
+
+static uint64_t *hashmap_file_index(const hashmap_file_t *const m)
+{
+    return (uint64_t *) (m->base + HASHMAP_FILE_HEADER_SIZE);
+}
+
+
+static struct hashmap_file_record *hashmap_file_record(const hashmap_file_t *const m,
+                                                       const uint64_t off)
+{
+    return (struct hashmap_file_record *) (m->base + off);
+}
+
+
+static void hashmap_file_unmap(hashmap_file_t *const m)
+{
+    if (m->base) {
+        munmap(m->base, m->map_size);
+    }
+    if (0 <= m->fd) {
+        close(m->fd);
+    }
+    cu_free(m->path);
+    memset(m, 0, sizeof(hashmap_file_t));
+    m->fd = -1;
+}
+
+
+/*
+ * Syncs the directory holding path, so a file created or renamed there is
+ * still there after a crash.
+ */
+static int hashmap_file_sync_dir_helper(const char *const path)
+{
+    const char *slash = strrchr(path, '/');
+    char *dir         = NULL;
+    int fd            = -1;
+    int rv            = 0;
+
+    if (!slash) {
+        dir = cu_strdup(".");
+    } else if (slash == path) {
+        dir = cu_strdup("/");
+    } else {
+        dir = cu_strndup(path, (size_t) (slash - path));
+    }
+    if (!dir) {
+        return -2;
+    }
+
+    fd = open(dir, O_RDONLY | O_DIRECTORY);
+    if ((fd < 0) || (0 != fsync(fd))) {
+        rv = -4;
+    }
+    if (0 <= fd) {
+        close(fd);
+    }
+    cu_free(dir);
+
+    return rv;
+}
@@ -0,0 +1,272 @@
+/* SPDX-FileCopyrightText: 2026 Comcast Cable Communications Management, LLC */
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "alloc.h"
+#include "hex.h"
+
+/*----------------------------------------------------------------------------*/
+/*                                   Macros                                   */
+/*----------------------------------------------------------------------------*/
+
+/* The options that are not the separator. */
+#define HEX_FLAGS (CU_HEX_UPPER | CU_HEX_PROVIDED)
+
+/* Used to build the lookup tables at compile time. */
+#define HEX_CHAR(x, a) (((x) < 10) ? '0' + (x) : (a) + ((x) - 10))
+
+#define HEX_PAIR(i, a) { HEX_CHAR((i) >> 4, a), HEX_CHAR((i) & 0x0f, a) }
+
+/* Invalid characters set 0x100, which valid ones never touch. */
+#define HEX_VAL(c, unused)                             \
+    ((('0' <= (c)) && ((c) <= '9'))   ? (c) - '0'      \
+     : (('a' <= (c)) && ((c) <= 'f')) ? (c) - 'a' + 10 \
+     : (('A' <= (c)) && ((c) <= 'F')) ? (c) - 'A' + 10 \
+                                      : 0x100)
+
+#define REP4(M, i, ...)                                            \
+    M((i), __VA_ARGS__), M((i) + 1, __VA_ARGS__),                  \
+        M((i) + 2, __VA_ARGS__), M((i) + 3, __VA_ARGS__)
+#define REP16(M, i, ...)                                           \
+    REP4(M, (i), __VA_ARGS__), REP4(M, (i) + 4, __VA_ARGS__),      \
+        REP4(M, (i) + 8, __VA_ARGS__), REP4(M, (i) + 12, __VA_ARGS__)
+#define REP64(M, i, ...)                                           \
+    REP16(M, (i), __VA_ARGS__), REP16(M, (i) + 16, __VA_ARGS__),   \
+        REP16(M, (i) + 32, __VA_ARGS__), REP16(M, (i) + 48, __VA_ARGS__)
+#define REP256(M, i, ...)                                          \
+    REP64(M, (i), __VA_ARGS__), REP64(M, (i) + 64, __VA_ARGS__),   \
+        REP64(M, (i) + 128, __VA_ARGS__), REP64(M, (i) + 192, __VA_ARGS__)
+
+/*----------------------------------------------------------------------------*/
+/*                            File Scoped Variables                           */
+/*----------------------------------------------------------------------------*/
+// clang-format off
+
+/* The 2 characters for each byte, lower then upper case. */
+static const char hex_pairs[2][256][2] = {
+    { REP256(HEX_PAIR, 0, 'a') },
+    { REP256(HEX_PAIR, 0, 'A') },
+};
+
+/* The value of each character, or 0x100 if it is not valid. */
+static const uint16_t hex_vals[256] = { REP256(HEX_VAL, 0, 0) };
+
+// clang-format on
+/*----------------------------------------------------------------------------*/
+/*                             Function Prototypes                            */
+/*----------------------------------------------------------------------------*/
+
+extern size_t cu_hex_encode_simd(int upper, const uint8_t *in, size_t len,
+                                 char *out);
+extern size_t cu_hex_decode_simd(const uint8_t *in, size_t len, uint8_t *out);
+
+/*----------------------------------------------------------------------------*/
+/*                             Internal functions                             */
+/*----------------------------------------------------------------------------*/
+
+static int check_args(int opts, const void *in, size_t in_len,
+                      const size_t *out_len)
+{
+    if (!out_len || (~(HEX_FLAGS | CU_HEX_SEP(0xff)) & opts)
+        || (!in && in_len))
+    {
+        return -5;
+    }
+
+    return 0;
+}
+
+
+static void encode(int opts, const uint8_t *in, size_t len, char *out)
+{
+    const char(*pairs)[2] = hex_pairs[CU_HEX_UPPER & opts];
+    char sep              = (char) ((unsigned) opts >> 8);
+    size_t i              = 0;
+
+    if (sep) {
+        for (; i < len; i++) {
+            if (i) {
+                *out++ = sep;
+            }
+            *out++ = pairs[in[i]][0];
+            *out++ = pairs[in[i]][1];
+        }
+        return;
+    }
+
+    i    = cu_hex_encode_simd(CU_HEX_UPPER & opts, in, len, out);
+    out += i * 2;
+
+    for (; i < len; i++) {
+        *out++ = pairs[in[i]][0];
+        *out++ = pairs[in[i]][1];
+    }
+}
+
+
+/* Checks the input, and decodes it if out is not NULL. */
+static int decode(int opts, const uint8_t *in, size_t len, uint8_t *out)
+{
+    char sep     = (char) ((unsigned) opts >> 8);
+    unsigned err = 0;
+    size_t i     = 0;
+
+    if (sep) {
+        for (size_t j = 0; i < len; i += 3, j++) {
+            unsigned v = (unsigned) (hex_vals[in[i]] << 4) | hex_vals[in[i + 1]];
+
+            if ((i + 2 < len) && ((char) in[i + 2] != sep)) {
+                return -1;
+            }
+            err |= v;
+            if (out) {
+                out[j] = (uint8_t) v;
+            }
+        }
+
+        return (0x1100 & err) ? -1 : 0;
+    }
+
+    if (out) {
+        i    = cu_hex_decode_simd(in, len, out);
+        out += i / 2;
+    }
+
+    for (; i < len; i += 2) {
+        unsigned v = (unsigned) (hex_vals[in[i]] << 4) | hex_vals[in[i + 1]];
+
+        err |= v;
+        if (out) {
+            *out++ = (uint8_t) v;
+        }
+    }
+
+    return (0x1100 & err) ? -1 : 0;
+}
+
+/*----------------------------------------------------------------------------*/
+/*                             External Functions                             */
+/*----------------------------------------------------------------------------*/
+
+
+int cu_hex_encode(int opts, const void *in, size_t in_len,
+                  char **out, size_t *out_len)
+{
+    size_t len = 0;
+    char *buf  = NULL;
+    int rv     = check_args(opts, in, in_len, out_len);
+
+    if (rv) {
+        if (out_len) {
+            *out_len = 0;
+        }
+        return rv;
+    }
+
+    /* Like b64_encode(), empty input is not allocated. */
+    if (!in_len) {
+        if (out && !(CU_HEX_PROVIDED & opts)) {
+            *out = NULL;
+        }
+        *out_len = 0;
+        return 0;
+    }
+
+    if (in_len > (SIZE_MAX - 1) / 3) {
+        *out_len = 0;
+        return -2;
+    }
+
+    len = CU_HEX_ENCODED_LEN(opts, in_len);
+
+    if (out) {
+        if (CU_HEX_PROVIDED & opts) {
+            if (*out_len < len) {
+                *out_len = 0;
+                return -3;
+            }
+            buf = *out;
+        } else {
+            buf = cu_malloc(len + 1);
+            if (!buf) {
+                *out_len = 0;
+                return -4;
+            }
+            buf[len] = '\0';
+            *out     = buf;
+        }
+
+        encode(opts, (const uint8_t *) in, in_len, buf);
+    }
+
+    *out_len = len;
+
+    return 0;
+}
+
+
+int cu_hex_decode(int opts, const void *in, size_t in_len,
+                  void **out, size_t *out_len)
+{
+    size_t len   = 0;
+    uint8_t *buf = NULL;
+    int rv       = check_args(opts, in, in_len, out_len);
+
+    if (rv) {
+        if (out_len) {
+            *out_len = 0;
+        }
+        return rv;
+    }
+
+    if (!in_len) {
+        if (out && !(CU_HEX_PROVIDED & opts)) {
+            *out = NULL;
+        }
+        *out_len = 0;
+        return 0;
+    }
+
+    if (((unsigned) opts >> 8) ? (2 != in_len % 3) : (in_len % 2)) {
+        *out_len = 0;
+        return -2;
+    }
+
+    len = CU_HEX_DECODED_LEN(opts, in_len);
+
+    if (out) {
+        if (CU_HEX_PROVIDED & opts) {
+            if (*out_len < len) {
+                *out_len = 0;
+                return -3;
+            }
+            buf = *out;
+        } else {
+            buf = cu_malloc(len + 1);
+            if (!buf) {
+                *out_len = 0;
+                return -4;
+            }
+            buf[len] = '\0';
+        }
+    }
+
+    rv = decode(opts, (const uint8_t *) in, in_len, buf);
+    if (rv) {
+        if (buf && !(CU_HEX_PROVIDED & opts)) {
+            cu_free(buf);
+        }
+        *out_len = 0;
+        return rv;
+    }
+
+    if (buf && !(CU_HEX_PROVIDED & opts)) {
+        *out = buf;
+    }
+    *out_len = len;
+
+    return 0;
+}
@@ -0,0 +1,291 @@
+/* SPDX-FileCopyrightText: 2026 Comcast Cable Communications Management, LLC */
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*----------------------------------------------------------------------------*/
+/*                                   Macros                                   */
+/*----------------------------------------------------------------------------*/
+
+/* The kernels need x86 and the GCC/clang target attribute, everything else
+ * uses the scalar code in hex.c. */
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define HEX_X86 1
+#include <immintrin.h>
+#endif
+
+/* The same levels cu_simd_level() returns. */
+#define HEX_SIMD_NONE  0
+#define HEX_SIMD_SSSE3 1
+#define HEX_SIMD_AVX2  2
+
+/* The highest kernel to use, even if the CPU supports more.  Overridable so
+ * every kernel can be tested on a CPU that supports them all. */
+#ifndef HEX_SIMD_MAX_LEVEL
+#define HEX_SIMD_MAX_LEVEL HEX_SIMD_AVX2
+#endif
+
+/*----------------------------------------------------------------------------*/
+/*                            Function Prototypes                             */
+/*----------------------------------------------------------------------------*/
+
+extern int cu_simd_level(void);
+
+extern size_t cu_hex_encode_simd(int upper, const uint8_t *in, size_t len,
+                                 char *out);
+extern size_t cu_hex_decode_simd(const uint8_t *in, size_t len, uint8_t *out);
+
+/*----------------------------------------------------------------------------*/
+/*                             Internal functions                             */
+/*----------------------------------------------------------------------------*/
+#ifdef HEX_X86
+
+/* The CPU's level from cu_simd_level(), capped at HEX_SIMD_MAX_LEVEL. */
+static int simd_level(void)
+{
+    int l = cu_simd_level();
+
+    if (HEX_SIMD_MAX_LEVEL < l) {
+        l = HEX_SIMD_MAX_LEVEL;
+    }
+
+    return l;
+}
+
+
+/* Returns the 16 digits as a shuffle table. */
+__attribute__((target("ssse3")))
+static __m128i enc_digits(int upper)
+{
+    return upper ? _mm_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7',
+                                 '8', '9', 'A', 'B', 'C', 'D', 'E', 'F')
+                 : _mm_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7',
+                                 '8', '9', 'a', 'b', 'c', 'd', 'e', 'f');
+}
+
+
+/*
+ * Encodes 16 bytes at a time into 32 characters.  Each nibble picks its
+ * digit with a shuffle, then the high and low nibbles are interleaved.
+ * Returns the number of bytes encoded.
+ */
+__attribute__((target("ssse3")))
+static size_t encode_ssse3(int upper, const uint8_t *in, size_t len, char *out)
+{
+    const __m128i digits = enc_digits(upper);
+    const __m128i mask   = _mm_set1_epi8(0x0f);
+    size_t i             = 0;
+
+    while (16 <= (len - i)) {
+        __m128i v  = _mm_loadu_si128((const __m128i *) (in + i));
+        __m128i hi = _mm_shuffle_epi8(digits, _mm_and_si128(_mm_srli_epi16(v, 4), mask));
+        __m128i lo = _mm_shuffle_epi8(digits, _mm_and_si128(v, mask));
+
+        _mm_storeu_si128((__m128i *) (out + i * 2), _mm_unpacklo_epi8(hi, lo));
+        _mm_storeu_si128((__m128i *) (out + i * 2 + 16), _mm_unpackhi_epi8(hi, lo));
+        i += 16;
+    }
+
+    return i;
+}
+
+
+/* The same as encode_ssse3(), but 32 bytes at a time into 64 characters. */
+__attribute__((target("avx2")))
+static size_t encode_avx2(int upper, const uint8_t *in, size_t len, char *out)
+{
+    const __m256i digits = _mm256_broadcastsi128_si256(enc_digits(upper));
+    const __m256i mask   = _mm256_set1_epi8(0x0f);
+    size_t i             = 0;
+
+    while (32 <= (len - i)) {
+        __m256i v  = _mm256_loadu_si256((const __m256i *) (in + i));
+        __m256i hi = _mm256_shuffle_epi8(digits, _mm256_and_si256(_mm256_srli_epi16(v, 4), mask));
+        __m256i lo = _mm256_shuffle_epi8(digits, _mm256_and_si256(v, mask));
+        __m256i a  = _mm256_unpacklo_epi8(hi, lo);
+        __m256i b  = _mm256_unpackhi_epi8(hi, lo);
+
+        /* The unpacks work within each 128 bit lane, so a holds bytes 0-7 and
+         * 16-23 and b holds 8-15 and 24-31. */
+        _mm256_storeu_si256((__m256i *) (out + i * 2), _mm256_permute2x128_si256(a, b, 0x20));
+        _mm256_storeu_si256((__m256i *) (out + i * 2 + 32), _mm256_permute2x128_si256(a, b, 0x31));
+        i += 32;
+    }
+
+    return i;
+}
+
+
+/*
+ * Turns the characters in c into their 4 bit values.  Returns 0 if any of
+ * them are invalid, leaving c unchanged.  The unsigned min compares keep
+ * characters past 0x7f out of both ranges.
+ */
+__attribute__((target("ssse3")))
+static inline int translate_ssse3(__m128i *c)
+{
+    __m128i digit = _mm_sub_epi8(*c, _mm_set1_epi8('0'));
+    __m128i alpha = _mm_sub_epi8(_mm_or_si128(*c, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+    __m128i is_digit, is_alpha;
+
+    is_digit = _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+    is_alpha = _mm_cmpeq_epi8(_mm_min_epu8(alpha, _mm_set1_epi8(5)), alpha);
+
+    if (0xffff != _mm_movemask_epi8(_mm_or_si128(is_digit, is_alpha))) {
+        return 0;
+    }
+
+    *c = _mm_or_si128(_mm_and_si128(is_digit, digit),
+                      _mm_and_si128(is_alpha, _mm_add_epi8(alpha, _mm_set1_epi8(10))));
+
+    return 1;
+}
+
+
+/* The same as translate_ssse3(), but 32 characters. */
+__attribute__((target("avx2")))
+static inline int translate_avx2(__m256i *c)
+{
+    __m256i digit = _mm256_sub_epi8(*c, _mm256_set1_epi8('0'));
+    __m256i alpha = _mm256_sub_epi8(_mm256_or_si256(*c, _mm256_set1_epi8(0x20)),
+                                    _mm256_set1_epi8('a'));
+    __m256i is_digit, is_alpha;
+
+    is_digit = _mm256_cmpeq_epi8(_mm256_min_epu8(digit, _mm256_set1_epi8(9)), digit);
+    is_alpha = _mm256_cmpeq_epi8(_mm256_min_epu8(alpha, _mm256_set1_epi8(5)), alpha);
+
+    if (-1 != _mm256_movemask_epi8(_mm256_or_si256(is_digit, is_alpha))) {
+        return 0;
+    }
+
+    *c = _mm256_or_si256(_mm256_and_si256(is_digit, digit),
+                         _mm256_and_si256(is_alpha,
+                                          _mm256_add_epi8(alpha, _mm256_set1_epi8(10))));
+
+    return 1;
+}
+
+
+/*
+ * Decodes 32 characters at a time into 16 bytes.  The kernels stop at a block
+ * with an invalid character, so the scalar code can find it and report the
+ * error.  Returns the number of characters decoded.
+ */
+__attribute__((target("ssse3")))
+static size_t decode_ssse3(const uint8_t *in, size_t len, uint8_t *out)
+{
+    /* Each pair of values becomes (high * 16 + low) in a 16 bit lane. */
+    const __m128i merge = _mm_set1_epi16(0x0110);
+    size_t i            = 0;
+
+    while (32 <= (len - i)) {
+        __m128i a = _mm_loadu_si128((const __m128i *) (in + i));
+        __m128i b = _mm_loadu_si128((const __m128i *) (in + i + 16));
+
+        if (!translate_ssse3(&a) || !translate_ssse3(&b)) {
+            break;
+        }
+
+        a = _mm_maddubs_epi16(a, merge);
+        b = _mm_maddubs_epi16(b, merge);
+
+        _mm_storeu_si128((__m128i *) (out + i / 2), _mm_packus_epi16(a, b));
+        i += 32;
+    }
+
+    return i;
+}
+
+
+/* The same as decode_ssse3(), but 64 characters at a time into 32 bytes. */
+__attribute__((target("avx2")))
+static size_t decode_avx2(const uint8_t *in, size_t len, uint8_t *out)
+{
+    const __m256i merge = _mm256_set1_epi16(0x0110);
+    size_t i            = 0;
+
+    while (64 <= (len - i)) {
+        __m256i a = _mm256_loadu_si256((const __m256i *) (in + i));
+        __m256i b = _mm256_loadu_si256((const __m256i *) (in + i + 32));
+
+        if (!translate_avx2(&a) || !translate_avx2(&b)) {
+            break;
+        }
+
+        a = _mm256_maddubs_epi16(a, merge);
+        b = _mm256_maddubs_epi16(b, merge);
+
+        /* The pack works within each 128 bit lane, so put the 4 groups of 8
+         * bytes back in order. */
+        a = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xd8);
+
+        _mm256_storeu_si256((__m256i *) (out + i / 2), a);
+        i += 64;
+    }
+
+    return i;
+}
+
+#endif /* HEX_X86 */
+
+/*----------------------------------------------------------------------------*/
+/*                             External Functions                             */
+/*----------------------------------------------------------------------------*/
+
+
+/*
+ * Encodes as much of the input as the best kernel for this CPU can, and
+ * returns how many bytes were encoded.  The caller encodes the rest.
+ */
+extern size_t cu_hex_encode_simd(int upper, const uint8_t *in, size_t len,
+                                 char *out)
+{
+    size_t i = 0;
+
+#ifdef HEX_X86
+    int level = simd_level();
+
+    if (HEX_SIMD_AVX2 <= level) {
+        i = encode_avx2(upper, in, len, out);
+    }
+    if (HEX_SIMD_SSSE3 <= level) {
+        i += encode_ssse3(upper, in + i, len - i, out + i * 2);
+    }
+#else
+    (void) upper;
+    (void) in;
+    (void) len;
+    (void) out;
+#endif
+
+    return i;
+}
+
+
+/*
+ * Decodes as much of the input as the best kernel for this CPU can, and
+ * returns how many characters were decoded (a multiple of 2).  The caller
+ * decodes the rest and reports any error.
+ */
+extern size_t cu_hex_decode_simd(const uint8_t *in, size_t len, uint8_t *out)
+{
+    size_t i = 0;
+
+#ifdef HEX_X86
+    int level = simd_level();
+
+    if (HEX_SIMD_AVX2 <= level) {
+        i = decode_avx2(in, len, out);
+    }
+    if (HEX_SIMD_SSSE3 <= level) {
+        i += decode_ssse3(in + i, len - i, out + i / 2);
+    }
+#else
+    (void) in;
+    (void) len;
+    (void) out;
+#endif
+
+    return i;
+}
@@ -4,6 +4,7 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "alloc.h"
 #include "must.h"
 
 /*----------------------------------------------------------------------------*/
@@ -42,15 +43,15 @@ void *saferealloc(void *ptr, size_t size)
     /* Consistently always return NULL in this case. */
     if (!size) {
         if (ptr) {
-            free(ptr);
+            cu_free(ptr);
         }
         return NULL;
     }
 
-    p = realloc(ptr, size);
+    p = cu_realloc(ptr, size);
 
     if (!p && ptr) {
-        free(ptr);
+        cu_free(ptr);
     }
 
     return p;
@@ -62,7 +63,7 @@ void *memdup(const void *src, size_t len)
     void *dest = NULL;
 
     if (src && len) {
-        dest = malloc(len);
+        dest = cu_malloc(len);
         if (dest) {
             memcpy(dest, src, len);
         }
@@ -74,7 +75,16 @@ void *memdup(const void *src, size_t len)
 
 void *memappend(void **buf, size_t *buf_len, const void *src, size_t len)
 {
-    *buf = saferealloc(*buf, (*buf_len + len));
+    void *grown = NULL;
+
+    /* The same as saferealloc(), but counted against memappend(). */
+    if (*buf_len + len) {
+        grown = CU_REALLOC_(CU_ALLOC_API_MEMAPPEND, *buf, (*buf_len + len));
+    }
+    if (!grown) {
+        CU_FREE_(CU_ALLOC_API_MEMAPPEND, *buf);
+    }
+    *buf = grown;
 
     if (*buf) {
         unsigned char *p = *buf;
@@ -94,7 +104,7 @@ void *memappend(void **buf, size_t *buf_len, const void *src, size_t len)
 
 void *must_calloc(size_t nmemb, size_t size)
 {
-    return must(calloc(nmemb, size));
+    return must(cu_calloc(nmemb, size));
 }
 
 
@@ -104,12 +114,12 @@ void *must_realloc(void *ptr, size_t size)
 
     if (!size) {
         if (ptr) {
-            free(ptr);
+            cu_free(ptr);
         }
         return NULL;
     }
 
-    p = must(realloc(ptr, size));
+    p = must(cu_realloc(ptr, size));
 
     return p;
 }
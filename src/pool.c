@@ -0,0 +1,490 @@
+/* SPDX-FileCopyrightText: 2026 Comcast Cable Communications Management, LLC */
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "alloc.h"
+#include "must.h"
+#include "pool.h"
+
+/*----------------------------------------------------------------------------*/
+/*                                   Macros                                   */
+/*----------------------------------------------------------------------------*/
+
+/* Objects are aligned like malloc() results, and slabs hold at least
+ * POOL_MIN_OBJS objects. */
+#define POOL_ALIGN     (2 * sizeof(void *))
+#define POOL_SLAB_SIZE (4096)
+#define POOL_MIN_OBJS  (8)
+
+/* The most objects a thread caches.  Half of them move to or from the
+ * shared free list at once. */
+#define POOL_MAG_SIZE (64)
+
+/* Counters only written by their own thread, but read by others. */
+#define COUNTER_INC(c) __atomic_store_n(&(c), (c) + 1, __ATOMIC_RELAXED)
+#define COUNTER_GET(c) __atomic_load_n(&(c), __ATOMIC_RELAXED)
+
+/*----------------------------------------------------------------------------*/
+/*                               Data Structures                              */
+/*----------------------------------------------------------------------------*/
+
+/* A free object holds the link to the next one. */
+struct free_obj {
+    struct free_obj *next;
+};
+
+/* The header at the start of each slab, padded to keep the objects after it
+ * aligned. */
+union slab {
+    union slab *next;
+    unsigned char align[POOL_ALIGN];
+};
+
+/* A thread's cache of free objects for one pool.  prev and next link the
+ * pool's magazines, tnext links the thread's.  pool is set to NULL when the
+ * pool is destroyed, and the thread frees the magazine later.  Magazines
+ * come from the cutils allocator, since they may outlive the pool's. */
+struct magazine {
+    cu_pool_t *pool;
+    struct magazine *prev;
+    struct magazine *next;
+    struct magazine *tnext;
+    uint64_t allocs;
+    uint64_t frees;
+    size_t count;
+    void *objs[POOL_MAG_SIZE];
+};
+
+/* The magazines of one thread, most recently used first. */
+struct mag_list {
+    struct magazine *head;
+};
+
+struct cu_pool {
+    size_t obj_size;
+    size_t objs_per_slab;
+    const cu_allocator_t *alloc;
+
+    /* Everything below is protected by lock. */
+    pthread_mutex_t lock;
+    union slab *slabs;
+    size_t slab_count;
+    struct free_obj *free_list;
+    struct magazine *mags;
+
+    /* The counts from magazines that are gone. */
+    uint64_t allocs;
+    uint64_t frees;
+};
+
+/*----------------------------------------------------------------------------*/
+/*                            File Scoped Variables                           */
+/*----------------------------------------------------------------------------*/
+
+/* One key for all pools, so the number of pools is not limited by
+ * PTHREAD_KEYS_MAX.  Each thread's value is a struct mag_list. */
+static pthread_once_t mags_once = PTHREAD_ONCE_INIT;
+static pthread_key_t mags_key;
+static int mags_key_rv = -1;
+
+/* Keeps a thread from giving its magazines back to a pool that is being
+ * destroyed. */
+static pthread_mutex_t mags_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/*----------------------------------------------------------------------------*/
+/*                             Function Prototypes                            */
+/*----------------------------------------------------------------------------*/
+/* none */
+
+/*----------------------------------------------------------------------------*/
+/*                             Internal functions                             */
+/*----------------------------------------------------------------------------*/
+
+/* Adds a slab's objects to the free list.  The lock must be held. */
+static int add_slab(cu_pool_t *p)
+{
+    size_t size      = sizeof(union slab) + p->obj_size * p->objs_per_slab;
+    union slab *s    = cu_malloc_ex(p->alloc, size);
+    unsigned char *o = NULL;
+
+    if (!s) {
+        return -1;
+    }
+
+    s->next  = p->slabs;
+    p->slabs = s;
+    p->slab_count++;
+
+    o = (unsigned char *) (s + 1);
+    for (size_t i = p->objs_per_slab; 0 < i; i--) {
+        struct free_obj *f = (struct free_obj *) &o[(i - 1) * p->obj_size];
+
+        f->next      = p->free_list;
+        p->free_list = f;
+    }
+
+    return 0;
+}
+
+
+/* Moves the magazine's objects down to keep, back to the free list.  The lock
+ * must be held. */
+static void drain(cu_pool_t *p, struct magazine *m, size_t keep)
+{
+    while (keep < m->count) {
+        struct free_obj *f = (struct free_obj *) m->objs[--m->count];
+
+        f->next      = p->free_list;
+        p->free_list = f;
+    }
+}
+
+
+/* Called when a thread exits to give its cached objects back. */
+static void mags_destroy(void *arg)
+{
+    struct mag_list *l = (struct mag_list *) arg;
+
+    pthread_mutex_lock(&mags_lock);
+    for (struct magazine *m = l->head; m; m = m->tnext) {
+        cu_pool_t *p = __atomic_load_n(&m->pool, __ATOMIC_ACQUIRE);
+
+        if (!p) {
+            continue;
+        }
+
+        pthread_mutex_lock(&p->lock);
+        drain(p, m, 0);
+        p->allocs += m->allocs;
+        p->frees += m->frees;
+        if (m->prev) {
+            m->prev->next = m->next;
+        } else {
+            p->mags = m->next;
+        }
+        if (m->next) {
+            m->next->prev = m->prev;
+        }
+        pthread_mutex_unlock(&p->lock);
+    }
+    pthread_mutex_unlock(&mags_lock);
+
+    while (l->head) {
+        struct magazine *m = l->head;
+
+        l->head = m->tnext;
+        cu_free(m);
+    }
+    cu_free(l);
+}
+
+
+static void mags_key_create(void)
+{
+    mags_key_rv = pthread_key_create(&mags_key, mags_destroy);
+}
+
+
+/* Gets the calling thread's list of magazines, creating it if needed. */
+static struct mag_list *get_mags(void)
+{
+    struct mag_list *l = NULL;
+
+    if ((0 != pthread_once(&mags_once, mags_key_create)) || (0 != mags_key_rv)) {
+        return NULL;
+    }
+
+    l = pthread_getspecific(mags_key);
+    if (l) {
+        return l;
+    }
+
+    l = cu_calloc(1, sizeof(struct mag_list));
+    if (!l) {
+        return NULL;
+    }
+
+    if (0 != pthread_setspecific(mags_key, l)) {
+        cu_free(l);
+        return NULL;
+    }
+
+    return l;
+}
+
+
+/* Frees the calling thread's magazines for pools that have been destroyed. */
+static void reap_mags(struct mag_list *l)
+{
+    struct magazine **link = &l->head;
+
+    while (*link) {
+        struct magazine *m = *link;
+
+        if (__atomic_load_n(&m->pool, __ATOMIC_ACQUIRE)) {
+            link = &m->tnext;
+        } else {
+            *link = m->tnext;
+            cu_free(m);
+        }
+    }
+}
+
+
+/* Gets the calling thread's magazine, creating it if needed. */
+static struct magazine *get_mag(cu_pool_t *p)
+{
+    struct mag_list *l = get_mags();
+    struct magazine *m = NULL;
+
+    if (!l) {
+        return NULL;
+    }
+
+    /* Usually a thread keeps using the same pool. */
+    m = l->head;
+    if (m && (p == __atomic_load_n(&m->pool, __ATOMIC_RELAXED))) {
+        return m;
+    }
+
+    /* Otherwise move its magazine to the front, or make one. */
+    reap_mags(l);
+    for (struct magazine **link = &l->head; *link; link = &(*link)->tnext) {
+        if (p == __atomic_load_n(&(*link)->pool, __ATOMIC_RELAXED)) {
+            m        = *link;
+            *link    = m->tnext;
+            m->tnext = l->head;
+            l->head  = m;
+            return m;
+        }
+    }
+
+    m = cu_calloc(1, sizeof(struct magazine));
+    if (!m) {
+        return NULL;
+    }
+    m->pool = p;
+
+    pthread_mutex_lock(&p->lock);
+    m->next = p->mags;
+    if (p->mags) {
+        p->mags->prev = m;
+    }
+    p->mags = m;
+    pthread_mutex_unlock(&p->lock);
+
+    m->tnext = l->head;
+    l->head  = m;
+
+    return m;
+}
+
+/*----------------------------------------------------------------------------*/
+/*                             External Functions                             */
+/*----------------------------------------------------------------------------*/
+
+cu_pool_t *cu_pool_create(size_t obj_size)
+{
+    return cu_pool_create_ex(obj_size, NULL);
+}
+
+
+cu_pool_t *cu_pool_create_ex(size_t obj_size, const cu_allocator_t *alloc)
+{
+    cu_pool_t *p = NULL;
+
+    if (!obj_size || ((SIZE_MAX / 2 / POOL_MIN_OBJS) < obj_size)) {
+        return NULL;
+    }
+
+    p = cu_calloc_ex(alloc, 1, sizeof(cu_pool_t));
+    if (!p) {
+        return NULL;
+    }
+    p->alloc = alloc;
+
+    p->obj_size      = (obj_size + POOL_ALIGN - 1) & ~(POOL_ALIGN - 1);
+    p->objs_per_slab = (POOL_SLAB_SIZE - sizeof(union slab)) / p->obj_size;
+    if (p->objs_per_slab < POOL_MIN_OBJS) {
+        p->objs_per_slab = POOL_MIN_OBJS;
+    }
+
+    if (0 != pthread_mutex_init(&p->lock, NULL)) {
+        cu_free_ex(alloc, p);
+        return NULL;
+    }
+
+    return p;
+}
+
+
+void cu_pool_destroy(cu_pool_t *p)
+{
+    if (!p) {
+        return;
+    }
+
+    /* The magazines belong to their threads, which free them once they see
+     * the pool is gone.  A magazine may be freed as soon as it is let go. */
+    pthread_mutex_lock(&mags_lock);
+    while (p->mags) {
+        struct magazine *m = p->mags;
+
+        p->mags = m->next;
+        __atomic_store_n(&m->pool, NULL, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&mags_lock);
+
+    /* This thread's can go right away. */
+    if ((0 == pthread_once(&mags_once, mags_key_create)) && (0 == mags_key_rv)
+        && pthread_getspecific(mags_key))
+    {
+        reap_mags(pthread_getspecific(mags_key));
+    }
+
+    while (p->slabs) {
+        union slab *s = p->slabs;
+
+        p->slabs = s->next;
+        cu_free_ex(p->alloc, s);
+    }
+
+    pthread_mutex_destroy(&p->lock);
+    cu_free_ex(p->alloc, p);
+}
+
+
+void *cu_pool_alloc(cu_pool_t *p)
+{
+    struct magazine *m = NULL;
+
+    if (!p) {
+        return NULL;
+    }
+
+    m = get_mag(p);
+    if (!m) {
+        return NULL;
+    }
+
+    /* Refill half of the magazine from the shared list. */
+    if (!m->count) {
+        pthread_mutex_lock(&p->lock);
+        while (m->count < (POOL_MAG_SIZE / 2)) {
+            if (!p->free_list && (0 != add_slab(p))) {
+                break;
+            }
+            m->objs[m->count++] = p->free_list;
+            p->free_list        = p->free_list->next;
+        }
+        pthread_mutex_unlock(&p->lock);
+
+        if (!m->count) {
+            return NULL;
+        }
+    }
+
+    COUNTER_INC(m->allocs);
+
+    return m->objs[--m->count];
+}
+
+
+void *cu_pool_calloc(cu_pool_t *p)
+{
+    void *obj = cu_pool_alloc(p);
+
+    if (obj) {
+        memset(obj, 0, p->obj_size);
+    }
+
+    return obj;
+}
+
+
+void cu_pool_free(cu_pool_t *p, void *obj)
+{
+    struct magazine *m = NULL;
+
+    if (!p || !obj) {
+        return;
+    }
+
+    m = get_mag(p);
+    if (!m) {
+        /* No magazine for this thread, so go straight to the shared list. */
+        struct free_obj *f = (struct free_obj *) obj;
+
+        pthread_mutex_lock(&p->lock);
+        f->next      = p->free_list;
+        p->free_list = f;
+        p->frees++;
+        pthread_mutex_unlock(&p->lock);
+        return;
+    }
+
+    if (POOL_MAG_SIZE == m->count) {
+        pthread_mutex_lock(&p->lock);
+        drain(p, m, POOL_MAG_SIZE / 2);
+        pthread_mutex_unlock(&p->lock);
+    }
+
+    m->objs[m->count++] = obj;
+    COUNTER_INC(m->frees);
+}
+
+
+int cu_pool_stats(cu_pool_t *p, cu_pool_stats_t *stats)
+{
+    if (!p || !stats) {
+        return -1;
+    }
+
+    memset(stats, 0, sizeof(cu_pool_stats_t));
+
+    pthread_mutex_lock(&p->lock);
+    stats->obj_size = p->obj_size;
+    stats->slabs    = p->slab_count;
+    stats->capacity = p->slab_count * p->objs_per_slab;
+    stats->allocs   = p->allocs;
+    stats->frees    = p->frees;
+    for (struct magazine *m = p->mags; m; m = m->next) {
+        stats->allocs += COUNTER_GET(m->allocs);
+        stats->frees += COUNTER_GET(m->frees);
+    }
+    pthread_mutex_unlock(&p->lock);
+
+    if (stats->frees < stats->allocs) {
+        stats->in_use = (size_t) (stats->allocs - stats->frees);
+    }
+
+    return 0;
+}
+
+
+/*-- Must versions -----------------------------------------------------------*/
+
+
+cu_pool_t *cu_must_pool_create(size_t obj_size)
+{
+    return must(cu_pool_create(obj_size));
+}
+
+
+void *cu_must_pool_alloc(cu_pool_t *p)
+{
+    return must(cu_pool_alloc(p));
+}
+
+
+void *cu_must_pool_calloc(cu_pool_t *p)
+{
+    return must(cu_pool_calloc(p));
+}
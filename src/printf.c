@@ -5,6 +5,7 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "alloc.h"
 #include "must.h"
 #include "printf.h"
 
@@ -84,12 +85,12 @@ char *mlvaprintf(size_t *len, const char *format, va_list args)
     va_end(copy);
     if (0 < l) {
 
-        buf = malloc(l + 1);
+        buf = CU_MALLOC_(CU_ALLOC_API_MAPRINTF, l + 1);
         if (buf) {
             int rv = vsprintf(buf, format, args);
 
             if (rv != l) {
-                free(buf);
+                CU_FREE_(CU_ALLOC_API_MAPRINTF, buf);
                 buf = NULL;
                 l   = 0;
             }
@@ -0,0 +1,69 @@
+/* SPDX-FileCopyrightText: 2026 Comcast Cable Communications Management, LLC */
+/* SPDX-License-Identifier: Apache-2.0 */
+
+/*----------------------------------------------------------------------------*/
+/*                                   Macros                                   */
+/*----------------------------------------------------------------------------*/
+
+/* CPU detection needs x86 and the GCC/clang builtins. */
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define SIMD_X86 1
+#endif
+
+/* The levels returned, which the codecs' own level macros match. */
+#define SIMD_NONE  0
+#define SIMD_SSSE3 1
+#define SIMD_AVX2  2
+
+/*----------------------------------------------------------------------------*/
+/*                               Data Structures                              */
+/*----------------------------------------------------------------------------*/
+/* none */
+
+/*----------------------------------------------------------------------------*/
+/*                            File Scoped Variables                           */
+/*----------------------------------------------------------------------------*/
+/* none */
+
+/*----------------------------------------------------------------------------*/
+/*                             Function Prototypes                            */
+/*----------------------------------------------------------------------------*/
+
+extern int cu_simd_level(void);
+
+/*----------------------------------------------------------------------------*/
+/*                             Internal functions                             */
+/*----------------------------------------------------------------------------*/
+/* none */
+
+/*----------------------------------------------------------------------------*/
+/*                             External Functions                             */
+/*----------------------------------------------------------------------------*/
+
+/* Returns the best vector instruction set the CPU supports, shared by the
+ * base64 and hex kernels.  It is only looked up once. */
+int cu_simd_level(void)
+{
+#ifdef SIMD_X86
+    static int level = -1;
+    int l            = __atomic_load_n(&level, __ATOMIC_RELAXED);
+
+    if (l < 0) {
+        l = SIMD_NONE;
+
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("ssse3")) {
+            l = SIMD_SSSE3;
+        }
+        if (__builtin_cpu_supports("avx2")) {
+            l = SIMD_AVX2;
+        }
+
+        __atomic_store_n(&level, l, __ATOMIC_RELAXED);
+    }
+
+    return l;
+#else
+    return SIMD_NONE;
+#endif
+}
@@ -5,6 +5,7 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "alloc.h"
 #include "must.h"
 #include "nl_strings.h"
 #include "strings.h"
@@ -63,7 +64,7 @@ char *cu_strndup(const char *s, size_t maxlen)
     if (s && (0 < maxlen)) {
         size_t len = cu_strnlen(s, maxlen);
 
-        rv = malloc(len + 1); /* +1 for trailing '\0' */
+        rv = CU_MALLOC_(CU_ALLOC_API_STRNDUP, len + 1); /* +1 for trailing '\0' */
         if (rv) {
             memcpy(rv, s, len);
             rv[len] = '\0';
@@ -0,0 +1,376 @@
+/* SPDX-FileCopyrightText: 2026 Comcast Cable Communications Management, LLC */
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#include <CUnit/Basic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "alloc.h"
+#include "arena.h"
+#include "base64.h"
+#include "buf.h"
+#include "hashmap.h"
+#include "hex.h"
+#include "memory.h"
+#include "pool.h"
+#include "printf.h"
+#include "strings.h"
+
+/* Counts the calls and the memory outstanding, and can be told to fail. */
+struct counts {
+    size_t mallocs;
+    size_t reallocs;
+    size_t frees;
+    size_t live;
+    int fail;
+};
+
+/* Each block has a header holding its size so live can be tracked. */
+union header {
+    size_t size;
+    unsigned char align[2 * sizeof(void *)];
+};
+
+
+static void *count_malloc(void *ctx, size_t size)
+{
+    struct counts *c = (struct counts *) ctx;
+    union header *h  = NULL;
+
+    if (c->fail) {
+        return NULL;
+    }
+
+    h = malloc(sizeof(union header) + size);
+    if (!h) {
+        return NULL;
+    }
+    h->size = size;
+    c->mallocs++;
+    c->live++;
+
+    return h + 1;
+}
+
+
+static void *count_realloc(void *ctx, void *ptr, size_t size)
+{
+    struct counts *c = (struct counts *) ctx;
+    union header *h  = NULL;
+
+    if (!ptr) {
+        return count_malloc(ctx, size);
+    }
+    if (c->fail) {
+        return NULL;
+    }
+
+    h = realloc(((union header *) ptr) - 1, sizeof(union header) + size);
+    if (!h) {
+        return NULL;
+    }
+    h->size = size;
+    c->reallocs++;
+
+    return h + 1;
+}
+
+
+static void count_free(void *ctx, void *ptr)
+{
+    struct counts *c = (struct counts *) ctx;
+
+    c->frees++;
+    c->live--;
+    free(((union header *) ptr) - 1);
+}
+
+
+static struct counts counts;
+
+static const cu_allocator_t counter = {
+    .malloc_fn  = count_malloc,
+    .calloc_fn  = NULL,
+    .realloc_fn = count_realloc,
+    .free_fn    = count_free,
+    .ctx        = &counts,
+};
+
+
+void test_set_get(void)
+{
+    cu_allocator_t bad = counter;
+    void *p            = NULL;
+
+    CU_ASSERT(NULL != cu_get_allocator());
+    CU_ASSERT(NULL != cu_get_allocator()->calloc_fn);
+
+    bad.free_fn = NULL;
+    CU_ASSERT(-1 == cu_set_allocator(&bad));
+    bad           = counter;
+    bad.malloc_fn = NULL;
+    CU_ASSERT(-1 == cu_set_allocator(&bad));
+    bad            = counter;
+    bad.realloc_fn = NULL;
+    CU_ASSERT(-1 == cu_set_allocator(&bad));
+
+    memset(&counts, 0, sizeof(counts));
+    CU_ASSERT(0 == cu_set_allocator(&counter));
+    CU_ASSERT(count_malloc == cu_get_allocator()->malloc_fn);
+
+    /* calloc falls back to malloc and zeroing. */
+    p = cu_calloc(10, 10);
+    CU_ASSERT_FATAL(NULL != p);
+    for (size_t i = 0; i < 100; i++) {
+        CU_ASSERT(0 == ((unsigned char *) p)[i]);
+    }
+    CU_ASSERT(NULL == cu_calloc(SIZE_MAX, 2));
+
+    p = cu_realloc(p, 1000);
+    CU_ASSERT_FATAL(NULL != p);
+    cu_free(p);
+    cu_free(NULL);
+
+    CU_ASSERT(1 == counts.mallocs);
+    CU_ASSERT(1 == counts.reallocs);
+    CU_ASSERT(1 == counts.frees);
+    CU_ASSERT(0 == counts.live);
+
+    CU_ASSERT(0 == cu_set_allocator(NULL));
+    CU_ASSERT(count_malloc != cu_get_allocator()->malloc_fn);
+
+    /* Memory from the default allocator works with free(). */
+    p = cu_malloc(10);
+    CU_ASSERT_FATAL(NULL != p);
+    free(p);
+    CU_ASSERT(1 == counts.mallocs);
+}
+
+
+void test_ex(void)
+{
+    cu_arena_t a = { 0 };
+    cu_pool_t *p = NULL;
+    void *m      = NULL;
+
+    memset(&counts, 0, sizeof(counts));
+
+    /* The global allocator is not changed. */
+    m = cu_malloc_ex(&counter, 10);
+    CU_ASSERT_FATAL(NULL != m);
+    m = cu_realloc_ex(&counter, m, 20);
+    CU_ASSERT_FATAL(NULL != m);
+    cu_free_ex(&counter, m);
+    m = cu_calloc_ex(&counter, 2, 2);
+    cu_free_ex(&counter, m);
+    CU_ASSERT(2 == counts.mallocs);
+    CU_ASSERT(0 == counts.live);
+
+    m = cu_malloc_ex(NULL, 10);
+    CU_ASSERT_FATAL(NULL != m);
+    cu_free_ex(NULL, m);
+    CU_ASSERT(2 == counts.mallocs);
+
+    CU_ASSERT(0 == cu_arena_init_ex(&a, 64, &counter));
+    CU_ASSERT(NULL != cu_arena_alloc(&a, 100));
+    CU_ASSERT(NULL != cu_arena_strdup(&a, "arena"));
+    CU_ASSERT(0 < counts.live);
+    cu_arena_destroy(&a);
+    CU_ASSERT(0 == counts.live);
+
+    p = cu_pool_create_ex(32, &counter);
+    CU_ASSERT_FATAL(NULL != p);
+    m = cu_pool_alloc(p);
+    CU_ASSERT(NULL != m);
+    cu_pool_free(p, m);
+    /* The pool and its slab.  The thread's cache comes from the global one. */
+    CU_ASSERT(2 == counts.live);
+    cu_pool_destroy(p);
+    CU_ASSERT(0 == counts.live);
+}
+
+
+void test_routed(void)
+{
+    hashmap_t m = { 0 };
+    cu_buf_t b  = { 0 };
+    char *s     = NULL;
+    void *d     = NULL;
+    size_t len  = 0;
+    size_t n    = 0;
+
+    memset(&counts, 0, sizeof(counts));
+    CU_ASSERT(0 == cu_set_allocator(&counter));
+
+    s = cu_strdup("hello");
+    CU_ASSERT_STRING_EQUAL("hello", s);
+    cu_free(s);
+
+    s = maprintf("%d %s", 12, "ab");
+    CU_ASSERT_STRING_EQUAL("12 ab", s);
+    cu_free(s);
+
+    d = memdup("abc", 3);
+    cu_free(d);
+
+    CU_ASSERT(0 == b64_encode(0, "hello", 5, &s, &len));
+    CU_ASSERT_STRING_EQUAL("aGVsbG8=", s);
+    CU_ASSERT(0 == b64_decode(0, s, len, &d, &len));
+    CU_ASSERT(5 == len);
+    cu_free(s);
+    cu_free(d);
+
+    CU_ASSERT(0 == cu_hex_encode(0, "hi", 2, &s, &len));
+    CU_ASSERT_STRING_EQUAL("6869", s);
+    cu_free(s);
+
+    CU_ASSERT(0 == cu_buf_append(&b, "abc", 3));
+    cu_buf_destroy(&b);
+
+    CU_ASSERT(0 == hashmap_create(0, &m));
+    CU_ASSERT(0 == hashmap_put(&m, "key", 3, &n));
+    hashmap_destroy(&m);
+
+    n = counts.mallocs;
+    CU_ASSERT(8 <= n);
+    CU_ASSERT(0 == counts.live);
+
+    /* Failures from the allocator are reported as usual. */
+    counts.fail = 1;
+    CU_ASSERT(NULL == cu_strdup("hello"));
+    CU_ASSERT(NULL == maprintf("%d", 12));
+    CU_ASSERT(-4 == b64_encode(0, "hello", 5, &s, &len));
+    CU_ASSERT(-2 == cu_buf_append(&b, "abc", 3));
+    counts.fail = 0;
+    CU_ASSERT(n == counts.mallocs);
+
+    CU_ASSERT(0 == cu_set_allocator(NULL));
+}
+
+
+#ifdef CU_ALLOC_STATS
+void test_stats(void)
+{
+    cu_alloc_stats_t st;
+    hashmap_t m = { 0 };
+    void *buf   = NULL;
+    size_t len  = 0;
+    char *s     = NULL;
+    uint64_t n  = 0;
+
+    CU_ASSERT_STRING_EQUAL("maprintf", cu_alloc_api_name(CU_ALLOC_API_MAPRINTF));
+    CU_ASSERT_STRING_EQUAL("hashmap", cu_alloc_api_name(CU_ALLOC_API_HASHMAP));
+    CU_ASSERT(NULL == cu_alloc_api_name(-1));
+    CU_ASSERT(NULL == cu_alloc_api_name(CU_ALLOC_API_COUNT));
+
+    cu_alloc_stats_reset();
+    cu_alloc_stats(&st);
+    for (int i = 0; i < CU_ALLOC_API_COUNT; i++) {
+        CU_ASSERT(0 == st.api[i].allocs);
+        CU_ASSERT(0 == st.api[i].bytes);
+    }
+    cu_alloc_stats(NULL);
+
+    /* 6 bytes, so the 2^3 bucket. */
+    s = maprintf("%s", "12345");
+    cu_free(s);
+    s = cu_strndup("hello world", 5);
+    cu_free(s);
+
+    CU_ASSERT(NULL != memappend(&buf, &len, "abc", 3));
+    CU_ASSERT(NULL != memappend(&buf, &len, "defg", 4));
+    CU_ASSERT(7 == len);
+    cu_free(buf);
+
+    CU_ASSERT(0 == b64_encode(0, "hello", 5, &s, &len));
+    cu_free(s);
+
+    CU_ASSERT(0 == hashmap_create(0, &m));
+    CU_ASSERT(0 == hashmap_put(&m, "key", 3, &n));
+    hashmap_destroy(&m);
+
+    cu_alloc_stats(&st);
+
+    CU_ASSERT(1 == st.api[CU_ALLOC_API_MAPRINTF].allocs);
+    CU_ASSERT(6 == st.api[CU_ALLOC_API_MAPRINTF].bytes);
+    CU_ASSERT(1 == st.api[CU_ALLOC_API_MAPRINTF].hist[3]);
+    CU_ASSERT(0 == st.api[CU_ALLOC_API_MAPRINTF].frees);
+
+    CU_ASSERT(1 == st.api[CU_ALLOC_API_STRNDUP].allocs);
+    CU_ASSERT(6 == st.api[CU_ALLOC_API_STRNDUP].bytes);
+
+    CU_ASSERT(1 == st.api[CU_ALLOC_API_MEMAPPEND].allocs);
+    CU_ASSERT(1 == st.api[CU_ALLOC_API_MEMAPPEND].reallocs);
+    CU_ASSERT(0 == st.api[CU_ALLOC_API_MEMAPPEND].frees);
+    CU_ASSERT(10 == st.api[CU_ALLOC_API_MEMAPPEND].bytes);
+    CU_ASSERT(1 == st.api[CU_ALLOC_API_MEMAPPEND].hist[2]);
+    CU_ASSERT(1 == st.api[CU_ALLOC_API_MEMAPPEND].hist[3]);
+
+    CU_ASSERT(1 == st.api[CU_ALLOC_API_B64].allocs);
+    CU_ASSERT(9 == st.api[CU_ALLOC_API_B64].bytes);
+
+    CU_ASSERT(0 == st.api[CU_ALLOC_API_FREADALL].allocs);
+
+    /* hashmap_destroy() frees everything the hashmap allocated. */
+    n = st.api[CU_ALLOC_API_HASHMAP].allocs;
+    CU_ASSERT(2 <= n);
+    CU_ASSERT(n == st.api[CU_ALLOC_API_HASHMAP].frees);
+
+    n = 0;
+    for (int i = 0; i < CU_ALLOC_HIST_BUCKETS; i++) {
+        n += st.api[CU_ALLOC_API_HASHMAP].hist[i];
+    }
+    CU_ASSERT(n == (st.api[CU_ALLOC_API_HASHMAP].allocs
+                    + st.api[CU_ALLOC_API_HASHMAP].reallocs));
+
+    cu_alloc_stats_reset();
+    cu_alloc_stats(&st);
+    CU_ASSERT(0 == st.api[CU_ALLOC_API_HASHMAP].allocs);
+    CU_ASSERT(0 == st.api[CU_ALLOC_API_HASHMAP].hist[0]);
+}
+#endif
+
+
+void add_suites(CU_pSuite *suite)
+{
+    *suite = CU_add_suite("alloc.c tests", NULL, NULL);
+    CU_add_test(*suite, "Test Set and Get          ", test_set_get);
+    CU_add_test(*suite, "Test Ex Versions          ", test_ex);
+    CU_add_test(*suite, "Test Routed               ", test_routed);
+#ifdef CU_ALLOC_STATS
+    CU_add_test(*suite, "Test Stats                ", test_stats);
+#endif
+}
+
+
+/*----------------------------------------------------------------------------*/
+/*                             External Functions                             */
+/*----------------------------------------------------------------------------*/
+int main(void)
+{
+    unsigned rv     = 1;
+    CU_pSuite suite = NULL;
+
+    if (CUE_SUCCESS == CU_initialize_registry()) {
+        add_suites(&suite);
+
+        if (NULL != suite) {
+            CU_basic_set_mode(CU_BRM_VERBOSE);
+            CU_basic_run_tests();
+            printf("\n");
+            CU_basic_show_failures(CU_get_failure_list());
+            printf("\n\n");
+            rv = CU_get_number_of_tests_failed();
+        }
+
+        CU_cleanup_registry();
+    }
+
+    if (0 != rv) {
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,207 @@
+/* SPDX-FileCopyrightText: 2026 Comcast Cable Communications Management, LLC */
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#include <CUnit/Basic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "arena.h"
+
+
+void test_alloc(void)
+{
+    cu_arena_t a;
+    unsigned char *p[1000];
+
+    CU_ASSERT(-1 == cu_arena_init(NULL, 0));
+    CU_ASSERT_FATAL(0 == cu_arena_init(&a, 256));
+
+    CU_ASSERT(NULL == cu_arena_alloc(&a, 0));
+    CU_ASSERT(NULL == cu_arena_alloc(NULL, 10));
+    CU_ASSERT(NULL == cu_arena_alloc_aligned(&a, 10, 3));
+    CU_ASSERT(NULL == cu_arena_alloc_aligned(&a, 10, 0));
+    CU_ASSERT(NULL == cu_arena_alloc(&a, SIZE_MAX));
+
+    /* Every allocation is aligned and none of them overlap. */
+    for (size_t i = 0; i < 1000; i++) {
+        p[i] = cu_arena_alloc(&a, 1 + (i % 50));
+        CU_ASSERT_FATAL(NULL != p[i]);
+        CU_ASSERT(0 == ((uintptr_t) p[i] % CU_ARENA_ALIGN));
+        memset(p[i], (int) (i & 0xff), 1 + (i % 50));
+    }
+    for (size_t i = 0; i < 1000; i++) {
+        for (size_t j = 0; j < 1 + (i % 50); j++) {
+            CU_ASSERT(p[i][j] == (unsigned char) (i & 0xff));
+        }
+    }
+
+    for (size_t align = 1; align <= 4096; align *= 2) {
+        void *q = cu_arena_alloc_aligned(&a, 3, align);
+
+        CU_ASSERT_FATAL(NULL != q);
+        CU_ASSERT(0 == ((uintptr_t) q % align));
+    }
+
+    /* Larger than a chunk. */
+    p[0] = cu_arena_alloc(&a, 10000);
+    CU_ASSERT_FATAL(NULL != p[0]);
+    memset(p[0], 1, 10000);
+
+    p[0] = cu_arena_calloc(&a, 100, 7);
+    CU_ASSERT_FATAL(NULL != p[0]);
+    for (size_t i = 0; i < 700; i++) {
+        CU_ASSERT(0 == p[0][i]);
+    }
+    CU_ASSERT(NULL == cu_arena_calloc(&a, SIZE_MAX, 2));
+
+    cu_arena_destroy(&a);
+    cu_arena_destroy(&a);
+    cu_arena_destroy(NULL);
+
+    /* A zeroed arena works too. */
+    memset(&a, 0, sizeof(a));
+    CU_ASSERT(NULL != cu_arena_alloc(&a, 5000));
+    cu_arena_destroy(&a);
+}
+
+
+void test_strings(void)
+{
+    cu_arena_t a = { 0 };
+    char *s      = NULL;
+
+    s = cu_arena_strdup(&a, "hello");
+    CU_ASSERT_STRING_EQUAL("hello", s);
+    s = cu_arena_strndup(&a, "hello", 3);
+    CU_ASSERT_STRING_EQUAL("hel", s);
+    CU_ASSERT(NULL == cu_arena_strdup(&a, NULL));
+    CU_ASSERT(NULL == cu_arena_strndup(&a, "hello", 0));
+
+    s = cu_arena_memdup(&a, "abc", 3);
+    CU_ASSERT_NSTRING_EQUAL("abc", s, 3);
+    CU_ASSERT(NULL == cu_arena_memdup(&a, "abc", 0));
+    CU_ASSERT(NULL == cu_arena_memdup(&a, NULL, 3));
+
+    s = cu_arena_aprintf(&a, "%s-%d", "x", 42);
+    CU_ASSERT_STRING_EQUAL("x-42", s);
+    s = cu_arena_aprintf(&a, "%s", "");
+    CU_ASSERT_STRING_EQUAL("", s);
+    CU_ASSERT(NULL == cu_arena_aprintf(&a, NULL));
+
+    s = cu_must_arena_strdup(&a, "must");
+    CU_ASSERT_STRING_EQUAL("must", s);
+    s = cu_must_arena_strndup(&a, "must", 2);
+    CU_ASSERT_STRING_EQUAL("mu", s);
+    s = cu_must_arena_aprintf(&a, "%d", 7);
+    CU_ASSERT_STRING_EQUAL("7", s);
+    s = cu_must_arena_memdup(&a, "xyz", 3);
+    CU_ASSERT_NSTRING_EQUAL("xyz", s, 3);
+    CU_ASSERT(NULL != cu_must_arena_alloc(&a, 8));
+    CU_ASSERT(NULL != cu_must_arena_alloc_aligned(&a, 8, 64));
+    CU_ASSERT(NULL != cu_must_arena_calloc(&a, 2, 8));
+
+    /* No input or no size is not a failure. */
+    CU_ASSERT(NULL == cu_must_arena_alloc(&a, 0));
+    CU_ASSERT(NULL == cu_must_arena_calloc(&a, 0, 8));
+    CU_ASSERT(NULL == cu_must_arena_memdup(&a, NULL, 3));
+    CU_ASSERT(NULL == cu_must_arena_strdup(&a, NULL));
+    CU_ASSERT(NULL == cu_must_arena_aprintf(&a, NULL));
+
+    cu_arena_destroy(&a);
+}
+
+
+void test_mark_reset(void)
+{
+    cu_arena_t a;
+    cu_arena_mark_t m;
+    char *keep = NULL;
+    char *p    = NULL;
+    char *q    = NULL;
+
+    CU_ASSERT_FATAL(0 == cu_arena_init(&a, 128));
+
+    /* A mark on an empty arena. */
+    m = cu_arena_mark(&a);
+    p = cu_arena_strdup(&a, "first");
+    cu_arena_rewind(&a, m);
+    q = cu_arena_strdup(&a, "again");
+    CU_ASSERT(p == q);
+
+    keep = cu_arena_strdup(&a, "keep");
+    m    = cu_arena_mark(&a);
+    p    = cu_arena_alloc(&a, 16);
+
+    /* Spill over several chunks, then go back. */
+    for (int i = 0; i < 100; i++) {
+        CU_ASSERT_FATAL(NULL != cu_arena_alloc(&a, 50));
+    }
+    cu_arena_rewind(&a, m);
+    CU_ASSERT(p == cu_arena_alloc(&a, 16));
+    CU_ASSERT_STRING_EQUAL("keep", keep);
+
+    /* The chunks are reused after a reset. */
+    for (int i = 0; i < 100; i++) {
+        CU_ASSERT_FATAL(NULL != cu_arena_alloc(&a, 50));
+    }
+    cu_arena_reset(&a);
+    p = cu_arena_strdup(&a, "again");
+    CU_ASSERT(p == q);
+
+    /* A larger allocation than the reused chunk holds. */
+    p = cu_arena_alloc(&a, 1000);
+    CU_ASSERT_FATAL(NULL != p);
+    memset(p, 0, 1000);
+    for (int i = 0; i < 100; i++) {
+        CU_ASSERT_FATAL(NULL != cu_arena_alloc(&a, 50));
+    }
+
+    cu_arena_reset(NULL);
+    cu_arena_rewind(NULL, m);
+    m = cu_arena_mark(NULL);
+    CU_ASSERT(NULL == m.chunk);
+
+    cu_arena_destroy(&a);
+}
+
+
+void add_suites(CU_pSuite *suite)
+{
+    *suite = CU_add_suite("arena.c tests", NULL, NULL);
+    CU_add_test(*suite, "Test Allocation           ", test_alloc);
+    CU_add_test(*suite, "Test Strings              ", test_strings);
+    CU_add_test(*suite, "Test Mark and Reset       ", test_mark_reset);
+}
+
+
+/*----------------------------------------------------------------------------*/
+/*                             External Functions                             */
+/*----------------------------------------------------------------------------*/
+int main(void)
+{
+    unsigned rv     = 1;
+    CU_pSuite suite = NULL;
+
+    if (CUE_SUCCESS == CU_initialize_registry()) {
+        add_suites(&suite);
+
+        if (NULL != suite) {
+            CU_basic_set_mode(CU_BRM_VERBOSE);
+            CU_basic_run_tests();
+            printf("\n");
+            CU_basic_show_failures(CU_get_failure_list());
+            printf("\n\n");
+            rv = CU_get_number_of_tests_failed();
+        }
+
+        CU_cleanup_registry();
+    }
+
+    if (0 != rv) {
+        return 1;
+    }
+
+    return 0;
+}
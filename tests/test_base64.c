@@ -1,10 +1,12 @@
 /* SPDX-FileCopyrightText: 2016-2022 Comcast Cable Communications Management, LLC */
 /* SPDX-License-Identifier: Apache-2.0 */
+#define _POSIX_C_SOURCE 200809L
 
 #include <CUnit/Basic.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
 #include "base64.h"
 #include "memory.h"
@@ -531,6 +533,988 @@ void test_encode()
     }
 }
 
+/* A simple reference encoder to check the long inputs against. */
+static size_t ref_encode(int opts, const uint8_t *in, size_t len, char *out)
+{
+    const char *map = (B64_URL == opts)
+                          ? "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_"
+                          : "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    size_t j = 0;
+
+    for (size_t i = 0; i < len; i += 3) {
+        uint32_t v = (uint32_t) in[i] << 16;
+        size_t n   = len - i;
+
+        if (1 < n) {
+            v |= (uint32_t) in[i + 1] << 8;
+        }
+        if (2 < n) {
+            v |= in[i + 2];
+        }
+
+        out[j++] = map[0x3f & (v >> 18)];
+        out[j++] = map[0x3f & (v >> 12)];
+        if (1 < n) {
+            out[j++] = map[0x3f & (v >> 6)];
+        } else if (B64_STD == opts) {
+            out[j++] = '=';
+        }
+        if (2 < n) {
+            out[j++] = map[0x3f & v];
+        } else if (B64_STD == opts) {
+            out[j++] = '=';
+        }
+    }
+
+    return j;
+}
+
+
+void test_encode_long()
+{
+    uint8_t in[301];
+    char expect[404];
+    uint32_t seed = 1;
+    int opts[]    = { B64_STD, B64_URL };
+
+    for (size_t i = 0; i < sizeof(in); i++) {
+        seed  = seed * 1103515245 + 12345;
+        in[i] = (uint8_t) (seed >> 16);
+    }
+
+    /* Every length, so every split between the SIMD and scalar code runs. */
+    for (size_t o = 0; o < 2; o++) {
+        for (size_t len = 0; len < sizeof(in); len++) {
+            size_t expect_len = ref_encode(opts[o], in, len, expect);
+            char *out         = NULL;
+            size_t out_len    = 0;
+
+            CU_ASSERT_FATAL(0 == b64_encode(opts[o], in, len, &out, &out_len));
+            CU_ASSERT(expect_len == out_len);
+            if (len) {
+                CU_ASSERT(0 == memcmp(expect, out, out_len));
+                CU_ASSERT(strlen(out) == out_len);
+            }
+            free(out);
+        }
+    }
+}
+
+
+void test_decode_long()
+{
+    uint8_t in[301];
+    char enc[404];
+    uint32_t seed = 7;
+    int opts[]    = { B64_STD, B64_URL };
+    /* Invalid everywhere, then the 62/63 characters of the other alphabet. */
+    const char *bad[] = { "!*=\x80-_", "!*=\x80+/" };
+
+    for (size_t i = 0; i < sizeof(in); i++) {
+        seed  = seed * 1103515245 + 12345;
+        in[i] = (uint8_t) (seed >> 16);
+    }
+
+    for (size_t o = 0; o < 2; o++) {
+        for (size_t len = 1; len < sizeof(in); len++) {
+            size_t enc_len = ref_encode(opts[o], in, len, enc);
+            uint8_t *out   = NULL;
+            size_t out_len = 0;
+
+            CU_ASSERT_FATAL(0 == b64_decode(opts[o], enc, enc_len,
+                                            (void **) &out, &out_len));
+            CU_ASSERT(len == out_len);
+            CU_ASSERT(0 == memcmp(in, out, len));
+            free(out);
+        }
+
+        /* A bad character anywhere must be found, not just in the tail the
+         * scalar code handles. */
+        for (size_t i = 0; i < 198; i++) {
+            for (const char *b = bad[o]; '\0' != *b; b++) {
+                uint8_t *out   = NULL;
+                size_t out_len = 0;
+
+                ref_encode(opts[o], in, 150, enc);
+                enc[i] = *b;
+                CU_ASSERT(-1 == b64_decode(opts[o], enc, 200, (void **) &out,
+                                           &out_len));
+                CU_ASSERT(0 == out_len);
+                CU_ASSERT(NULL == out);
+            }
+        }
+    }
+
+    /* Padding on a long input that isn't a multiple of 4. */
+    CU_ASSERT(136 == ref_encode(B64_STD, in, 100, enc));
+    {
+        uint8_t *out   = NULL;
+        size_t out_len = 0;
+
+        CU_ASSERT(-1 == b64_decode(B64_URL, enc, 135, (void **) &out, &out_len));
+        CU_ASSERT(-2 == b64_decode(B64_STD, enc, 135, (void **) &out, &out_len));
+        CU_ASSERT(NULL == out);
+    }
+}
+
+
+void test_stream()
+{
+    uint8_t in[301];
+    char enc[404];
+    uint8_t dec[301];
+    uint32_t seed = 3;
+    int opts[]    = { B64_STD, B64_URL };
+
+    for (size_t i = 0; i < sizeof(in); i++) {
+        seed  = seed * 1103515245 + 12345;
+        in[i] = (uint8_t) (seed >> 16);
+    }
+
+    /* Every chunk size gives the same result as the one shot calls. */
+    for (size_t o = 0; o < 2; o++) {
+        for (size_t len = 0; len < sizeof(in); len += 37) {
+            char *expect      = NULL;
+            size_t expect_len = 0;
+
+            CU_ASSERT_FATAL(0 == b64_encode(opts[o], in, len, &expect, &expect_len));
+
+            for (size_t chunk = 1; chunk < 20; chunk++) {
+                b64_encoder_t e;
+                b64_decoder_t d;
+                size_t j = 0;
+                size_t n = 0;
+
+                CU_ASSERT_FATAL(0 == b64_encoder_init(&e, opts[o]));
+                for (size_t i = 0; i < len; i += chunk) {
+                    size_t c = (chunk < (len - i)) ? chunk : (len - i);
+
+                    n = sizeof(enc) - j;
+                    CU_ASSERT_FATAL(0 == b64_encoder_update(&e, &in[i], c, &enc[j], &n));
+                    CU_ASSERT(n <= ((c + 2) / 3) * 4);
+                    j += n;
+                }
+                n = sizeof(enc) - j;
+                CU_ASSERT_FATAL(0 == b64_encoder_final(&e, &enc[j], &n));
+                j += n;
+
+                CU_ASSERT_FATAL(expect_len == j);
+                if (j) {
+                    CU_ASSERT(0 == memcmp(expect, enc, j));
+                }
+
+                CU_ASSERT_FATAL(0 == b64_decoder_init(&d, opts[o]));
+                j = 0;
+                for (size_t i = 0; i < expect_len; i += chunk) {
+                    size_t c = (chunk < (expect_len - i)) ? chunk : (expect_len - i);
+
+                    n = sizeof(dec) - j;
+                    CU_ASSERT_FATAL(0 == b64_decoder_update(&d, &expect[i], c, &dec[j], &n));
+                    CU_ASSERT(n <= ((c + 3) / 4) * 3);
+                    j += n;
+                }
+                n = sizeof(dec) - j;
+                CU_ASSERT_FATAL(0 == b64_decoder_final(&d, &dec[j], &n));
+                j += n;
+
+                CU_ASSERT_FATAL(len == j);
+                if (j) {
+                    CU_ASSERT(0 == memcmp(in, dec, j));
+                }
+            }
+            free(expect);
+        }
+    }
+}
+
+
+void test_stream_errors()
+{
+    b64_encoder_t e;
+    b64_decoder_t d;
+    char buf[16];
+    size_t n = 0;
+
+    CU_ASSERT(-5 == b64_encoder_init(NULL, B64_STD));
+    CU_ASSERT(-5 == b64_encoder_init(&e, 0x0f));
+    CU_ASSERT(-5 == b64_decoder_init(NULL, B64_STD));
+    CU_ASSERT(-5 == b64_decoder_init(&d, 0x0f));
+
+    CU_ASSERT_FATAL(0 == b64_encoder_init(&e, B64_STD));
+    CU_ASSERT(-5 == b64_encoder_update(&e, NULL, 1, buf, &n));
+    CU_ASSERT(-5 == b64_encoder_update(&e, "a", 1, buf, NULL));
+    CU_ASSERT(-5 == b64_encoder_final(&e, NULL, &n));
+
+    /* Too small consumes nothing. */
+    n = 3;
+    CU_ASSERT(-3 == b64_encoder_update(&e, "Man", 3, buf, &n));
+    CU_ASSERT(0 == n);
+    n = 4;
+    CU_ASSERT(0 == b64_encoder_update(&e, "Ma", 2, buf, &n));
+    CU_ASSERT(0 == n);
+    n = 3;
+    CU_ASSERT(-3 == b64_encoder_final(&e, buf, &n));
+    n = 4;
+    CU_ASSERT(0 == b64_encoder_final(&e, buf, &n));
+    CU_ASSERT(4 == n);
+    CU_ASSERT(0 == memcmp("TWE=", buf, 4));
+
+    /* Data after the padding. */
+    CU_ASSERT_FATAL(0 == b64_decoder_init(&d, B64_STD));
+    n = sizeof(buf);
+    CU_ASSERT(0 == b64_decoder_update(&d, "TWE=", 4, buf, &n));
+    CU_ASSERT(2 == n);
+    n = sizeof(buf);
+    CU_ASSERT(-1 == b64_decoder_update(&d, "TWFu", 4, buf, &n));
+    CU_ASSERT(0 == n);
+
+    CU_ASSERT_FATAL(0 == b64_decoder_init(&d, B64_STD));
+    n = sizeof(buf);
+    CU_ASSERT(-1 == b64_decoder_update(&d, "TWE=TWFu", 8, buf, &n));
+    CU_ASSERT_FATAL(0 == b64_decoder_init(&d, B64_STD));
+    n = sizeof(buf);
+    CU_ASSERT(0 == b64_decoder_update(&d, "TW", 2, buf, &n));
+    n = sizeof(buf);
+    CU_ASSERT(-1 == b64_decoder_update(&d, "E=T", 3, buf, &n));
+
+    /* Invalid characters. */
+    CU_ASSERT_FATAL(0 == b64_decoder_init(&d, B64_STD));
+    n = sizeof(buf);
+    CU_ASSERT(-1 == b64_decoder_update(&d, "TW!u", 4, buf, &n));
+
+    /* Too small consumes nothing. */
+    CU_ASSERT_FATAL(0 == b64_decoder_init(&d, B64_URL));
+    n = 2;
+    CU_ASSERT(-3 == b64_decoder_update(&d, "TWFu", 4, buf, &n));
+    CU_ASSERT(0 == n);
+    n = sizeof(buf);
+    CU_ASSERT(0 == b64_decoder_update(&d, "TWFuTW", 6, buf, &n));
+    CU_ASSERT(3 == n);
+    n = 0;
+    CU_ASSERT(-3 == b64_decoder_final(&d, buf, &n));
+    n = sizeof(buf);
+    CU_ASSERT(0 == b64_decoder_final(&d, buf, &n));
+    CU_ASSERT(1 == n);
+    CU_ASSERT('M' == buf[0]);
+
+    /* Bad lengths show up at the end. */
+    CU_ASSERT_FATAL(0 == b64_decoder_init(&d, B64_STD));
+    n = sizeof(buf);
+    CU_ASSERT(0 == b64_decoder_update(&d, "TWFuTW", 6, buf, &n));
+    n = sizeof(buf);
+    CU_ASSERT(-2 == b64_decoder_final(&d, buf, &n));
+    CU_ASSERT_FATAL(0 == b64_decoder_init(&d, B64_URL));
+    n = sizeof(buf);
+    CU_ASSERT(0 == b64_decoder_update(&d, "TWFuT", 5, buf, &n));
+    n = sizeof(buf);
+    CU_ASSERT(-2 == b64_decoder_final(&d, buf, &n));
+}
+
+
+void test_wrap()
+{
+    uint8_t in[301];
+    char flat[404];
+    char expect[1300];
+    uint32_t seed = 5;
+    struct {
+        int opts;
+        size_t wrap;
+        const char *brk;
+    } t[] = {
+        { B64_STD | B64_WRAP(64), 64, "\n" },
+        { B64_STD | B64_WRAP(76) | B64_CRLF, 76, "\r\n" },
+        { B64_URL | B64_WRAP(5), 5, "\n" },
+        { B64_URL | B64_WRAP(1) | B64_CRLF, 1, "\r\n" },
+    };
+
+    for (size_t i = 0; i < sizeof(in); i++) {
+        seed  = seed * 1103515245 + 12345;
+        in[i] = (uint8_t) (seed >> 16);
+    }
+
+    for (size_t k = 0; k < sizeof(t) / sizeof(t[0]); k++) {
+        for (size_t len = 1; len < sizeof(in); len += 11) {
+            size_t flat_len   = ref_encode(0x0f & t[k].opts, in, len, flat);
+            size_t expect_len = 0;
+            char *out         = NULL;
+            size_t out_len    = 0;
+            uint8_t *dec      = NULL;
+            size_t dec_len    = 0;
+
+            for (size_t i = 0; i < flat_len; i++) {
+                if (i && (0 == (i % t[k].wrap))) {
+                    for (const char *c = t[k].brk; '\0' != *c; c++) {
+                        expect[expect_len++] = *c;
+                    }
+                }
+                expect[expect_len++] = flat[i];
+            }
+
+            CU_ASSERT(0 == b64_encode(t[k].opts, in, len, NULL, &out_len));
+            CU_ASSERT(expect_len == out_len);
+
+            CU_ASSERT_FATAL(0 == b64_encode(t[k].opts, in, len, &out, &out_len));
+            CU_ASSERT_FATAL(expect_len == out_len);
+            CU_ASSERT(0 == memcmp(expect, out, out_len));
+
+            /* Without B64_SKIP_WS the line breaks are invalid. */
+            if (t[k].wrap < out_len) {
+                CU_ASSERT(0 > b64_decode(0x0f & t[k].opts, out, out_len,
+                                           (void **) &dec, &dec_len));
+            }
+
+            CU_ASSERT_FATAL(0 == b64_decode((0x0f & t[k].opts) | B64_SKIP_WS,
+                                            out, out_len, (void **) &dec, &dec_len));
+            CU_ASSERT(len == dec_len);
+            CU_ASSERT(0 == memcmp(in, dec, len));
+
+            free(dec);
+            free(out);
+        }
+    }
+}
+
+
+void test_skip_ws()
+{
+    struct test_vector tests[] = {
+        { .rv = 0, .in_len = 9, .in = " T W\tE=\r\n", .out_len = 2, .out = "Ma" },
+        { .rv = 0, .in_len = 9, .in = "TWE = \n\n ", .out_len = 2, .out = "Ma" },
+        { .rv = 0, .in_len = 6, .in = "TQ=\n=\n", .out_len = 1, .out = "M" },
+        { .rv = 0, .in_len = 9, .in = "\nTW\nFu\n\n\n", .out_len = 3, .out = "Man" },
+
+        /* Whitespace doesn't count towards the length. */
+        { .rv = 0, .in_len = 5, .in = "TW Fu", .out_len = 3, .out = "Man" },
+        { .rv = -2, .in_len = 5, .in = "TW F ", .out_len = 0, .out = NULL },
+        { .rv = -2, .in_len = 4, .in = "   \n", .out_len = 0, .out = NULL },
+
+        /* Only whitespace and padding may follow the padding. */
+        { .rv = -1, .in_len = 9, .in = "TWE=\nTWFu", .out_len = 0, .out = NULL },
+        { .rv = -1, .in_len = 9, .in = "TW=\n=TWuu", .out_len = 0, .out = NULL },
+        { .rv = -1, .in_len = 8, .in = "T===\r\n\r\n", .out_len = 0, .out = NULL },
+        { .rv = -1, .in_len = 4, .in = "TW\vF", .out_len = 0, .out = NULL },
+    };
+
+    for (size_t i = 0; i < sizeof(tests) / sizeof(tests[0]); i++) {
+        tests[i].opts = B64_STD | B64_SKIP_WS;
+        test_decode_helper(tests[i].opts, tests[i].in, tests[i].in_len,
+                           tests[i].out, tests[i].out_len, tests[i].rv);
+    }
+
+    {
+        /* A long PEM style input goes through the SIMD code per line. */
+        char pem[420];
+        char flat[404];
+        uint8_t in[300];
+        uint8_t *out   = NULL;
+        size_t out_len = 0;
+        size_t j       = 0;
+        size_t len     = 0;
+
+        for (size_t i = 0; i < sizeof(in); i++) {
+            in[i] = (uint8_t) (i * 31);
+        }
+        len = ref_encode(B64_STD, in, sizeof(in), flat);
+        for (size_t i = 0; i < len; i++) {
+            if (i && (0 == (i % 64))) {
+                pem[j++] = '\n';
+            }
+            pem[j++] = flat[i];
+        }
+        pem[j++] = '\n';
+
+        CU_ASSERT_FATAL(0 == b64_decode(B64_STD | B64_SKIP_WS, pem, j,
+                                        (void **) &out, &out_len));
+        CU_ASSERT(sizeof(in) == out_len);
+        CU_ASSERT(0 == memcmp(in, out, out_len));
+        free(out);
+
+        /* An invalid character at a line start and mid line. */
+        pem[65] = '!';
+        CU_ASSERT(-1 == b64_decode(B64_STD | B64_SKIP_WS, pem, j,
+                                   (void **) &out, &out_len));
+        pem[65] = flat[64];
+        pem[100] = '=';
+        CU_ASSERT(-1 == b64_decode(B64_STD | B64_SKIP_WS, pem, j,
+                                   (void **) &out, &out_len));
+    }
+
+    {
+        b64_encoder_t e;
+        b64_decoder_t d;
+
+        CU_ASSERT(-5 == b64_encoder_init(&e, B64_STD | B64_WRAP(64)));
+        CU_ASSERT(-5 == b64_decoder_init(&d, B64_STD | B64_SKIP_WS));
+    }
+}
+
+
+void test_decode_inplace()
+{
+    uint8_t in[301];
+    char enc[420];
+    uint32_t seed = 11;
+    int opts[]    = { B64_STD, B64_URL };
+    size_t len    = 0;
+
+    for (size_t i = 0; i < sizeof(in); i++) {
+        seed  = seed * 1103515245 + 12345;
+        in[i] = (uint8_t) (seed >> 16);
+    }
+
+    for (size_t o = 0; o < 2; o++) {
+        for (size_t i = 1; i < sizeof(in); i++) {
+            size_t enc_len = ref_encode(opts[o], in, i, enc);
+
+            CU_ASSERT_FATAL(0 == b64_decode_inplace(opts[o], enc, enc_len, &len));
+            CU_ASSERT(i == len);
+            CU_ASSERT(0 == memcmp(in, enc, len));
+        }
+    }
+
+    /* Line wrapped */
+    {
+        char *wrapped = NULL;
+
+        CU_ASSERT_FATAL(0 == b64_encode(B64_STD | B64_WRAP(64), in, sizeof(in),
+                                        &wrapped, &len));
+        CU_ASSERT(0 == b64_decode_inplace(B64_STD | B64_SKIP_WS, wrapped, len, &len));
+        CU_ASSERT(sizeof(in) == len);
+        CU_ASSERT(0 == memcmp(in, wrapped, len));
+        free(wrapped);
+    }
+
+    memcpy(enc, "TW!u", 4);
+    CU_ASSERT(-1 == b64_decode_inplace(B64_STD, enc, 4, &len));
+    CU_ASSERT(0 == len);
+    CU_ASSERT(-2 == b64_decode_inplace(B64_STD, enc, 3, &len));
+    CU_ASSERT(-5 == b64_decode_inplace(B64_STD, enc, 4, NULL));
+    CU_ASSERT(-5 == b64_decode_inplace(0x0f, enc, 4, &len));
+    CU_ASSERT(0 == b64_decode_inplace(B64_STD, NULL, 0, &len));
+    CU_ASSERT(0 == len);
+}
+
+
+void test_len_macros()
+{
+    /* Usable as a constant. */
+    char buf[B64_ENCODED_LEN(B64_STD, 5) + B64_DECODED_MAX_LEN(B64_URL, 7)];
+    int opts[] = {
+        B64_STD,
+        B64_URL,
+        B64_STD | B64_WRAP(64),
+        B64_URL | B64_WRAP(76) | B64_CRLF,
+        B64_STD | B64_WRAP(3) | B64_CRLF,
+    };
+    uint8_t in[200];
+
+    CU_ASSERT(8 + 5 == sizeof(buf));
+
+    memset(in, 0xa5, sizeof(in));
+
+    for (size_t o = 0; o < sizeof(opts) / sizeof(opts[0]); o++) {
+        for (size_t n = 0; n < sizeof(in); n++) {
+            char *enc      = NULL;
+            size_t enc_len = 0;
+            uint8_t *dec   = NULL;
+            size_t dec_len = 0;
+
+            CU_ASSERT_FATAL(0 == b64_encode(opts[o], in, n, &enc, &enc_len));
+            CU_ASSERT(B64_ENCODED_LEN(opts[o], n) == enc_len);
+
+            /* Exact for data that was encoded. */
+            CU_ASSERT_FATAL(0 == b64_decode(opts[o] | B64_SKIP_WS, enc, enc_len,
+                                            (void **) &dec, &dec_len));
+            CU_ASSERT(n == dec_len);
+            if (!(opts[o] & ~0x0f)) {
+                CU_ASSERT(n <= B64_DECODED_MAX_LEN(opts[o], enc_len));
+                CU_ASSERT(B64_DECODED_MAX_LEN(opts[o], enc_len) <= n + 2);
+            }
+            if (n) {
+                CU_ASSERT('\0' == dec[dec_len]);
+            }
+
+            free(dec);
+            free(enc);
+        }
+    }
+
+    /* A remainder of 1 can't decode to anything. */
+    CU_ASSERT(3 == B64_DECODED_MAX_LEN(B64_URL, 5));
+    CU_ASSERT(5 == B64_DECODED_MAX_LEN(B64_URL, 7));
+    CU_ASSERT(3 == B64_DECODED_MAX_LEN(B64_STD, 7));
+}
+
+
+void test_iovec()
+{
+    uint8_t in[301];
+    uint32_t seed = 13;
+    int opts[]    = { B64_STD, B64_URL };
+
+    for (size_t i = 0; i < sizeof(in); i++) {
+        seed  = seed * 1103515245 + 12345;
+        in[i] = (uint8_t) (seed >> 16);
+    }
+
+    for (size_t o = 0; o < 2; o++) {
+        for (size_t len = 1; len < sizeof(in); len += 23) {
+            char *expect      = NULL;
+            size_t expect_len = 0;
+
+            CU_ASSERT_FATAL(0 == b64_encode(opts[o], in, len, &expect, &expect_len));
+
+            /* Split at every pair of points, with an empty buffer between. */
+            for (size_t a = 0; a <= len; a += 5) {
+                for (size_t b = a; b <= len; b += 7) {
+                    struct iovec iov[4] = {
+                        { .iov_base = in, .iov_len = a },
+                        { .iov_base = NULL, .iov_len = 0 },
+                        { .iov_base = &in[a], .iov_len = b - a },
+                        { .iov_base = &in[b], .iov_len = len - b },
+                    };
+                    struct iovec enc[3];
+                    size_t ea      = (a < expect_len) ? a : expect_len;
+                    size_t eb      = (b < expect_len) ? b : expect_len;
+                    char *out      = NULL;
+                    uint8_t *dec   = NULL;
+                    size_t out_len = 0;
+
+                    CU_ASSERT_FATAL(0 == b64_encodev(opts[o], iov, 4, &out, &out_len));
+                    CU_ASSERT_FATAL(expect_len == out_len);
+                    CU_ASSERT(0 == memcmp(expect, out, out_len));
+                    CU_ASSERT('\0' == out[out_len]);
+
+                    enc[0].iov_base = expect;
+                    enc[0].iov_len  = ea;
+                    enc[1].iov_base = &expect[ea];
+                    enc[1].iov_len  = eb - ea;
+                    enc[2].iov_base = &expect[eb];
+                    enc[2].iov_len  = expect_len - eb;
+
+                    CU_ASSERT_FATAL(0 == b64_decodev(opts[o], enc, 3, (void **) &dec, &out_len));
+                    CU_ASSERT_FATAL(len == out_len);
+                    CU_ASSERT(0 == memcmp(in, dec, len));
+
+                    free(dec);
+                    free(out);
+                }
+            }
+            free(expect);
+        }
+    }
+
+    {
+        struct iovec iov[2] = {
+            { .iov_base = "TW", .iov_len = 2 },
+            { .iov_base = "E=", .iov_len = 2 },
+        };
+        char buf[4];
+        char *out  = buf;
+        void *vout = buf;
+        size_t len = 0;
+
+        len = sizeof(buf);
+        CU_ASSERT(0 == b64_decodev(B64_STD | B64_PROVIDED, iov, 2, &vout, &len));
+        CU_ASSERT(2 == len);
+        CU_ASSERT(0 == memcmp("Ma", buf, 2));
+
+        len = 3;
+        CU_ASSERT(-3 == b64_encodev(B64_STD | B64_PROVIDED, iov, 2, &out, &len));
+        CU_ASSERT(0 == len);
+        len = 8;
+        out = NULL;
+        CU_ASSERT(0 == b64_encodev(B64_STD, iov, 2, &out, &len));
+        CU_ASSERT(0 == strcmp("VFdFPQ==", out));
+        free(out);
+
+        iov[1].iov_len = 1;
+        CU_ASSERT(-2 == b64_decodev(B64_STD, iov, 2, &vout, &len));
+        iov[1].iov_base = "!=";
+        iov[1].iov_len  = 2;
+        CU_ASSERT(-1 == b64_decodev(B64_STD, iov, 2, &vout, &len));
+        CU_ASSERT(0 == len);
+
+        CU_ASSERT(0 == b64_encodev(B64_STD, NULL, 0, &out, &len));
+        CU_ASSERT(NULL == out);
+        CU_ASSERT(0 == len);
+        CU_ASSERT(-5 == b64_encodev(B64_STD, NULL, 1, &out, &len));
+        CU_ASSERT(-5 == b64_encodev(B64_STD, iov, -1, &out, &len));
+        CU_ASSERT(-5 == b64_encodev(B64_STD, iov, 2, NULL, &len));
+        CU_ASSERT(-5 == b64_encodev(B64_STD, iov, 2, &out, NULL));
+        CU_ASSERT(-5 == b64_encodev(B64_STD | B64_WRAP(4), iov, 2, &out, &len));
+        CU_ASSERT(-5 == b64_decodev(B64_STD | B64_SKIP_WS, iov, 2, &vout, &len));
+    }
+}
+
+
+void test_parallel()
+{
+    size_t len    = 1000003;
+    uint8_t *in   = malloc(len);
+    uint32_t seed = 17;
+    int threads[] = { 0, 1, 2, 3, 8, 1000 };
+    int opts[]    = { B64_STD, B64_URL, B64_STD | B64_WRAP(76) | B64_CRLF };
+
+    CU_ASSERT_FATAL(NULL != in);
+    for (size_t i = 0; i < len; i++) {
+        seed  = seed * 1103515245 + 12345;
+        in[i] = (uint8_t) (seed >> 16);
+    }
+
+    for (size_t o = 0; o < sizeof(opts) / sizeof(opts[0]); o++) {
+        char *expect      = NULL;
+        size_t expect_len = 0;
+
+        CU_ASSERT_FATAL(0 == b64_encode(opts[o], in, len, &expect, &expect_len));
+
+        for (size_t t = 0; t < sizeof(threads) / sizeof(threads[0]); t++) {
+            char *enc      = NULL;
+            uint8_t *dec   = NULL;
+            size_t enc_len = 0;
+            size_t dec_len = 0;
+            int dopts      = (0x0f & opts[o]);
+
+            CU_ASSERT_FATAL(0 == b64_encode_parallel(opts[o], in, len, &enc,
+                                                     &enc_len, threads[t]));
+            CU_ASSERT_FATAL(expect_len == enc_len);
+            CU_ASSERT(0 == memcmp(expect, enc, enc_len));
+            CU_ASSERT('\0' == enc[enc_len]);
+
+            if (opts[o] & ~0x0f) {
+                dopts |= B64_SKIP_WS;
+            }
+            CU_ASSERT_FATAL(0 == b64_decode_parallel(dopts, enc, enc_len,
+                                                     (void **) &dec, &dec_len,
+                                                     threads[t]));
+            CU_ASSERT_FATAL(len == dec_len);
+            CU_ASSERT(0 == memcmp(in, dec, len));
+
+            free(dec);
+            free(enc);
+        }
+
+        free(expect);
+    }
+
+    {
+        char *enc      = NULL;
+        uint8_t *dec   = NULL;
+        size_t enc_len = 0;
+        size_t dec_len = 0;
+        size_t per     = 0;
+
+        CU_ASSERT_FATAL(0 == b64_encode(B64_STD, in, len, &enc, &enc_len));
+
+        /* Padding at the end of a piece other than the last. */
+        per          = ((enc_len / 2) / 4) * 4;
+        enc[per - 1] = '=';
+        CU_ASSERT(-1 == b64_decode(B64_STD, enc, enc_len, (void **) &dec, &dec_len));
+        CU_ASSERT(-1 == b64_decode_parallel(B64_STD, enc, enc_len, (void **) &dec,
+                                            &dec_len, 2));
+        CU_ASSERT(0 == dec_len);
+        CU_ASSERT(NULL == dec);
+        enc[per - 1] = 'A';
+
+        /* An invalid character in the middle. */
+        enc[enc_len / 3] = '*';
+        CU_ASSERT(-1 == b64_decode_parallel(B64_STD, enc, enc_len, (void **) &dec,
+                                            &dec_len, 8));
+        free(enc);
+    }
+
+    free(in);
+}
+
+
+void test_validate()
+{
+    struct test_vector *t = common_decoder_tests;
+    uint8_t in[301];
+    char enc[404];
+    int opts[] = { B64_STD, B64_URL };
+
+    /* The same results as decoding. */
+    for (size_t i = 0; i < sizeof(common_decoder_tests) / sizeof(struct test_vector); i++) {
+        for (size_t o = 0; o < 2; o++) {
+            uint8_t *out = NULL;
+            size_t len   = 0;
+            int rv       = b64_decode(opts[o], t[i].in, t[i].in_len, (void **) &out, &len);
+
+            CU_ASSERT(rv == b64_validate(opts[o], t[i].in, t[i].in_len));
+            free(out);
+        }
+    }
+
+    for (size_t i = 0; i < sizeof(in); i++) {
+        in[i] = (uint8_t) (i * 113);
+    }
+
+    for (size_t o = 0; o < 2; o++) {
+        for (size_t len = 1; len < sizeof(in); len++) {
+            size_t enc_len = ref_encode(opts[o], in, len, enc);
+            size_t out_len = 0;
+
+            /* The length without decoding. */
+            CU_ASSERT(0 == b64_validate(opts[o], enc, enc_len));
+            CU_ASSERT(0 == b64_decode(opts[o], enc, enc_len, NULL, &out_len));
+            CU_ASSERT(len == out_len);
+            CU_ASSERT(0 == b64_encode(opts[o], in, len, NULL, &out_len));
+            CU_ASSERT(enc_len == out_len);
+
+            /* Bad characters everywhere, including in the SIMD blocks. */
+            for (size_t i = 0; i < enc_len; i += 7) {
+                char c = enc[i];
+
+                enc[i] = '\x80';
+                CU_ASSERT(-1 == b64_validate(opts[o], enc, enc_len));
+                CU_ASSERT(-1 == b64_decode(opts[o], enc, enc_len, NULL, &out_len));
+                CU_ASSERT(0 == out_len);
+                enc[i] = c;
+            }
+        }
+    }
+
+    CU_ASSERT(0 == b64_validate(B64_STD, NULL, 0));
+    CU_ASSERT(-5 == b64_validate(0x0f, "TWFu", 4));
+    CU_ASSERT(0 == b64_validate(B64_STD | B64_SKIP_WS, "TW\nFu", 5));
+}
+
+
+void test_fixed()
+{
+    int opts[] = { B64_STD, B64_URL };
+    size_t sizes[] = { 6, 16, 32 };
+    uint8_t in[32];
+    uint8_t out[32];
+    char enc[44];
+    char expect[48];
+    uint32_t seed = 7;
+
+    for (int round = 0; round < 200; round++) {
+        for (size_t i = 0; i < sizeof(in); i++) {
+            seed   = seed * 1103515245u + 12345u;
+            in[i]  = (uint8_t) (seed >> 16);
+        }
+
+        for (size_t o = 0; o < 2; o++) {
+            for (size_t k = 0; k < 3; k++) {
+                size_t n          = sizes[k];
+                size_t expect_len = ref_encode(opts[o], in, n, expect);
+                size_t len        = 0;
+                int rv            = 0;
+
+                CU_ASSERT(B64_ENCODED_LEN(opts[o], n) == expect_len);
+
+                memset(enc, 0, sizeof(enc));
+                memset(out, 0, sizeof(out));
+                if (6 == n) {
+                    len = b64_encode6(opts[o], in, enc);
+                    rv  = b64_decode6(opts[o], enc, out);
+                } else if (16 == n) {
+                    len = b64_encode16(opts[o], in, enc);
+                    rv  = b64_decode16(opts[o], enc, out);
+                } else {
+                    len = b64_encode32(opts[o], in, enc);
+                    rv  = b64_decode32(opts[o], enc, out);
+                }
+
+                CU_ASSERT(expect_len == len);
+                CU_ASSERT(0 == memcmp(expect, enc, expect_len));
+                CU_ASSERT(0 == rv);
+                CU_ASSERT(0 == memcmp(in, out, n));
+            }
+        }
+    }
+
+    /* Every character of both alphabets, and nothing else. */
+    for (int c = 0; c < 256; c++) {
+        for (size_t o = 0; o < 2; o++) {
+            char s[8] = { 'A', 'A', 'A', 'A', 'A', 'A', 'A', 'A' };
+            const char *alphabet = (B64_URL == opts[o]) ? "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_"
+                                                        : "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+            int valid = (0 != c) && (NULL != strchr(alphabet, c));
+
+            s[3] = (char) c;
+            CU_ASSERT((valid ? 0 : -1) == b64_decode6(opts[o], s, out));
+        }
+    }
+
+    /* An invalid character anywhere is caught by each of the decoders. */
+    for (size_t o = 0; o < 2; o++) {
+        for (size_t k = 0; k < 3; k++) {
+            size_t n   = sizes[k];
+            size_t len = 0;
+
+            len = (6 == n) ? b64_encode6(opts[o], in, enc)
+                           : (16 == n) ? b64_encode16(opts[o], in, enc)
+                                       : b64_encode32(opts[o], in, enc);
+
+            for (size_t i = 0; i < len; i++) {
+                const char bad[] = { '*', '\0', '=', (char) 0xff };
+
+                for (size_t b = 0; b < sizeof(bad); b++) {
+                    char save = enc[i];
+                    int rv    = 0;
+
+                    if (bad[b] == save) {
+                        continue;
+                    }
+                    enc[i] = bad[b];
+                    if (6 == n) {
+                        rv = b64_decode6(opts[o], enc, out);
+                    } else if (16 == n) {
+                        rv = b64_decode16(opts[o], enc, out);
+                    } else {
+                        rv = b64_decode32(opts[o], enc, out);
+                    }
+                    CU_ASSERT(-1 == rv);
+                    enc[i] = save;
+                }
+            }
+        }
+    }
+
+    /* Padding. */
+    CU_ASSERT(0 == b64_decode16(B64_STD, "AAAAAAAAAAAAAAAAAAAAAA==", out));
+    CU_ASSERT(-1 == b64_decode16(B64_STD, "AAAAAAAAAAAAAAAAAAAAAA=A", out));
+    CU_ASSERT(-1 == b64_decode16(B64_STD, "AAAAAAAAAAAAAAAAAAAAAAA=", out));
+    CU_ASSERT(0 == b64_decode32(B64_STD, "AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA=", out));
+    CU_ASSERT(-1 == b64_decode32(B64_STD, "AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA", out));
+    CU_ASSERT(0 == b64_decode32(B64_URL, "AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA", out));
+}
+
+
+/* Collects everything passed to it, failing once fail_after calls are made. */
+struct sink_ctx {
+    uint8_t *buf;
+    size_t len;
+    size_t calls;
+    size_t max_block;
+    size_t fail_after;
+};
+
+
+static int collect(void *ctx, const void *buf, size_t len)
+{
+    struct sink_ctx *c = (struct sink_ctx *) ctx;
+
+    if (c->fail_after && (c->fail_after <= c->calls)) {
+        return -1;
+    }
+
+    c->buf = realloc(c->buf, c->len + len);
+    memcpy(&c->buf[c->len], buf, len);
+    c->len += len;
+    c->calls++;
+    if (c->max_block < len) {
+        c->max_block = len;
+    }
+
+    return 0;
+}
+
+
+void test_sink()
+{
+    size_t sizes[] = { 0, 1, 2, 3, 12287, 12288, 12289, 16383, 16384, 16385,
+                       B64_SINK_BLOCK * 5 + 7 };
+    int opts[]     = { B64_STD, B64_URL };
+    size_t max     = B64_SINK_BLOCK * 5 + 7;
+    uint8_t *in    = malloc(max);
+    char *enc      = malloc(B64_ENCODED_LEN(B64_STD, max));
+    uint32_t seed  = 3;
+
+    CU_ASSERT_FATAL(NULL != in);
+    CU_ASSERT_FATAL(NULL != enc);
+
+    for (size_t i = 0; i < max; i++) {
+        seed  = seed * 1103515245u + 12345u;
+        in[i] = (uint8_t) (seed >> 16);
+    }
+
+    for (size_t o = 0; o < 2; o++) {
+        for (size_t k = 0; k < sizeof(sizes) / sizeof(size_t); k++) {
+            size_t len         = sizes[k];
+            size_t enc_len     = ref_encode(opts[o], in, len, enc);
+            struct sink_ctx ec = { 0 };
+            struct sink_ctx dc = { 0 };
+
+            CU_ASSERT(0 == b64_encode_to_sink(opts[o], in, len, collect, &ec));
+            CU_ASSERT(enc_len == ec.len);
+            CU_ASSERT((0 == enc_len) || (0 == memcmp(enc, ec.buf, enc_len)));
+            CU_ASSERT(ec.max_block <= B64_SINK_BLOCK);
+
+            CU_ASSERT(0 == b64_decode_to_sink(opts[o], enc, enc_len, collect, &dc));
+            CU_ASSERT(len == dc.len);
+            CU_ASSERT((0 == len) || (0 == memcmp(in, dc.buf, len)));
+            CU_ASSERT(dc.max_block <= B64_SINK_BLOCK);
+
+            free(ec.buf);
+            free(dc.buf);
+        }
+    }
+
+    /* The sink can stop it. */
+    {
+        struct sink_ctx c = { .fail_after = 2 };
+        size_t enc_len    = ref_encode(B64_STD, in, max, enc);
+
+        CU_ASSERT(-6 == b64_encode_to_sink(B64_STD, in, max, collect, &c));
+        CU_ASSERT(2 == c.calls);
+        c.calls = 0;
+        CU_ASSERT(-6 == b64_decode_to_sink(B64_STD, enc, enc_len, collect, &c));
+        CU_ASSERT(2 == c.calls);
+        free(c.buf);
+    }
+
+    /* Decoding errors, the same as b64_decode(). */
+    {
+        struct sink_ctx c = { 0 };
+
+        CU_ASSERT(-1 == b64_decode_to_sink(B64_STD, "TW*u", 4, collect, &c));
+        CU_ASSERT(-2 == b64_decode_to_sink(B64_STD, "TWFuT", 5, collect, &c));
+        CU_ASSERT(-5 == b64_decode_to_sink(B64_STD | B64_SKIP_WS, "TWFu", 4, collect, &c));
+        CU_ASSERT(-5 == b64_encode_to_sink(B64_STD, "Man", 3, NULL, &c));
+        CU_ASSERT(-5 == b64_encode_to_sink(B64_STD, NULL, 3, collect, &c));
+        CU_ASSERT(-5 == b64_encode_to_sink(B64_STD | B64_WRAP(64), "Man", 3, collect, &c));
+        free(c.buf);
+    }
+
+    /* To a file. */
+    {
+        char filename[7] = "XXXXXX";
+        size_t enc_len   = ref_encode(B64_URL, in, max, enc);
+        char *got        = malloc(enc_len);
+        int fd           = mkstemp(filename);
+
+        CU_ASSERT_FATAL(-1 != fd);
+        CU_ASSERT_FATAL(NULL != got);
+        CU_ASSERT(0 == b64_encode_to_fd(B64_URL, in, max, fd));
+        CU_ASSERT(0 == lseek(fd, 0, SEEK_SET));
+        CU_ASSERT(enc_len == (size_t) read(fd, got, enc_len));
+        CU_ASSERT(0 == memcmp(enc, got, enc_len));
+
+        CU_ASSERT(0 == ftruncate(fd, 0));
+        CU_ASSERT(0 == lseek(fd, 0, SEEK_SET));
+        CU_ASSERT(0 == b64_decode_to_fd(B64_URL, enc, enc_len, fd));
+        CU_ASSERT(0 == lseek(fd, 0, SEEK_SET));
+        CU_ASSERT(max == (size_t) read(fd, got, enc_len));
+        CU_ASSERT(0 == memcmp(in, got, max));
+
+        close(fd);
+        unlink(filename);
+        free(got);
+
+        CU_ASSERT(-6 == b64_encode_to_fd(B64_STD, "Man", 3, -1));
+    }
+
+    free(in);
+    free(enc);
+}
+
+
 void test_input_validation()
 {
     size_t len = 9;
@@ -560,7 +1544,20 @@ void add_suites(CU_pSuite *suite)
     CU_add_test(*suite, "Test the Encoded Size     ", test_encoded_size);
     CU_add_test(*suite, "Test the Decoded Size     ", test_decoded_size);
     CU_add_test(*suite, "Test Encoding             ", test_encode);
+    CU_add_test(*suite, "Test Encoding Long Inputs ", test_encode_long);
     CU_add_test(*suite, "Test Decoding             ", test_decode);
+    CU_add_test(*suite, "Test Decoding Long Inputs ", test_decode_long);
+    CU_add_test(*suite, "Test Streaming            ", test_stream);
+    CU_add_test(*suite, "Test Streaming Errors     ", test_stream_errors);
+    CU_add_test(*suite, "Test Line Wrapping        ", test_wrap);
+    CU_add_test(*suite, "Test Skipping Whitespace  ", test_skip_ws);
+    CU_add_test(*suite, "Test Decoding In Place    ", test_decode_inplace);
+    CU_add_test(*suite, "Test Length Macros        ", test_len_macros);
+    CU_add_test(*suite, "Test Scatter/Gather       ", test_iovec);
+    CU_add_test(*suite, "Test Parallel             ", test_parallel);
+    CU_add_test(*suite, "Test Validation Only      ", test_validate);
+    CU_add_test(*suite, "Test Fixed Sizes          ", test_fixed);
+    CU_add_test(*suite, "Test Sinks                ", test_sink);
     CU_add_test(*suite, "Test Input Validation     ", test_input_validation);
 }
 
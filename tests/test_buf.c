@@ -0,0 +1,210 @@
+/* SPDX-FileCopyrightText: 2026 Comcast Cable Communications Management, LLC */
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#include <CUnit/Basic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "buf.h"
+
+
+void test_append(void)
+{
+    cu_buf_t b     = { 0 };
+    size_t grows   = 0;
+    size_t cap     = 0;
+    char expect[8] = "0123456";
+
+    CU_ASSERT(0 == cu_buf_append(&b, NULL, 0));
+    CU_ASSERT_FATAL(NULL != b.data);
+    CU_ASSERT_STRING_EQUAL("", b.data);
+
+    /* 100000 small appends only grow the buffer a few times. */
+    for (size_t i = 0; i < 100000; i++) {
+        CU_ASSERT_FATAL(0 == cu_buf_append(&b, &expect[i % 7], 1));
+        if (cap != b.cap) {
+            cap = b.cap;
+            grows++;
+        }
+    }
+    CU_ASSERT(100000 == b.len);
+    CU_ASSERT(b.len < b.cap);
+    CU_ASSERT(grows < 20);
+    CU_ASSERT('\0' == b.data[b.len]);
+    for (size_t i = 0; i < 100000; i++) {
+        CU_ASSERT(expect[i % 7] == b.data[i]);
+    }
+
+    CU_ASSERT(-1 == cu_buf_append(NULL, "a", 1));
+    CU_ASSERT(-1 == cu_buf_append(&b, NULL, 1));
+    CU_ASSERT(-2 == cu_buf_append(&b, "a", SIZE_MAX));
+    CU_ASSERT(100000 == b.len);
+
+    cu_buf_destroy(&b);
+    CU_ASSERT(NULL == b.data);
+    CU_ASSERT(0 == b.len);
+    CU_ASSERT(0 == b.cap);
+    cu_buf_destroy(NULL);
+}
+
+
+void test_reserve(void)
+{
+    cu_buf_t b = { 0 };
+    char *data = NULL;
+
+    CU_ASSERT(0 == cu_buf_reserve(&b, 1000));
+    CU_ASSERT(1000 < b.cap);
+    CU_ASSERT(0 == b.len);
+    CU_ASSERT_STRING_EQUAL("", b.data);
+
+    /* No more growing within the reservation. */
+    data = b.data;
+    for (int i = 0; i < 1000; i++) {
+        CU_ASSERT(0 == cu_buf_append(&b, "x", 1));
+    }
+    CU_ASSERT(data == b.data);
+
+    CU_ASSERT(-1 == cu_buf_reserve(NULL, 1));
+    CU_ASSERT(-2 == cu_buf_reserve(&b, SIZE_MAX));
+
+    cu_must_buf_reserve(&b, 10);
+    cu_must_buf_append(&b, "yz", 2);
+    CU_ASSERT(1002 == b.len);
+
+    cu_buf_destroy(&b);
+}
+
+
+void test_appendf(void)
+{
+    cu_buf_t b = { 0 };
+    char big[300];
+
+    CU_ASSERT(0 == cu_buf_appendf(&b, "%s=%d", "a", 1));
+    CU_ASSERT_STRING_EQUAL("a=1", b.data);
+    CU_ASSERT(3 == b.len);
+
+    CU_ASSERT(0 == cu_buf_appendf(&b, "%s", ""));
+    CU_ASSERT(3 == b.len);
+
+    /* Larger than what is left. */
+    memset(big, 'b', sizeof(big) - 1);
+    big[sizeof(big) - 1] = '\0';
+    CU_ASSERT(0 == cu_buf_appendf(&b, ",%s", big));
+    CU_ASSERT(3 + 1 + 299 == b.len);
+    CU_ASSERT(0 == strncmp("a=1,bbb", b.data, 7));
+    CU_ASSERT('b' == b.data[b.len - 1]);
+    CU_ASSERT('\0' == b.data[b.len]);
+
+    cu_must_buf_appendf(&b, "%c", '!');
+    CU_ASSERT('!' == b.data[b.len - 1]);
+
+    CU_ASSERT(-1 == cu_buf_appendf(NULL, "x"));
+    CU_ASSERT(-1 == cu_buf_appendf(&b, NULL));
+
+    cu_buf_destroy(&b);
+}
+
+
+void test_append_self(void)
+{
+    cu_buf_t b = { 0 };
+
+    /* Doubling the buffer with itself makes it grow and move each time. */
+    CU_ASSERT(0 == cu_buf_append(&b, "ab", 2));
+    for (int i = 0; i < 12; i++) {
+        CU_ASSERT_FATAL(0 == cu_buf_append(&b, b.data, b.len));
+    }
+    CU_ASSERT(2 << 12 == b.len);
+    for (size_t i = 0; i < b.len; i++) {
+        CU_ASSERT((i & 1 ? 'b' : 'a') == b.data[i]);
+    }
+    CU_ASSERT('\0' == b.data[b.len]);
+
+    /* Part of the buffer. */
+    cu_buf_reset(&b);
+    CU_ASSERT(0 == cu_buf_append(&b, "0123456789", 10));
+    CU_ASSERT(0 == cu_buf_append(&b, &b.data[3], 4));
+    CU_ASSERT_STRING_EQUAL("01234567893456", b.data);
+
+    cu_buf_destroy(&b);
+}
+
+
+void test_detach_reset(void)
+{
+    cu_buf_t b = { 0 };
+    size_t len = 10;
+    char *s    = NULL;
+
+    CU_ASSERT(NULL == cu_buf_detach(&b, &len));
+    CU_ASSERT(0 == len);
+    CU_ASSERT(NULL == cu_buf_detach(NULL, &len));
+
+    cu_must_buf_append(&b, "hello", 5);
+    cu_buf_reset(&b);
+    CU_ASSERT(0 == b.len);
+    CU_ASSERT(0 < b.cap);
+    CU_ASSERT_STRING_EQUAL("", b.data);
+    cu_buf_reset(NULL);
+
+    cu_must_buf_append(&b, "world", 5);
+    s = cu_buf_detach(&b, &len);
+    CU_ASSERT_FATAL(NULL != s);
+    CU_ASSERT(5 == len);
+    CU_ASSERT_STRING_EQUAL("world", s);
+    CU_ASSERT(NULL == b.data);
+    CU_ASSERT(0 == b.len);
+    CU_ASSERT(0 == b.cap);
+    free(s);
+
+    cu_must_buf_append(&b, "again", 5);
+    s = cu_buf_detach(&b, NULL);
+    CU_ASSERT_STRING_EQUAL("again", s);
+    free(s);
+}
+
+
+void add_suites(CU_pSuite *suite)
+{
+    *suite = CU_add_suite("buf.c tests", NULL, NULL);
+    CU_add_test(*suite, "Test Append               ", test_append);
+    CU_add_test(*suite, "Test Append Self          ", test_append_self);
+    CU_add_test(*suite, "Test Reserve              ", test_reserve);
+    CU_add_test(*suite, "Test Append Formatted     ", test_appendf);
+    CU_add_test(*suite, "Test Detach and Reset     ", test_detach_reset);
+}
+
+
+/*----------------------------------------------------------------------------*/
+/*                             External Functions                             */
+/*----------------------------------------------------------------------------*/
+int main(void)
+{
+    unsigned rv     = 1;
+    CU_pSuite suite = NULL;
+
+    if (CUE_SUCCESS == CU_initialize_registry()) {
+        add_suites(&suite);
+
+        if (NULL != suite) {
+            CU_basic_set_mode(CU_BRM_VERBOSE);
+            CU_basic_run_tests();
+            printf("\n");
+            CU_basic_show_failures(CU_get_failure_list());
+            printf("\n\n");
+            rv = CU_get_number_of_tests_failed();
+        }
+
+        CU_cleanup_registry();
+    }
+
+    if (0 != rv) {
+        return 1;
+    }
+
+    return 0;
+}
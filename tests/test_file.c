@@ -59,6 +59,7 @@ void test_freadall(void)
     CU_ASSERT_FATAL(EINVAL == freadall("__invalid__", 0, (void **) &data, &len));
 
     close(fd);
+    unlink(filename);
 
     free(data);
 }
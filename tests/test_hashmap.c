@@ -5,6 +5,8 @@
  * Copied from https://github.com/sheredom/hashmap.h/blob/master/test/test.c
  * and modified to work in this build ecosystem.
  */
+#define _POSIX_C_SOURCE 200809L
+
 #include <CUnit/Basic.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -39,7 +41,7 @@ void test_create_boundary()
     CU_ASSERT(0 == hashmap_create(3, &h));
     hashmap_destroy(&h);
 
-    CU_ASSERT(0 != hashmap_create(0x80000001, &h));
+    CU_ASSERT(0 != hashmap_create(HASHMAP_MAX_SIZE + 1, &h));
 }
 
 void test_put()
@@ -293,6 +295,81 @@ void test_walk_all()
 }
 
 
+static int free_odd(void *context, struct hashmap_element *e)
+{
+    (void) context;
+
+    /* Free the key before asking for the element to be removed. */
+    if (1 & *(int *) e->data) {
+        free((char *) e->key);
+        return -1;
+    }
+    return 0;
+}
+
+
+static int clear_key(void *context, struct hashmap_element *e)
+{
+    (void) context;
+
+    e->key     = NULL;
+    e->key_len = 0;
+    return -1;
+}
+
+
+void test_remove_freed_keys()
+{
+    hashmap_t h;
+    int x[200];
+    char *keys[200];
+    char buf[16];
+
+    CU_ASSERT(0 == hashmap_create(16, &h));
+
+    for (int i = 0; i < 200; i++) {
+        x[i] = i;
+        snprintf(buf, sizeof(buf), "key-%d", i);
+        keys[i] = strdup(buf);
+        CU_ASSERT_FATAL(NULL != keys[i]);
+        CU_ASSERT(0 == hashmap_put(&h, keys[i], strlen(keys[i]), &x[i]));
+    }
+    CU_ASSERT(200 == hashmap_num_entries(&h));
+
+    CU_ASSERT(0 == hashmap_iterate_pairs(&h, free_odd, NULL));
+    CU_ASSERT(100 == hashmap_num_entries(&h));
+
+    for (int i = 0; i < 200; i++) {
+        snprintf(buf, sizeof(buf), "key-%d", i);
+        if (i & 1) {
+            CU_ASSERT(NULL == hashmap_get(&h, buf, strlen(buf)));
+        } else {
+            CU_ASSERT(&x[i] == hashmap_get(&h, buf, strlen(buf)));
+        }
+    }
+
+    /* The removed keys can be added again. */
+    for (int i = 1; i < 200; i += 2) {
+        snprintf(buf, sizeof(buf), "key-%d", i);
+        keys[i] = strdup(buf);
+        CU_ASSERT_FATAL(NULL != keys[i]);
+        CU_ASSERT(0 == hashmap_put(&h, keys[i], strlen(keys[i]), &x[i]));
+    }
+    CU_ASSERT(200 == hashmap_num_entries(&h));
+
+    /* Removing still works if the callback clears the key. */
+    CU_ASSERT(0 == hashmap_iterate_pairs(&h, clear_key, NULL));
+    CU_ASSERT(0 == hashmap_num_entries(&h));
+    for (int i = 0; i < 200; i++) {
+        CU_ASSERT(NULL == hashmap_get(&h, keys[i], strlen(keys[i])));
+        free(keys[i]);
+    }
+    CU_ASSERT(NULL == hashmap_get(&h, "", 0));
+
+    hashmap_destroy(&h);
+}
+
+
 static int walk_one(void *context, struct hashmap_element *e)
 {
     (*(int *) context) += e->key_len;
@@ -376,6 +453,29 @@ void test_issue_20()
 }
 
 
+void test_sequential_keys()
+{
+    hashmap_t h;
+    char keys[4096][8];
+
+    /* Keys like these used to hit a full probe chain long before the table
+     * was 75% full, so hashmap_put() gave up with -3. */
+    CU_ASSERT_FATAL(0 == hashmap_create(0, &h));
+    for (size_t i = 0; i < 4096; i++) {
+        int len = snprintf(keys[i], sizeof(keys[i]), "k%zu", i);
+
+        CU_ASSERT_FATAL(0 == hashmap_put(&h, keys[i], (size_t) len, keys[i]));
+    }
+
+    CU_ASSERT(4096 == hashmap_num_entries(&h));
+    for (size_t i = 0; i < 4096; i++) {
+        CU_ASSERT(keys[i] == hashmap_get(&h, keys[i], strlen(keys[i])));
+    }
+
+    hashmap_destroy(&h);
+}
+
+
 void simple_test()
 {
     hashmap_t h;
@@ -505,6 +605,301 @@ void test_boundary()
 }
 
 
+static int record_order(void *const context, void *const element)
+{
+    char **p = (char **) context;
+
+    **p = *(char *) element;
+    (*p)++;
+    return 0;
+}
+
+
+void test_insertion_order()
+{
+    hashmap_t h;
+    const char *keys = "qwertyuiopasdfghjklzxcvbnm";
+    char got[27]     = { 0 };
+    char *p          = got;
+
+    CU_ASSERT(0 == hashmap_create(1, &h));
+
+    for (size_t i = 0; i < 26; i++) {
+        CU_ASSERT(0 == hashmap_put(&h, &keys[i], 1, (void *) &keys[i]));
+    }
+
+    /* Iteration follows the insertion order, even across growth. */
+    CU_ASSERT(0 == hashmap_iterate(&h, record_order, &p));
+    CU_ASSERT_NSTRING_EQUAL(keys, got, 26);
+
+    /* Updating a key keeps its place, removing and adding moves it last. */
+    CU_ASSERT(0 == hashmap_put(&h, &keys[0], 1, (void *) &keys[0]));
+    CU_ASSERT(0 == hashmap_remove(&h, &keys[1], 1));
+    CU_ASSERT(0 == hashmap_put(&h, &keys[1], 1, (void *) &keys[1]));
+
+    memset(got, 0, sizeof(got));
+    p = got;
+    CU_ASSERT(0 == hashmap_iterate(&h, record_order, &p));
+    CU_ASSERT_NSTRING_EQUAL("qertyuiopasdfghjklzxcvbnmw", got, 26);
+
+    hashmap_destroy(&h);
+}
+
+
+void test_reclaim_holes()
+{
+    hashmap_t h;
+    char keys[64][16];
+    size_t table_size;
+
+    CU_ASSERT(0 == hashmap_create(64, &h));
+    table_size = h.table_size;
+
+    for (unsigned int i = 0; i < 64; i++) {
+        snprintf(keys[i], sizeof(keys[i]), "key%02u", i);
+    }
+
+    /* Churn through more keys than fit, but never hold more than a few, so
+     * the holes left behind must be reused instead of growing the table. */
+    for (int round = 0; round < 10; round++) {
+        for (int i = 0; i < 64; i++) {
+            CU_ASSERT(0 == hashmap_put(&h, keys[i], 5, keys[i]));
+            if (4 <= i) {
+                CU_ASSERT(0 == hashmap_remove(&h, keys[i - 4], 5));
+            }
+        }
+        for (int i = 60; i < 64; i++) {
+            CU_ASSERT(0 == hashmap_remove(&h, keys[i], 5));
+        }
+        CU_ASSERT(0 == hashmap_num_entries(&h));
+    }
+
+    CU_ASSERT(table_size == h.table_size);
+
+    for (int i = 0; i < 32; i++) {
+        CU_ASSERT(0 == hashmap_put(&h, keys[i], 5, keys[i]));
+    }
+    for (int i = 0; i < 32; i++) {
+        CU_ASSERT(keys[i] == hashmap_get(&h, keys[i], 5));
+    }
+    CU_ASSERT(32 == hashmap_num_entries(&h));
+
+    hashmap_destroy(&h);
+}
+
+
+void test_build()
+{
+    hashmap_t h;
+    const size_t n = 10000;
+    char (*keys)[16];
+    const char **k;
+    size_t *lens;
+    void **values;
+    char got[27] = { 0 };
+    char *p      = got;
+
+    keys   = calloc(n, sizeof(*keys));
+    k      = calloc(n, sizeof(char *));
+    lens   = calloc(n, sizeof(size_t));
+    values = calloc(n, sizeof(void *));
+    CU_ASSERT_FATAL(keys && k && lens && values);
+
+    /* The last 10 keys repeat earlier ones with new values. */
+    for (size_t i = 0; i < n; i++) {
+        lens[i]   = (size_t) snprintf(keys[i], sizeof(keys[i]), "k%zu", i % (n - 10));
+        k[i]      = keys[i];
+        values[i] = &keys[i];
+    }
+
+    CU_ASSERT_FATAL(0 == hashmap_build(k, lens, values, n, &h));
+    CU_ASSERT(n - 10 == hashmap_num_entries(&h));
+    CU_ASSERT(h.data_size >= n);
+
+    for (size_t i = 0; i < n - 10; i++) {
+        void *expect = (i < 10) ? values[n - 10 + i] : values[i];
+        CU_ASSERT(expect == hashmap_get(&h, keys[i], lens[i]));
+    }
+
+    /* The map works normally afterwards. */
+    CU_ASSERT(0 == hashmap_remove(&h, "k1", 2));
+    CU_ASSERT(0 == hashmap_put(&h, "new", 3, values[0]));
+    CU_ASSERT(values[0] == hashmap_get(&h, "new", 3));
+    CU_ASSERT(n - 10 == hashmap_num_entries(&h));
+    hashmap_destroy(&h);
+
+    /* Small tables keep the order of the input arrays. */
+    for (size_t i = 0; i < 26; i++) {
+        keys[i][0] = (char) ('z' - i);
+        k[i]       = keys[i];
+        lens[i]    = 1;
+        values[i]  = keys[i];
+    }
+    CU_ASSERT_FATAL(0 == hashmap_build(k, lens, values, 26, &h));
+    CU_ASSERT(0 == hashmap_iterate(&h, record_order, &p));
+    CU_ASSERT_NSTRING_EQUAL("zyxwvutsrqponmlkjihgfedcba", got, 26);
+    hashmap_destroy(&h);
+
+    CU_ASSERT(0 == hashmap_build(NULL, NULL, NULL, 0, &h));
+    CU_ASSERT(0 == hashmap_num_entries(&h));
+    hashmap_destroy(&h);
+
+    CU_ASSERT(-1 == hashmap_build(k, lens, values, 1, NULL));
+    CU_ASSERT(-1 == hashmap_build(NULL, lens, values, 1, &h));
+    CU_ASSERT(-1 == hashmap_build(k, lens, values, SIZE_MAX, &h));
+
+    free(keys);
+    free(k);
+    free(lens);
+    free(values);
+}
+
+
+void test_handles()
+{
+    hashmap_t h;
+    hashmap_handle_t handle;
+    hashmap_handle_t other;
+    char keys[100][16];
+    int x = 1;
+    int y = 2;
+
+    memset(&h, 0, sizeof(hashmap_t));
+
+    CU_ASSERT(-1 == hashmap_get_handle(NULL, "foo", 3, &handle));
+    CU_ASSERT(-1 == hashmap_get_handle(&h, "foo", 3, NULL));
+    CU_ASSERT(1 == hashmap_get_handle(&h, "foo", 3, &handle));
+
+    CU_ASSERT(0 == hashmap_put(&h, "foo", 3, &x));
+    CU_ASSERT(0 == hashmap_put(&h, "bar", 3, &y));
+    CU_ASSERT(0 == hashmap_get_handle(&h, "foo", 3, &handle));
+    CU_ASSERT(0 == hashmap_get_handle(&h, "bar", 3, &other));
+    CU_ASSERT(1 == hashmap_get_handle(&h, "baz", 3, &other));
+    CU_ASSERT(&x == hashmap_handle_get(&h, &handle));
+
+    /* Growing the hashmap does not move the elements. */
+    for (unsigned int i = 0; i < 100; i++) {
+        snprintf(keys[i], sizeof(keys[i]), "key%u", i);
+        CU_ASSERT(0 == hashmap_put(&h, keys[i], strlen(keys[i]), &y));
+    }
+    CU_ASSERT(&x == hashmap_handle_get(&h, &handle));
+    CU_ASSERT(0 == hashmap_handle_set(&h, &handle, &y));
+    CU_ASSERT(&y == hashmap_get(&h, "foo", 3));
+
+    /* Removing the element makes the handle stale. */
+    CU_ASSERT(0 == hashmap_remove(&h, "bar", 3));
+    CU_ASSERT(NULL == hashmap_handle_get(&h, &other));
+    CU_ASSERT(1 == hashmap_handle_set(&h, &other, &x));
+
+    /* Squeezing out the holes moves the elements and stales the handles. */
+    for (unsigned int i = 0; i < 100; i++) {
+        CU_ASSERT(0 == hashmap_remove(&h, keys[i], strlen(keys[i])));
+    }
+    for (unsigned int i = 0; i < 100; i++) {
+        CU_ASSERT(0 == hashmap_put(&h, keys[i], strlen(keys[i]), &x));
+    }
+    CU_ASSERT(NULL == hashmap_handle_get(&h, &handle));
+    CU_ASSERT(0 == hashmap_get_handle(&h, "foo", 3, &handle));
+    CU_ASSERT(&y == hashmap_handle_get(&h, &handle));
+
+    CU_ASSERT(NULL == hashmap_handle_get(NULL, &handle));
+    CU_ASSERT(NULL == hashmap_handle_get(&h, NULL));
+
+    hashmap_destroy(&h);
+}
+
+
+static int count_range(void *const context,
+                       const struct hashmap_element *const e)
+{
+    size_t *count = (size_t *) context;
+
+    CU_ASSERT(NULL != e->key);
+    (*count)++;
+
+    return 0;
+}
+
+
+static int stop_range(void *const context,
+                      const struct hashmap_element *const e)
+{
+    (void) context;
+    (void) e;
+
+    return 1;
+}
+
+
+void test_rehash()
+{
+    hashmap_t h;
+    const size_t n = 20000;
+    char (*keys)[16];
+    size_t count = 0;
+    size_t span  = 0;
+
+    memset(&h, 0, sizeof(hashmap_t));
+
+    keys = calloc(n, sizeof(*keys));
+    CU_ASSERT_FATAL(NULL != keys);
+
+    CU_ASSERT(-1 == hashmap_rehash(NULL, 0, 4));
+    CU_ASSERT(-1 == hashmap_rehash(&h, HASHMAP_MAX_SIZE + 1, 4));
+
+    /* An empty hashmap is simply created. */
+    CU_ASSERT(0 == hashmap_rehash(&h, 100, 4));
+    CU_ASSERT(128 == h.table_size);
+
+    for (size_t i = 0; i < n; i++) {
+        snprintf(keys[i], sizeof(keys[i]), "k%zu", i);
+        CU_ASSERT(0 == hashmap_put(&h, keys[i], strlen(keys[i]), keys[i]));
+    }
+
+    /* Leave holes in every other element. */
+    for (size_t i = 0; i < n; i += 2) {
+        CU_ASSERT(0 == hashmap_remove(&h, keys[i], strlen(keys[i])));
+    }
+
+    /* Grow using several threads; the holes are squeezed out. */
+    CU_ASSERT(0 == hashmap_rehash(&h, 4 * h.table_size, 4));
+    CU_ASSERT(n / 2 == h.data_used);
+    for (size_t i = 0; i < n; i++) {
+        void *expect = (i & 1) ? keys[i] : NULL;
+        CU_ASSERT(expect == hashmap_get(&h, keys[i], strlen(keys[i])));
+    }
+
+    /* Asking for too few slots keeps enough for the entries. */
+    CU_ASSERT(0 == hashmap_rehash(&h, 1, 8));
+    CU_ASSERT(n / 2 <= h.data_size);
+    CU_ASSERT(h.table_size < 4 * 32768);
+    for (size_t i = 1; i < n; i += 2) {
+        CU_ASSERT(keys[i] == hashmap_get(&h, keys[i], strlen(keys[i])));
+    }
+
+    /* More threads than allowed are capped, 0 means one. */
+    CU_ASSERT(0 == hashmap_rehash(&h, 0, 1000));
+    CU_ASSERT(0 == hashmap_rehash(&h, 0, 0));
+    CU_ASSERT(n / 2 == hashmap_num_entries(&h));
+
+    /* Split the scan into uneven ranges, each element is seen once. */
+    span = hashmap_range_size(&h);
+    CU_ASSERT(n / 2 == span);
+    CU_ASSERT(0 == hashmap_iterate_range(&h, 0, 3, count_range, &count));
+    CU_ASSERT(0 == hashmap_iterate_range(&h, 3, span / 2, count_range, &count));
+    CU_ASSERT(0 == hashmap_iterate_range(&h, span / 2, SIZE_MAX, count_range, &count));
+    CU_ASSERT(n / 2 == count);
+
+    CU_ASSERT(1 == hashmap_iterate_range(&h, 0, span, stop_range, NULL));
+    CU_ASSERT(0 == hashmap_iterate_range(&h, span, span + 10, stop_range, NULL));
+    CU_ASSERT(0 == hashmap_iterate_range(NULL, 0, span, stop_range, NULL));
+    CU_ASSERT(0 == hashmap_range_size(NULL));
+
+    hashmap_destroy(&h);
+    free(keys);
+}
+
+
 void add_suites(CU_pSuite *suite)
 {
     *suite = CU_add_suite("hashmap.c tests", NULL, NULL);
@@ -520,15 +915,22 @@ void add_suites(CU_pSuite *suite)
     CU_add_test(*suite, "hashmap_iterate() Test (all)", test_iterate_all);
     CU_add_test(*suite, "hashmap_num_entries() Test", test_num_entries);
     CU_add_test(*suite, "hashmap_iterate_pairs() Test (remove all)", test_remove_all);
+    CU_add_test(*suite, "hashmap_iterate_pairs() Test (free keys)", test_remove_freed_keys);
     CU_add_test(*suite, "hashmap_iterate_pairs() Test (walk all)", test_walk_all);
     CU_add_test(*suite, "hashmap_iterate_pairs() Test (walk one)", test_walk_one);
     CU_add_test(*suite, "Test hash conflict", test_hash_conflict);
     CU_add_test(*suite, "Test issue 20", test_issue_20);
+    CU_add_test(*suite, "Test sequential keys", test_sequential_keys);
     CU_add_test(*suite, "Simple Test", simple_test);
     CU_add_test(*suite, "Simple No Pointer Test", simple_no_ptr_test);
     CU_add_test(*suite, "Empty Hashmap Test", test_empty);
     CU_add_test(*suite, "Null Hashmap Test", test_null);
     CU_add_test(*suite, "Simple Boundary Tests", test_boundary);
+    CU_add_test(*suite, "Insertion Order Test", test_insertion_order);
+    CU_add_test(*suite, "Reclaim Holes Test", test_reclaim_holes);
+    CU_add_test(*suite, "hashmap_build() Test", test_build);
+    CU_add_test(*suite, "Handle Test", test_handles);
+    CU_add_test(*suite, "Rehash Test", test_rehash);
 }
 
 
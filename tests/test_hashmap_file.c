@@ -0,0 +1,395 @@
+/* SPDX-FileCopyrightText: 2026 Comcast Cable Communications Management, LLC */
+/* SPDX-License-Identifier: Apache-2.0 */
+#define _POSIX_C_SOURCE 200809L
+
+#include <CUnit/Basic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "file.h"
+#include "hashmap_file.h"
+
+#define TEST_FILE "test_hashmap_file.map"
+#define COPY_FILE "test_hashmap_file.copy"
+
+
+static int has(hashmap_file_t *m, const char *key, const char *expect)
+{
+    const void *value = NULL;
+    size_t len        = 0;
+
+    if (0 != hashmap_file_get(m, key, strlen(key), &value, &len)) {
+        return 0;
+    }
+
+    return (len == strlen(expect)) && (0 == memcmp(value, expect, len));
+}
+
+
+/* Copies the file as it is on disk right now, as a crash would leave it. */
+static void copy_file(const char *from, const char *to)
+{
+    void *data = NULL;
+    size_t len = 0;
+    FILE *f    = NULL;
+
+    CU_ASSERT_FATAL(0 == freadall(from, 0, &data, &len));
+    f = fopen(to, "wb");
+    CU_ASSERT_FATAL(NULL != f);
+    CU_ASSERT(len == fwrite(data, 1, len, f));
+    fclose(f);
+    free(data);
+}
+
+
+static void write_file(const char *path, const void *data, size_t len)
+{
+    FILE *f = fopen(path, "wb");
+
+    CU_ASSERT_FATAL(NULL != f);
+    CU_ASSERT(len == fwrite(data, 1, len, f));
+    fclose(f);
+}
+
+
+static int count_all(void *const context, const void *key, size_t key_len,
+                     const void *value, size_t value_len)
+{
+    size_t *count = (size_t *) context;
+
+    (void) key;
+    (void) value;
+    CU_ASSERT(0 < key_len);
+    CU_ASSERT(0 < value_len);
+    (*count)++;
+
+    return 0;
+}
+
+
+static int stop(void *const context, const void *key, size_t key_len,
+                const void *value, size_t value_len)
+{
+    (void) context;
+    (void) key;
+    (void) key_len;
+    (void) value;
+    (void) value_len;
+
+    return 1;
+}
+
+
+void test_basic(void)
+{
+    hashmap_file_t m;
+    const void *value = NULL;
+    size_t len        = 0;
+
+    unlink(TEST_FILE);
+
+    CU_ASSERT(-1 == hashmap_file_open(NULL, &m));
+    CU_ASSERT(-1 == hashmap_file_open(TEST_FILE, NULL));
+
+    CU_ASSERT_FATAL(0 == hashmap_file_open(TEST_FILE, &m));
+    CU_ASSERT(0 == hashmap_file_num_entries(&m));
+
+    CU_ASSERT(0 == hashmap_file_put(&m, "foo", 3, "one", 3));
+    CU_ASSERT(0 == hashmap_file_put(&m, "bar", 3, "two", 3));
+    CU_ASSERT(0 == hashmap_file_put(&m, "", 0, "empty", 5));
+    CU_ASSERT(0 == hashmap_file_put(&m, "nothing", 7, NULL, 0));
+    CU_ASSERT(4 == hashmap_file_num_entries(&m));
+
+    CU_ASSERT(has(&m, "foo", "one"));
+    CU_ASSERT(has(&m, "bar", "two"));
+    CU_ASSERT(has(&m, "", "empty"));
+    CU_ASSERT(has(&m, "nothing", ""));
+    CU_ASSERT(1 == hashmap_file_get(&m, "baz", 3, &value, &len));
+
+    /* Replace and remove. */
+    CU_ASSERT(0 == hashmap_file_put(&m, "foo", 3, "three", 5));
+    CU_ASSERT(has(&m, "foo", "three"));
+    CU_ASSERT(0 == hashmap_file_remove(&m, "bar", 3));
+    CU_ASSERT(1 == hashmap_file_remove(&m, "bar", 3));
+    CU_ASSERT(1 == hashmap_file_get(&m, "bar", 3, &value, &len));
+    CU_ASSERT(3 == hashmap_file_num_entries(&m));
+
+    CU_ASSERT(-1 == hashmap_file_put(NULL, "foo", 3, "one", 3));
+    CU_ASSERT(-1 == hashmap_file_put(&m, NULL, 3, "one", 3));
+    CU_ASSERT(-1 == hashmap_file_put(&m, "foo", 3, NULL, 3));
+    CU_ASSERT(-1 == hashmap_file_get(&m, "foo", 3, NULL, &len));
+    CU_ASSERT(-1 == hashmap_file_get(&m, "foo", 3, &value, NULL));
+    CU_ASSERT(-1 == hashmap_file_remove(&m, NULL, 3));
+    CU_ASSERT(-1 == hashmap_file_sync(NULL));
+    CU_ASSERT(0 == hashmap_file_num_entries(NULL));
+    CU_ASSERT(0 == hashmap_file_iterate(NULL, stop, NULL));
+
+    CU_ASSERT(0 == hashmap_file_close(&m));
+    CU_ASSERT(-1 == hashmap_file_close(&m));
+
+    /* Everything is still there after reopening. */
+    CU_ASSERT_FATAL(0 == hashmap_file_open(TEST_FILE, &m));
+    CU_ASSERT(3 == hashmap_file_num_entries(&m));
+    CU_ASSERT(has(&m, "foo", "three"));
+    CU_ASSERT(has(&m, "", "empty"));
+    CU_ASSERT(has(&m, "nothing", ""));
+    CU_ASSERT(1 == hashmap_file_get(&m, "bar", 3, &value, &len));
+    CU_ASSERT(0 == hashmap_file_close(&m));
+
+    unlink(TEST_FILE);
+}
+
+
+void test_growth(void)
+{
+    hashmap_file_t m;
+    char key[32];
+    char value[128];
+    size_t count = 0;
+
+    unlink(TEST_FILE);
+    CU_ASSERT_FATAL(0 == hashmap_file_open(TEST_FILE, &m));
+
+    /* Enough to outgrow both the index and the log several times. */
+    for (unsigned int i = 0; i < 5000; i++) {
+        snprintf(key, sizeof(key), "key%u", i);
+        snprintf(value, sizeof(value), "%0100u", i);
+        CU_ASSERT(0 == hashmap_file_put(&m, key, strlen(key), value, strlen(value)));
+    }
+
+    /* Remove and replace enough to make the log mostly dead. */
+    for (unsigned int round = 0; round < 4; round++) {
+        for (unsigned int i = 0; i < 5000; i += 2) {
+            snprintf(key, sizeof(key), "key%u", i);
+            snprintf(value, sizeof(value), "%0100u", i + round);
+            CU_ASSERT(0 == hashmap_file_put(&m, key, strlen(key), value, strlen(value)));
+        }
+    }
+    for (unsigned int i = 1; i < 5000; i += 2) {
+        snprintf(key, sizeof(key), "key%u", i);
+        CU_ASSERT(0 == hashmap_file_remove(&m, key, strlen(key)));
+    }
+    CU_ASSERT(2500 == hashmap_file_num_entries(&m));
+    CU_ASSERT(0 == hashmap_file_close(&m));
+
+    CU_ASSERT_FATAL(0 == hashmap_file_open(TEST_FILE, &m));
+    CU_ASSERT(2500 == hashmap_file_num_entries(&m));
+    for (unsigned int i = 0; i < 5000; i++) {
+        const void *v = NULL;
+        size_t len    = 0;
+
+        snprintf(key, sizeof(key), "key%u", i);
+        if (i & 1) {
+            CU_ASSERT(1 == hashmap_file_get(&m, key, strlen(key), &v, &len));
+        } else {
+            snprintf(value, sizeof(value), "%0100u", i + 3);
+            CU_ASSERT(has(&m, key, value));
+        }
+    }
+
+    CU_ASSERT(0 == hashmap_file_iterate(&m, count_all, &count));
+    CU_ASSERT(2500 == count);
+    CU_ASSERT(1 == hashmap_file_iterate(&m, stop, NULL));
+
+    CU_ASSERT(0 == hashmap_file_close(&m));
+    unlink(TEST_FILE);
+}
+
+
+void test_crash(void)
+{
+    hashmap_file_t m;
+    hashmap_file_t c;
+
+    unlink(TEST_FILE);
+    unlink(COPY_FILE);
+    CU_ASSERT_FATAL(0 == hashmap_file_open(TEST_FILE, &m));
+
+    CU_ASSERT(0 == hashmap_file_put(&m, "kept", 4, "one", 3));
+    CU_ASSERT(0 == hashmap_file_put(&m, "gone", 4, "two", 3));
+    CU_ASSERT(0 == hashmap_file_sync(&m));
+
+    /* These are not synced, so a crash loses them. */
+    CU_ASSERT(0 == hashmap_file_put(&m, "lost", 4, "three", 5));
+    CU_ASSERT(0 == hashmap_file_put(&m, "kept", 4, "four", 4));
+    CU_ASSERT(0 == hashmap_file_remove(&m, "gone", 4));
+
+    copy_file(TEST_FILE, COPY_FILE);
+    CU_ASSERT(0 == hashmap_file_close(&m));
+
+    CU_ASSERT_FATAL(0 == hashmap_file_open(COPY_FILE, &c));
+    CU_ASSERT(2 == hashmap_file_num_entries(&c));
+    CU_ASSERT(has(&c, "kept", "one"));
+    CU_ASSERT(has(&c, "gone", "two"));
+    CU_ASSERT(!has(&c, "lost", "three"));
+
+    /* The recovered file carries on as normal. */
+    CU_ASSERT(0 == hashmap_file_put(&c, "new", 3, "five", 4));
+    CU_ASSERT(0 == hashmap_file_close(&c));
+    CU_ASSERT_FATAL(0 == hashmap_file_open(COPY_FILE, &c));
+    CU_ASSERT(3 == hashmap_file_num_entries(&c));
+    CU_ASSERT(has(&c, "new", "five"));
+    CU_ASSERT(0 == hashmap_file_close(&c));
+
+    /* The original has everything. */
+    CU_ASSERT_FATAL(0 == hashmap_file_open(TEST_FILE, &m));
+    CU_ASSERT(2 == hashmap_file_num_entries(&m));
+    CU_ASSERT(has(&m, "kept", "four"));
+    CU_ASSERT(has(&m, "lost", "three"));
+    CU_ASSERT(0 == hashmap_file_close(&m));
+
+    unlink(TEST_FILE);
+    unlink(COPY_FILE);
+}
+
+
+void test_corrupt(void)
+{
+    hashmap_file_t m;
+    char garbage[8192];
+    unsigned char *data = NULL;
+    size_t len          = 0;
+
+    unlink(TEST_FILE);
+
+    memset(garbage, 'x', sizeof(garbage));
+    write_file(TEST_FILE, garbage, 100);
+    CU_ASSERT(-5 == hashmap_file_open(TEST_FILE, &m));
+    write_file(TEST_FILE, garbage, sizeof(garbage));
+    CU_ASSERT(-5 == hashmap_file_open(TEST_FILE, &m));
+    unlink(TEST_FILE);
+
+    /* Generations: 1 created, 2 dirty, 3 synced, 4 dirty, 5 closed. */
+    CU_ASSERT_FATAL(0 == hashmap_file_open(TEST_FILE, &m));
+    CU_ASSERT(0 == hashmap_file_put(&m, "first", 5, "1", 1));
+    CU_ASSERT(0 == hashmap_file_sync(&m));
+    CU_ASSERT(0 == hashmap_file_put(&m, "second", 6, "2", 1));
+    CU_ASSERT(0 == hashmap_file_close(&m));
+
+    /* Break the newest header, the one before it is used instead. */
+    CU_ASSERT_FATAL(0 == freadall(TEST_FILE, 0, (void **) &data, &len));
+    data[2048 + 9] ^= 0xff;
+    write_file(TEST_FILE, data, len);
+    free(data);
+
+    CU_ASSERT_FATAL(0 == hashmap_file_open(TEST_FILE, &m));
+    CU_ASSERT(1 == hashmap_file_num_entries(&m));
+    CU_ASSERT(has(&m, "first", "1"));
+    CU_ASSERT(!has(&m, "second", "2"));
+    CU_ASSERT(0 == hashmap_file_close(&m));
+
+    unlink(TEST_FILE);
+}
+
+
+/* Writes a copy of the file with the 8 bytes at off replaced by value. */
+static void patch_file(const unsigned char *data, size_t len, size_t off,
+                       uint64_t value)
+{
+    unsigned char *copy = malloc(len);
+
+    CU_ASSERT_FATAL(NULL != copy);
+    memcpy(copy, data, len);
+    memcpy(&copy[off], &value, sizeof(value));
+    write_file(TEST_FILE, copy, len);
+    free(copy);
+}
+
+
+void test_damaged(void)
+{
+    hashmap_file_t m;
+    unsigned char *data = NULL;
+    size_t len          = 0;
+    size_t slot         = 0;
+    uint64_t off        = 0;
+
+    unlink(TEST_FILE);
+
+    CU_ASSERT_FATAL(0 == hashmap_file_open(TEST_FILE, &m));
+    CU_ASSERT(0 == hashmap_file_put(&m, "key", 3, "value", 5));
+    CU_ASSERT(0 == hashmap_file_close(&m));
+
+    CU_ASSERT_FATAL(0 == freadall(TEST_FILE, 0, (void **) &data, &len));
+
+    /* Find the one used index slot, right after the header page. */
+    for (size_t i = 0; i < 1024; i++) {
+        memcpy(&off, &data[4096 + i * 8], sizeof(off));
+        if (off) {
+            slot = 4096 + i * 8;
+            break;
+        }
+    }
+    CU_ASSERT_FATAL(0 != slot);
+
+    /* The file is clean, so nothing is replayed; the damage must still be
+     * caught instead of read past the end of the file. */
+    patch_file(data, len, slot, len);
+    CU_ASSERT(-5 == hashmap_file_open(TEST_FILE, &m));
+    patch_file(data, len, slot, UINT64_MAX - 7);
+    CU_ASSERT(-5 == hashmap_file_open(TEST_FILE, &m));
+    patch_file(data, len, slot, off + 1);
+    CU_ASSERT(-5 == hashmap_file_open(TEST_FILE, &m));
+    patch_file(data, len, slot, 4096);
+    CU_ASSERT(-5 == hashmap_file_open(TEST_FILE, &m));
+
+    /* A key length past the end of the log. */
+    patch_file(data, len, (size_t) off + 8, UINT64_MAX);
+    CU_ASSERT(-5 == hashmap_file_open(TEST_FILE, &m));
+    patch_file(data, len, (size_t) off + 8, len);
+    CU_ASSERT(-5 == hashmap_file_open(TEST_FILE, &m));
+
+    /* The undamaged file still opens. */
+    write_file(TEST_FILE, data, len);
+    CU_ASSERT_FATAL(0 == hashmap_file_open(TEST_FILE, &m));
+    CU_ASSERT(has(&m, "key", "value"));
+    CU_ASSERT(0 == hashmap_file_close(&m));
+
+    free(data);
+    unlink(TEST_FILE);
+}
+
+
+void add_suites(CU_pSuite *suite)
+{
+    *suite = CU_add_suite("hashmap_file.c tests", NULL, NULL);
+    CU_add_test(*suite, "Basic Test", test_basic);
+    CU_add_test(*suite, "Growth Test", test_growth);
+    CU_add_test(*suite, "Crash Test", test_crash);
+    CU_add_test(*suite, "Corrupt Test", test_corrupt);
+    CU_add_test(*suite, "Damaged Test", test_damaged);
+}
+
+
+/*----------------------------------------------------------------------------*/
+/*                             External Functions                             */
+/*----------------------------------------------------------------------------*/
+int main(void)
+{
+    unsigned rv     = 1;
+    CU_pSuite suite = NULL;
+
+    if (CUE_SUCCESS == CU_initialize_registry()) {
+        add_suites(&suite);
+
+        if (NULL != suite) {
+            CU_basic_set_mode(CU_BRM_VERBOSE);
+            CU_basic_run_tests();
+            printf("\n");
+            CU_basic_show_failures(CU_get_failure_list());
+            printf("\n\n");
+            rv = CU_get_number_of_tests_failed();
+        }
+
+        CU_cleanup_registry();
+    }
+
+    if (0 != rv) {
+        return 1;
+    }
+
+    return 0;
+}
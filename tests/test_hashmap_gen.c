@@ -0,0 +1,213 @@
+/* SPDX-FileCopyrightText: 2026 Comcast Cable Communications Management, LLC */
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#include <CUnit/Basic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hashmap_gen.h"
+
+struct point {
+    int x;
+    int y;
+};
+
+static inline uint64_t u32_hash(uint32_t k)
+{
+    return k;
+}
+
+static inline int u32_eq(uint32_t a, uint32_t b)
+{
+    return a == b;
+}
+
+static inline uint64_t str_hash(const char *s)
+{
+    uint64_t h = 0xcbf29ce484222325ULL;
+
+    while (*s) {
+        h ^= (uint8_t) *s++;
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+#define str_eq(a, b) (0 == strcmp((a), (b)))
+
+/* Every key lands in the same slot. */
+#define bad_hash(k) (0 * (k))
+
+CU_HASHMAP_DECLARE(u32map, uint32_t, struct point, u32_hash, u32_eq)
+CU_HASHMAP_DECLARE(strmap, const char *, int, str_hash, str_eq)
+CU_HASHMAP_DECLARE(badmap, uint32_t, int, bad_hash, u32_eq)
+
+
+static int sum_x(void *const context, u32map_entry_t *const e)
+{
+    uint64_t *sum = (uint64_t *) context;
+
+    *sum += (uint64_t) e->value.x;
+
+    return 0;
+}
+
+
+static int stop(void *const context, strmap_entry_t *const e)
+{
+    (void) context;
+    (void) e;
+
+    return 1;
+}
+
+
+void test_basic(void)
+{
+    u32map_t m;
+    struct point p = { 1, 2 };
+    struct point *got;
+    uint64_t sum = 0;
+
+    memset(&m, 0, sizeof(m));
+
+    CU_ASSERT(NULL == u32map_get(&m, 1));
+    CU_ASSERT(1 == u32map_remove(&m, 1));
+    CU_ASSERT(0 == u32map_num_entries(&m));
+
+    CU_ASSERT(0 == u32map_put(&m, 1, p));
+    got = u32map_get(&m, 1);
+    CU_ASSERT_FATAL(NULL != got);
+    CU_ASSERT(1 == got->x);
+    CU_ASSERT(2 == got->y);
+
+    /* Values are stored inline and can be changed in place. */
+    got->y = 5;
+    CU_ASSERT(5 == u32map_get(&m, 1)->y);
+
+    p.x = 3;
+    CU_ASSERT(0 == u32map_put(&m, 1, p));
+    CU_ASSERT(3 == u32map_get(&m, 1)->x);
+    CU_ASSERT(1 == u32map_num_entries(&m));
+
+    /* Grow well past the default size. */
+    for (uint32_t i = 2; i <= 100000; i++) {
+        p.x = (int) i;
+        CU_ASSERT(0 == u32map_put(&m, i, p));
+    }
+    CU_ASSERT(100000 == u32map_num_entries(&m));
+    for (uint32_t i = 2; i <= 100000; i++) {
+        got = u32map_get(&m, i);
+        CU_ASSERT_FATAL(NULL != got);
+        CU_ASSERT((int) i == got->x);
+    }
+
+    for (uint32_t i = 2; i <= 100000; i += 2) {
+        CU_ASSERT(0 == u32map_remove(&m, i));
+    }
+    CU_ASSERT(1 == u32map_remove(&m, 2));
+    CU_ASSERT(NULL == u32map_get(&m, 2));
+    CU_ASSERT(50000 == u32map_num_entries(&m));
+
+    /* 3 + 3 + 5 + ... + 99999 */
+    CU_ASSERT(0 == u32map_iterate(&m, sum_x, &sum));
+    CU_ASSERT(3 + (uint64_t) 50000 * 50000 - 1 == sum);
+
+    u32map_destroy(&m);
+    CU_ASSERT(0 == u32map_num_entries(&m));
+    u32map_destroy(NULL);
+
+    CU_ASSERT(-1 == u32map_put(NULL, 1, p));
+    CU_ASSERT(NULL == u32map_get(NULL, 1));
+    CU_ASSERT(1 == u32map_remove(NULL, 1));
+    CU_ASSERT(0 == u32map_num_entries(NULL));
+}
+
+
+void test_strings(void)
+{
+    strmap_t m;
+    char a[] = "key";
+    char b[] = "key";
+
+    CU_ASSERT(-1 == strmap_create(HASHMAP_MAX_SIZE + 1, &m));
+    CU_ASSERT(-1 == strmap_create(0, NULL));
+    CU_ASSERT_FATAL(0 == strmap_create(100, &m));
+    CU_ASSERT(128 == m.table_size);
+
+    /* Equal strings at different addresses are the same key. */
+    CU_ASSERT(0 == strmap_put(&m, a, 1));
+    CU_ASSERT(0 == strmap_put(&m, b, 2));
+    CU_ASSERT(1 == strmap_num_entries(&m));
+    CU_ASSERT(2 == *strmap_get(&m, "key"));
+
+    CU_ASSERT(1 == strmap_iterate(&m, stop, NULL));
+    CU_ASSERT(0 == strmap_remove(&m, "key"));
+    CU_ASSERT(0 == strmap_iterate(&m, stop, NULL));
+
+    strmap_destroy(&m);
+}
+
+
+void test_collisions(void)
+{
+    badmap_t m;
+    int rv = 0;
+
+    memset(&m, 0, sizeof(m));
+
+    /* Like hashmap_t, grow on a collision only while at least 25% full. */
+    for (uint32_t i = 0; (0 == rv) && (i < 1000); i++) {
+        rv = badmap_put(&m, i, (int) i);
+    }
+    CU_ASSERT(-3 == rv);
+    CU_ASSERT(m.size < 64);
+
+    for (uint32_t i = 0; i < m.size; i++) {
+        CU_ASSERT((int) i == *badmap_get(&m, i));
+    }
+
+    badmap_destroy(&m);
+}
+
+
+void add_suites(CU_pSuite *suite)
+{
+    *suite = CU_add_suite("hashmap_gen.h tests", NULL, NULL);
+    CU_add_test(*suite, "Basic Test", test_basic);
+    CU_add_test(*suite, "String Key Test", test_strings);
+    CU_add_test(*suite, "Collision Test", test_collisions);
+}
+
+
+/*----------------------------------------------------------------------------*/
+/*                             External Functions                             */
+/*----------------------------------------------------------------------------*/
+int main(void)
+{
+    unsigned rv     = 1;
+    CU_pSuite suite = NULL;
+
+    if (CUE_SUCCESS == CU_initialize_registry()) {
+        add_suites(&suite);
+
+        if (NULL != suite) {
+            CU_basic_set_mode(CU_BRM_VERBOSE);
+            CU_basic_run_tests();
+            printf("\n");
+            CU_basic_show_failures(CU_get_failure_list());
+            printf("\n\n");
+            rv = CU_get_number_of_tests_failed();
+        }
+
+        CU_cleanup_registry();
+    }
+
+    if (0 != rv) {
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,106 @@
+/* SPDX-FileCopyrightText: 2026 Comcast Cable Communications Management, LLC */
+/* SPDX-License-Identifier: Apache-2.0 */
+#define _POSIX_C_SOURCE 200809L
+
+#include <CUnit/Basic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Include the source so the static hash function can be called directly,
+ * without allocating a table big enough to need the 64 bit hash. */
+#include "../src/hashmap.c"
+
+#define KEYS (65536)
+
+
+/* The inverse of Knuth's multiplier mod 2^32. */
+static uint32_t knuth_inverse(void)
+{
+    uint32_t c = 2654435761u;
+    uint32_t x = c;
+
+    /* Each Newton step doubles the number of correct low bits. */
+    for (int i = 0; i < 5; i++) {
+        x *= 2 - c * x;
+    }
+
+    return x;
+}
+
+
+/* Counts the keys whose home slot in a table of 2^bits slots could not come
+ * from the 32 bit hash.  It multiplies a value below 2^29 by an odd
+ * constant, so it only reaches the slots where bit 29 of slot * C^-1 is
+ * clear. */
+static size_t count_unreachable(int bits)
+{
+    uint32_t inv = knuth_inverse();
+    size_t size  = (size_t) 1 << bits;
+    size_t count = 0;
+    char key[32];
+
+    for (int i = 0; i < KEYS; i++) {
+        int len     = snprintf(key, sizeof(key), "key-%d", i);
+        size_t slot = hashmap_hash_helper_int_helper(size, key, (size_t) len);
+
+        CU_ASSERT(slot < size);
+        if ((((uint32_t) slot * inv) & (size - 1)) >> 29) {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+
+void test_reach()
+{
+    CU_ASSERT(HASHMAP_HASH64_THRESHOLD <= ((uint64_t) 1 << 29));
+
+    /* Above that, about half of the keys land in slots the 32 bit hash
+     * can't reach at 2^30 slots, and 3/4 of them at 2^31. */
+    CU_ASSERT(KEYS * 4 / 10 < count_unreachable(30));
+    CU_ASSERT(count_unreachable(30) < KEYS * 6 / 10);
+    CU_ASSERT(KEYS * 65 / 100 < count_unreachable(31));
+    CU_ASSERT(count_unreachable(31) < KEYS * 85 / 100);
+}
+
+
+void add_suites(CU_pSuite *suite)
+{
+    *suite = CU_add_suite("hashmap.c tests", NULL, NULL);
+    CU_add_test(*suite, "Test Home Slot Reach      ", test_reach);
+}
+
+
+/*----------------------------------------------------------------------------*/
+/*                             External Functions                             */
+/*----------------------------------------------------------------------------*/
+int main(void)
+{
+    unsigned rv     = 1;
+    CU_pSuite suite = NULL;
+
+    if (CUE_SUCCESS == CU_initialize_registry()) {
+        add_suites(&suite);
+
+        if (NULL != suite) {
+            CU_basic_set_mode(CU_BRM_VERBOSE);
+            CU_basic_run_tests();
+            printf("\n");
+            CU_basic_show_failures(CU_get_failure_list());
+            printf("\n\n");
+            rv = CU_get_number_of_tests_failed();
+        }
+
+        CU_cleanup_registry();
+    }
+
+    if (0 != rv) {
+        return 1;
+    }
+
+    return 0;
+}
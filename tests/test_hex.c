@@ -0,0 +1,230 @@
+/* SPDX-FileCopyrightText: 2026 Comcast Cable Communications Management, LLC */
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#include <CUnit/Basic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hex.h"
+
+
+/* The slow, obviously correct encoder to compare against. */
+static size_t ref_encode(int opts, const uint8_t *in, size_t len, char *out)
+{
+    const char *fmt = (CU_HEX_UPPER & opts) ? "%02X" : "%02x";
+    char sep        = (char) ((unsigned) opts >> 8);
+    size_t j        = 0;
+
+    for (size_t i = 0; i < len; i++) {
+        if (sep && i) {
+            out[j++] = sep;
+        }
+        snprintf(&out[j], 3, fmt, in[i]);
+        j += 2;
+    }
+
+    return j;
+}
+
+
+void test_encode_decode(void)
+{
+    int opts[] = { CU_HEX_LOWER, CU_HEX_UPPER, CU_HEX_SEP(':'),
+                   CU_HEX_UPPER | CU_HEX_SEP('-') };
+    uint8_t in[300];
+    char expect[900];
+    uint32_t seed = 1;
+
+    for (size_t i = 0; i < sizeof(in); i++) {
+        seed  = seed * 1103515245u + 12345u;
+        in[i] = (uint8_t) (seed >> 16);
+    }
+
+    for (size_t o = 0; o < sizeof(opts) / sizeof(int); o++) {
+        for (size_t len = 1; len < sizeof(in); len++) {
+            size_t expect_len = ref_encode(opts[o], in, len, expect);
+            char *enc         = NULL;
+            uint8_t *dec      = NULL;
+            size_t enc_len    = 0;
+            size_t dec_len    = 0;
+
+            CU_ASSERT(CU_HEX_ENCODED_LEN(opts[o], len) == expect_len);
+            CU_ASSERT(CU_HEX_DECODED_LEN(opts[o], expect_len) == len);
+
+            CU_ASSERT_FATAL(0 == cu_hex_encode(opts[o], in, len, &enc, &enc_len));
+            CU_ASSERT(expect_len == enc_len);
+            CU_ASSERT(0 == memcmp(expect, enc, expect_len));
+            CU_ASSERT('\0' == enc[enc_len]);
+
+            CU_ASSERT_FATAL(0 == cu_hex_decode(opts[o], enc, enc_len, (void **) &dec, &dec_len));
+            CU_ASSERT(len == dec_len);
+            CU_ASSERT(0 == memcmp(in, dec, len));
+            CU_ASSERT('\0' == dec[dec_len]);
+
+            /* Just the lengths. */
+            CU_ASSERT(0 == cu_hex_encode(opts[o], in, len, NULL, &enc_len));
+            CU_ASSERT(expect_len == enc_len);
+            CU_ASSERT(0 == cu_hex_decode(opts[o], enc, expect_len, NULL, &dec_len));
+            CU_ASSERT(len == dec_len);
+
+            free(enc);
+            free(dec);
+        }
+    }
+}
+
+
+void test_decode_case(void)
+{
+    const char *mixed = "0123456789abcdefABCDEF0123456789abcdefABCDEF0123456789abcdefABCDEF0123456789aBcDeF";
+    uint8_t *out      = NULL;
+    size_t len        = 0;
+
+    CU_ASSERT_FATAL(0 == cu_hex_decode(CU_HEX_LOWER, mixed, strlen(mixed), (void **) &out, &len));
+    CU_ASSERT(41 == len);
+    CU_ASSERT(0x01 == out[0]);
+    CU_ASSERT(0xef == out[7]);
+    CU_ASSERT(0xab == out[8]);
+    CU_ASSERT(0xab == out[38]);
+    CU_ASSERT(0xef == out[40]);
+    free(out);
+}
+
+
+void test_decode_errors(void)
+{
+    char enc[300];
+    uint8_t out[150];
+    size_t len = 0;
+
+    memset(enc, 'a', sizeof(enc));
+
+    /* Every invalid character everywhere, including in the SIMD blocks. */
+    for (size_t i = 0; i < sizeof(enc); i += 7) {
+        for (int c = 0; c < 256; c++) {
+            int valid = (('0' <= c) && (c <= '9')) || (('a' <= c) && (c <= 'f'))
+                        || (('A' <= c) && (c <= 'F'));
+            void *p   = out;
+
+            enc[i] = (char) c;
+            len    = sizeof(out);
+            CU_ASSERT((valid ? 0 : -1) == cu_hex_decode(CU_HEX_PROVIDED, enc, sizeof(enc), &p, &len));
+            CU_ASSERT((valid ? 0 : -1) == cu_hex_decode(CU_HEX_LOWER, enc, sizeof(enc), NULL, &len));
+        }
+        enc[i] = 'a';
+    }
+
+    CU_ASSERT(-2 == cu_hex_decode(CU_HEX_LOWER, "abc", 3, NULL, &len));
+    CU_ASSERT(0 == len);
+
+    /* Separators. */
+    CU_ASSERT(0 == cu_hex_decode(CU_HEX_SEP(':'), "00:11:22:aa:bb:CC", 17, NULL, &len));
+    CU_ASSERT(6 == len);
+    CU_ASSERT(0 == cu_hex_decode(CU_HEX_SEP(':'), "0a", 2, NULL, &len));
+    CU_ASSERT(1 == len);
+    CU_ASSERT(-1 == cu_hex_decode(CU_HEX_SEP(':'), "00-11:22:aa:bb:cc", 17, NULL, &len));
+    CU_ASSERT(-1 == cu_hex_decode(CU_HEX_SEP(':'), "00:11:22:aa:bb:cg", 17, NULL, &len));
+    CU_ASSERT(-2 == cu_hex_decode(CU_HEX_SEP(':'), "00:11:22:aa:bb:cc:", 18, NULL, &len));
+    CU_ASSERT(-2 == cu_hex_decode(CU_HEX_SEP(':'), "001122aabbcc", 12, NULL, &len));
+}
+
+
+void test_provided(void)
+{
+    uint8_t mac[6] = { 0x00, 0x1a, 0x2b, 0x3c, 0x4d, 0x5e };
+    char buf[17];
+    uint8_t out[6];
+    char *b    = buf;
+    void *o    = out;
+    size_t len = 16;
+
+    CU_ASSERT(-3 == cu_hex_encode(CU_HEX_UPPER | CU_HEX_SEP(':') | CU_HEX_PROVIDED, mac, 6, &b, &len));
+    CU_ASSERT(0 == len);
+
+    len = 17;
+    CU_ASSERT(0 == cu_hex_encode(CU_HEX_UPPER | CU_HEX_SEP(':') | CU_HEX_PROVIDED, mac, 6, &b, &len));
+    CU_ASSERT(17 == len);
+    CU_ASSERT(0 == memcmp("00:1A:2B:3C:4D:5E", buf, 17));
+
+    len = 5;
+    CU_ASSERT(-3 == cu_hex_decode(CU_HEX_SEP(':') | CU_HEX_PROVIDED, buf, 17, &o, &len));
+    CU_ASSERT(0 == len);
+
+    len = 6;
+    CU_ASSERT(0 == cu_hex_decode(CU_HEX_SEP(':') | CU_HEX_PROVIDED, buf, 17, &o, &len));
+    CU_ASSERT(6 == len);
+    CU_ASSERT(0 == memcmp(mac, out, 6));
+}
+
+
+void test_input_validation(void)
+{
+    char *enc  = (char *) 1;
+    void *dec  = (void *) 1;
+    size_t len = 10;
+
+    CU_ASSERT(-5 == cu_hex_encode(CU_HEX_LOWER, "a", 1, &enc, NULL));
+    CU_ASSERT(-5 == cu_hex_decode(CU_HEX_LOWER, "aa", 2, &dec, NULL));
+
+    CU_ASSERT(-5 == cu_hex_encode(0x02, "a", 1, &enc, &len));
+    CU_ASSERT(0 == len);
+    len = 10;
+    CU_ASSERT(-5 == cu_hex_decode(0x40, "aa", 2, &dec, &len));
+    CU_ASSERT(0 == len);
+    CU_ASSERT(-5 == cu_hex_encode(CU_HEX_LOWER, NULL, 1, &enc, &len));
+    CU_ASSERT(-5 == cu_hex_decode(CU_HEX_LOWER, NULL, 2, &dec, &len));
+
+    /* Empty input is not allocated. */
+    len = 10;
+    CU_ASSERT(0 == cu_hex_encode(CU_HEX_LOWER, NULL, 0, &enc, &len));
+    CU_ASSERT(NULL == enc);
+    CU_ASSERT(0 == len);
+    len = 10;
+    CU_ASSERT(0 == cu_hex_decode(CU_HEX_LOWER, "", 0, &dec, &len));
+    CU_ASSERT(NULL == dec);
+    CU_ASSERT(0 == len);
+}
+
+
+void add_suites(CU_pSuite *suite)
+{
+    *suite = CU_add_suite("hex.c tests", NULL, NULL);
+    CU_add_test(*suite, "Test Encode and Decode    ", test_encode_decode);
+    CU_add_test(*suite, "Test Decoding Mixed Case  ", test_decode_case);
+    CU_add_test(*suite, "Test Decoding Errors      ", test_decode_errors);
+    CU_add_test(*suite, "Test Provided Buffers     ", test_provided);
+    CU_add_test(*suite, "Test Input Validation     ", test_input_validation);
+}
+
+
+/*----------------------------------------------------------------------------*/
+/*                             External Functions                             */
+/*----------------------------------------------------------------------------*/
+int main(void)
+{
+    unsigned rv     = 1;
+    CU_pSuite suite = NULL;
+
+    if (CUE_SUCCESS == CU_initialize_registry()) {
+        add_suites(&suite);
+
+        if (NULL != suite) {
+            CU_basic_set_mode(CU_BRM_VERBOSE);
+            CU_basic_run_tests();
+            printf("\n");
+            CU_basic_show_failures(CU_get_failure_list());
+            printf("\n\n");
+            rv = CU_get_number_of_tests_failed();
+        }
+
+        CU_cleanup_registry();
+    }
+
+    if (0 != rv) {
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,358 @@
+/* SPDX-FileCopyrightText: 2026 Comcast Cable Communications Management, LLC */
+/* SPDX-License-Identifier: Apache-2.0 */
+#define _POSIX_C_SOURCE 200809L
+
+#include <CUnit/Basic.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pool.h"
+
+#define THREADS 4
+#define OBJS    5000
+
+struct work {
+    cu_pool_t *pool;
+    void **objs;
+    int id;
+    int errors;
+};
+
+
+void test_basic(void)
+{
+    cu_pool_t *p = NULL;
+    cu_pool_stats_t s;
+    unsigned char *objs[1000];
+
+    CU_ASSERT(NULL == cu_pool_create(0));
+    CU_ASSERT(NULL == cu_pool_create(SIZE_MAX));
+    CU_ASSERT(NULL == cu_pool_alloc(NULL));
+    CU_ASSERT(-1 == cu_pool_stats(NULL, &s));
+    cu_pool_free(NULL, objs);
+    cu_pool_destroy(NULL);
+
+    p = cu_pool_create(13);
+    CU_ASSERT_FATAL(NULL != p);
+    CU_ASSERT(-1 == cu_pool_stats(p, NULL));
+
+    /* Aligned, and none of them overlap. */
+    for (size_t i = 0; i < 1000; i++) {
+        objs[i] = cu_pool_alloc(p);
+        CU_ASSERT_FATAL(NULL != objs[i]);
+        CU_ASSERT(0 == ((uintptr_t) objs[i] % (2 * sizeof(void *))));
+        memset(objs[i], (int) (i & 0xff), 13);
+    }
+    for (size_t i = 0; i < 1000; i++) {
+        for (size_t j = 0; j < 13; j++) {
+            CU_ASSERT(objs[i][j] == (unsigned char) (i & 0xff));
+        }
+    }
+
+    CU_ASSERT(0 == cu_pool_stats(p, &s));
+    CU_ASSERT(16 == s.obj_size);
+    CU_ASSERT(1000 == s.in_use);
+    CU_ASSERT(1000 == s.allocs);
+    CU_ASSERT(0 == s.frees);
+    CU_ASSERT(1000 <= s.capacity);
+    CU_ASSERT(1 < s.slabs);
+
+    for (size_t i = 0; i < 1000; i++) {
+        cu_pool_free(p, objs[i]);
+    }
+    cu_pool_free(p, NULL);
+
+    /* The freed objects are reused, so the pool doesn't grow. */
+    for (int round = 0; round < 10; round++) {
+        for (size_t i = 0; i < 1000; i++) {
+            objs[i] = cu_must_pool_alloc(p);
+        }
+        for (size_t i = 0; i < 1000; i++) {
+            cu_pool_free(p, objs[i]);
+        }
+    }
+
+    {
+        cu_pool_stats_t after;
+
+        CU_ASSERT(0 == cu_pool_stats(p, &after));
+        CU_ASSERT(s.slabs == after.slabs);
+        CU_ASSERT(0 == after.in_use);
+        CU_ASSERT(11000 == after.allocs);
+        CU_ASSERT(11000 == after.frees);
+    }
+
+    objs[0] = cu_pool_alloc(p);
+    memset(objs[0], 0xff, 13);
+    cu_pool_free(p, objs[0]);
+    objs[0] = cu_must_pool_calloc(p);
+    for (size_t j = 0; j < 13; j++) {
+        CU_ASSERT(0 == objs[0][j]);
+    }
+
+    /* Destroying frees objects that are still allocated. */
+    cu_pool_destroy(p);
+
+    /* Objects larger than a slab. */
+    p = cu_must_pool_create(10000);
+    objs[0] = cu_pool_calloc(p);
+    objs[1] = cu_pool_alloc(p);
+    CU_ASSERT_FATAL(NULL != objs[0]);
+    CU_ASSERT_FATAL(NULL != objs[1]);
+    memset(objs[1], 1, 10000);
+    CU_ASSERT(0 == objs[0][9999]);
+    cu_pool_destroy(p);
+}
+
+
+static void *churn(void *arg)
+{
+    struct work *w = (struct work *) arg;
+    void **objs    = w->objs;
+
+    for (int round = 0; round < 20; round++) {
+        for (int i = 0; i < OBJS; i++) {
+            objs[i] = cu_pool_alloc(w->pool);
+            if (!objs[i]) {
+                w->errors++;
+                return NULL;
+            }
+            *(int *) objs[i] = w->id * OBJS + i;
+        }
+        for (int i = 0; i < OBJS; i++) {
+            if (*(int *) objs[i] != w->id * OBJS + i) {
+                w->errors++;
+            }
+            cu_pool_free(w->pool, objs[i]);
+        }
+    }
+
+    return NULL;
+}
+
+
+void test_threads(void)
+{
+    pthread_t t[THREADS];
+    struct work w[THREADS];
+    cu_pool_stats_t s;
+    cu_pool_t *p = cu_must_pool_create(sizeof(int));
+
+    for (int i = 0; i < THREADS; i++) {
+        w[i].pool   = p;
+        w[i].objs   = malloc(OBJS * sizeof(void *));
+        w[i].id     = i;
+        w[i].errors = 0;
+        CU_ASSERT_FATAL(NULL != w[i].objs);
+        CU_ASSERT_FATAL(0 == pthread_create(&t[i], NULL, churn, &w[i]));
+    }
+    for (int i = 0; i < THREADS; i++) {
+        pthread_join(t[i], NULL);
+        CU_ASSERT(0 == w[i].errors);
+        free(w[i].objs);
+    }
+
+    /* The threads are gone, so their counts were moved into the pool. */
+    CU_ASSERT(0 == cu_pool_stats(p, &s));
+    CU_ASSERT(0 == s.in_use);
+    CU_ASSERT((uint64_t) THREADS * OBJS * 20 == s.allocs);
+    CU_ASSERT(s.allocs == s.frees);
+    /* Never more than were in use at once, plus what the caches held. */
+    CU_ASSERT(s.capacity < THREADS * OBJS + THREADS * 1024);
+
+    cu_pool_destroy(p);
+}
+
+
+static void *free_all(void *arg)
+{
+    struct work *w = (struct work *) arg;
+
+    for (int i = 0; i < OBJS; i++) {
+        cu_pool_free(w->pool, w->objs[i]);
+    }
+
+    return NULL;
+}
+
+
+void test_cross_thread(void)
+{
+    pthread_t t;
+    struct work w;
+    cu_pool_stats_t s;
+    size_t slabs = 0;
+
+    w.pool = cu_must_pool_create(48);
+    w.objs = malloc(OBJS * sizeof(void *));
+    CU_ASSERT_FATAL(NULL != w.objs);
+
+    for (int i = 0; i < OBJS; i++) {
+        w.objs[i] = cu_must_pool_alloc(w.pool);
+    }
+    CU_ASSERT(0 == cu_pool_stats(w.pool, &s));
+    CU_ASSERT(OBJS == s.in_use);
+    slabs = s.slabs;
+
+    /* Freed on another thread, then reused on this one. */
+    CU_ASSERT_FATAL(0 == pthread_create(&t, NULL, free_all, &w));
+    pthread_join(t, NULL);
+
+    CU_ASSERT(0 == cu_pool_stats(w.pool, &s));
+    CU_ASSERT(0 == s.in_use);
+
+    for (int i = 0; i < OBJS; i++) {
+        w.objs[i] = cu_must_pool_alloc(w.pool);
+    }
+    CU_ASSERT(0 == cu_pool_stats(w.pool, &s));
+    CU_ASSERT(slabs == s.slabs);
+    CU_ASSERT(OBJS == s.in_use);
+
+    cu_pool_destroy(w.pool);
+    free(w.objs);
+}
+
+
+void test_many_pools(void)
+{
+    cu_pool_t *p[2000];
+
+    /* More pools than there are pthread keys on most systems. */
+    for (int i = 0; i < 2000; i++) {
+        p[i] = cu_pool_create(16);
+        CU_ASSERT_FATAL(NULL != p[i]);
+        CU_ASSERT(NULL != cu_pool_alloc(p[i]));
+    }
+    for (int i = 0; i < 2000; i++) {
+        cu_pool_destroy(p[i]);
+    }
+}
+
+
+struct handoff {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int step;
+    cu_pool_t *pool;
+    int errors;
+};
+
+
+static void wait_step(struct handoff *h, int step)
+{
+    pthread_mutex_lock(&h->lock);
+    while (h->step < step) {
+        pthread_cond_wait(&h->cond, &h->lock);
+    }
+    pthread_mutex_unlock(&h->lock);
+}
+
+
+static void next_step(struct handoff *h)
+{
+    pthread_mutex_lock(&h->lock);
+    h->step++;
+    pthread_cond_broadcast(&h->cond);
+    pthread_mutex_unlock(&h->lock);
+}
+
+
+static void *use_two_pools(void *arg)
+{
+    struct handoff *h = (struct handoff *) arg;
+    void *obj         = NULL;
+
+    /* Fill a cache for the first pool, then wait for it to be destroyed. */
+    obj = cu_pool_alloc(h->pool);
+    if (!obj) {
+        h->errors++;
+    }
+    cu_pool_free(h->pool, obj);
+    next_step(h);
+    wait_step(h, 2);
+
+    obj = cu_pool_alloc(h->pool);
+    if (!obj) {
+        h->errors++;
+    }
+    cu_pool_free(h->pool, obj);
+
+    return NULL;
+}
+
+
+void test_destroy_while_running(void)
+{
+    pthread_t t;
+    cu_pool_stats_t s;
+    struct handoff h;
+
+    memset(&h, 0, sizeof(h));
+    pthread_mutex_init(&h.lock, NULL);
+    pthread_cond_init(&h.cond, NULL);
+    h.pool = cu_must_pool_create(32);
+
+    CU_ASSERT_FATAL(0 == pthread_create(&t, NULL, use_two_pools, &h));
+    wait_step(&h, 1);
+
+    /* The thread is still running and still has a cache for this pool. */
+    cu_pool_destroy(h.pool);
+    h.pool = cu_must_pool_create(32);
+    next_step(&h);
+    pthread_join(t, NULL);
+    CU_ASSERT(0 == h.errors);
+
+    CU_ASSERT(0 == cu_pool_stats(h.pool, &s));
+    CU_ASSERT(1 == s.allocs);
+    CU_ASSERT(1 == s.frees);
+    CU_ASSERT(0 == s.in_use);
+
+    cu_pool_destroy(h.pool);
+    pthread_cond_destroy(&h.cond);
+    pthread_mutex_destroy(&h.lock);
+}
+
+
+void add_suites(CU_pSuite *suite)
+{
+    *suite = CU_add_suite("pool.c tests", NULL, NULL);
+    CU_add_test(*suite, "Test Basic                ", test_basic);
+    CU_add_test(*suite, "Test Threads              ", test_threads);
+    CU_add_test(*suite, "Test Cross Thread Frees   ", test_cross_thread);
+    CU_add_test(*suite, "Test Many Pools           ", test_many_pools);
+    CU_add_test(*suite, "Test Destroy While Running", test_destroy_while_running);
+}
+
+
+/*----------------------------------------------------------------------------*/
+/*                             External Functions                             */
+/*----------------------------------------------------------------------------*/
+int main(void)
+{
+    unsigned rv     = 1;
+    CU_pSuite suite = NULL;
+
+    if (CUE_SUCCESS == CU_initialize_registry()) {
+        add_suites(&suite);
+
+        if (NULL != suite) {
+            CU_basic_set_mode(CU_BRM_VERBOSE);
+            CU_basic_run_tests();
+            printf("\n");
+            CU_basic_show_failures(CU_get_failure_list());
+            printf("\n\n");
+            rv = CU_get_number_of_tests_failed();
+        }
+
+        CU_cleanup_registry();
+    }
+
+    if (0 != rv) {
+        return 1;
+    }
+
+    return 0;
+}